@@ -0,0 +1,97 @@
+#include "DecodeBenchmark.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <boost/filesystem.hpp>
+#include "ImageIO.h"
+#include "Util.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	const int k_decodePasses = 3;
+
+	bool readFile(const fs::path& path, std::vector<unsigned char>& data)
+	{
+		std::ifstream stream(path.string(), std::ios::in | std::ios::binary);
+		if (!stream)
+			return false;
+		data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return !data.empty();
+	}
+
+	template <typename Decoder>
+	double timeDecode(const std::vector<unsigned char>& data, Decoder decode, size_t& pixels)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < k_decodePasses; i++)
+		{
+			size_t width, height;
+			std::vector<unsigned char> rgba = decode(data, width, height);
+			pixels = width * height;
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / k_decodePasses;
+	}
+}
+
+int run_decode_benchmark(const std::string& directory)
+{
+	std::ostream& out = std::cout;
+	if (!fs::is_directory(directory))
+	{
+		std::cerr << "\"" << directory << "\" is not a directory.\n";
+		return 1;
+	}
+
+	out << "EmulationStation image decode benchmark\n";
+	out << "=======================================\n";
+	out << std::fixed << std::setprecision(2);
+
+	int count = 0;
+	double freeImageTotal = 0;
+	double directTotal = 0;
+	double scaledTotal = 0;
+	for (fs::directory_iterator it(directory); it != fs::directory_iterator(); ++it)
+	{
+		const std::string ext = strToLower(it->path().extension().string());
+		if (ext != ".jpg" && ext != ".jpeg" && ext != ".png")
+			continue;
+
+		std::vector<unsigned char> data;
+		if (!readFile(it->path(), data))
+			continue;
+
+		size_t freeImagePixels, directPixels, scaledPixels;
+		const double freeImageTime = timeDecode(data, [] (const std::vector<unsigned char>& d, size_t& w, size_t& h)
+			{ return ImageIO::loadFromMemoryRGBA32FreeImage(d.data(), d.size(), w, h); }, freeImagePixels);
+		const double directTime = timeDecode(data, [] (const std::vector<unsigned char>& d, size_t& w, size_t& h)
+			{ return ImageIO::loadFromMemoryRGBA32(d.data(), d.size(), w, h); }, directPixels);
+		// what a gamelist image slot on a 720p screen would ask for
+		const double scaledTime = timeDecode(data, [] (const std::vector<unsigned char>& d, size_t& w, size_t& h)
+			{ return ImageIO::loadFromMemoryRGBA32(d.data(), d.size(), w, h, 640, 360); }, scaledPixels);
+
+		out << it->path().filename().string() << ": freeimage " << freeImageTime << "ms, direct " << directTime
+			<< "ms, scaled " << scaledTime << "ms (" << scaledPixels << "/" << directPixels << " px)\n";
+
+		freeImageTotal += freeImageTime;
+		directTotal += directTime;
+		scaledTotal += scaledTime;
+		count++;
+	}
+
+	if (count == 0)
+	{
+		out << "No JPEG or PNG images found.\n";
+		return 1;
+	}
+
+	out << "\n" << count << " images, average per image:\n";
+	out << "  freeimage: " << freeImageTotal / count << "ms\n";
+	out << "  direct:    " << directTotal / count << "ms\n";
+	out << "  scaled:    " << scaledTotal / count << "ms\n";
+	return 0;
+}
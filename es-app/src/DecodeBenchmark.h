@@ -0,0 +1,6 @@
+#pragma once
+
+#include <string>
+
+// Decodes every JPEG/PNG in a directory with both FreeImage and the direct decoders and prints the timings.
+int run_decode_benchmark(const std::string& directory);
@@ -0,0 +1,670 @@
+#include "FrameBenchmark.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <SDL.h>
+#include <boost/filesystem.hpp>
+#include "pugixml/src/pugixml.hpp"
+#include "views/ViewController.h"
+#include "views/gamelist/ISimpleGameListView.h"
+#include "SystemData.h"
+#include "resources/TextureResource.h"
+#include "resources/Font.h"
+#include "InputManager.h"
+#include "InputConfig.h"
+#include "Renderer.h"
+#include "Window.h"
+#include "FrameScheduler.h"
+#include "ImageIO.h"
+#include "Settings.h"
+#include "Log.h"
+#include "platform.h"
+#include GLHEADER
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	const int k_systemCount = 4;
+	const int k_gamesPerSystem = 250;
+	const int k_coverCount = 32; // games share covers round-robin
+	const int k_frameTime = 16; // ms, fixed so animations and scrolling play out the same on every run
+	const int k_maxLoaderWait = 5000; // ms to wait for textures before a snapshot
+	const int k_videoSystem = 2; // gets video snaps, so it opens in the video gamelist view
+	// written into the folders the benchmark creates, only those are ever deleted
+	const char* k_markerName = ".es_frame_benchmark";
+
+	struct Step
+	{
+		const char* name;
+		const char* button; // nullptr to just let time pass
+		int holdFrames; // frames the button is held down for
+		int settleFrames; // frames after it is released
+	};
+
+	const Step k_steps[] =
+	{
+		{ "start",					nullptr,	0,		60 },
+		{ "system_next",			"right",	1,		45 },
+		{ "system_next",			"right",	1,		45 },
+		{ "system_prev",			"left",		1,		45 },
+		{ "open_gamelist",			"a",		1,		60 },
+		{ "gamelist_step",			"down",		1,		15 },
+		{ "gamelist_step",			"down",		1,		15 },
+		{ "gamelist_step",			"down",		1,		15 },
+		{ "gamelist_scroll",		"down",		180,	30 },
+		{ "gamelist_page",			"pagedown",	1,		30 },
+		{ "gamelist_scroll_up",		"up",		120,	30 },
+		{ "gamelist_next_system",	"right",	1,		60 },
+		{ "video_gamelist_step",	"down",		1,		15 },
+		{ "video_gamelist_step",	"down",		1,		15 },
+		{ "video_gamelist_step",	"down",		1,		15 },
+		{ "gamelist_scroll",		"down",		120,	30 },
+		{ "back_to_systems",		"b",		1,		60 },
+	};
+
+	// keys the sequence is replayed with, whatever the keyboard was configured to
+	const struct { const char* name; SDL_Keycode key; } k_keys[] =
+	{
+		{ "up", SDLK_UP }, { "down", SDLK_DOWN }, { "left", SDLK_LEFT }, { "right", SDLK_RIGHT },
+		{ "a", SDLK_RETURN }, { "b", SDLK_ESCAPE }, { "start", SDLK_F1 }, { "select", SDLK_F2 },
+		{ "pageup", SDLK_RIGHTBRACKET }, { "pagedown", SDLK_LEFTBRACKET },
+	};
+
+	struct FrameTiming
+	{
+		int step;
+		double updateMs;
+		double renderMs;
+		Renderer::FrameStats stats;
+		long long writes; // write syscalls of the main thread during update and render, -1 if unknown
+		int fileChanges;
+		unsigned int textCaches; // text caches built during update and render
+		double frameMs; // the whole frame, swap included
+	};
+
+	// Watches what navigation writes: the write syscalls of the main thread (Linux only) and files
+	// created, changed or removed in the config folder, ~/.emulationstation but not the caches the
+	// background threads fill. Selecting an entry should touch neither.
+	class WriteMonitor
+	{
+	public:
+		WriteMonitor() : mNotify(-1)
+		{
+#ifdef __linux__
+			mNotify = inotify_init1(IN_NONBLOCK);
+			const std::string folders[] = { getHomePath() + "/.emulationstation", getVideoTitleFolder() };
+			for (int i = 0; mNotify >= 0 && i < 2; i++)
+				inotify_add_watch(mNotify, folders[i].c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO);
+#endif
+		}
+
+		~WriteMonitor()
+		{
+#ifdef __linux__
+			if (mNotify >= 0)
+				close(mNotify);
+#endif
+		}
+
+		// False if file changes can't be watched, takeChanges() then always returns 0
+		bool available() const { return mNotify >= 0; }
+
+		// Write syscalls made by the calling thread so far, or -1 if the kernel doesn't tell
+		static long long getThreadWrites()
+		{
+#ifdef __linux__
+			std::ifstream io("/proc/thread-self/io");
+			std::string key;
+			long long value;
+			while (io >> key >> value)
+			{
+				if (key == "syscw:")
+					return value;
+			}
+#endif
+			return -1;
+		}
+
+		// Files changed since the last call. The log is written throughout, it doesn't count.
+		int takeChanges()
+		{
+			int changes = 0;
+#ifdef __linux__
+			char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+			ssize_t length;
+			while (mNotify >= 0 && (length = read(mNotify, buffer, sizeof(buffer))) > 0)
+			{
+				for (char* p = buffer; p < buffer + length; )
+				{
+					const struct inotify_event* event = (const struct inotify_event*)p;
+					if (event->len == 0 || std::string(event->name) != "es_log.txt")
+						changes++;
+					p += sizeof(struct inotify_event) + event->len;
+				}
+			}
+#endif
+			return changes;
+		}
+
+	private:
+		int mNotify;
+	};
+
+	// Resident memory of the process in kB (VmRSS), or -1 if the kernel doesn't tell
+	long long getResidentKB()
+	{
+#ifdef __linux__
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.compare(0, 6, "VmRSS:") == 0)
+				return std::atoll(line.c_str() + 6);
+		}
+#endif
+		return -1;
+	}
+
+	// Log::file is protected, so only a subclass can point Log at another stream
+	class BenchmarkLog : public Log
+	{
+	public:
+		// Reopens the log with a buffer larger than any frame logs. Messages then reach the file
+		// when Log::flush() is called between frames and aren't counted as the frame's writes.
+		// The old stream is flushed but stays open, a background thread may be writing to it.
+		// Errors are echoed to the console as well, those writes still count.
+		static void bufferOutput()
+		{
+			static char buffer[256 * 1024];
+			if (file == NULL)
+				return;
+
+			FILE* buffered = fopen(getLogPath().c_str(), "a");
+			if (buffered == NULL)
+				return;
+			if (setvbuf(buffered, buffer, _IOFBF, sizeof(buffer)) != 0)
+			{
+				fclose(buffered);
+				return;
+			}
+			fflush(file);
+			file = buffered;
+		}
+	};
+
+	// Empties a folder made by an earlier run, or creates it. A folder that is already there
+	// without the marker belongs to somebody else and is left alone.
+	bool resetFolder(const fs::path& folder)
+	{
+		boost::system::error_code ec;
+		if (fs::exists(folder, ec))
+		{
+			if (!fs::exists(folder / k_markerName, ec))
+			{
+				std::cerr << "\"" << folder.string() << "\" already exists and was not created by the frame benchmark, "
+					"pick another output folder\n";
+				return false;
+			}
+			fs::remove_all(folder, ec);
+		}
+
+		if (!ec)
+			fs::create_directories(folder, ec);
+		if (ec)
+		{
+			std::cerr << "Could not create benchmark folder \"" << folder.string() << "\": " << ec.message() << "\n";
+			return false;
+		}
+
+		std::ofstream marker((folder / k_markerName).string());
+		marker << "Created by the frame benchmark, deleted by its next run\n";
+		return true;
+	}
+
+	// A gradient with a few bars, different for every seed
+	void writeImage(const fs::path& path, size_t width, size_t height, int seed)
+	{
+		std::vector<unsigned char> data(width * height * 4);
+		const int hue = (seed * 47) % 256;
+		for (size_t y = 0; y < height; y++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				unsigned char* px = &data[(y * width + x) * 4];
+				const bool bar = ((y * 8 / height) + seed) % 3 == 0 && x > width / 8 && x < width * 7 / 8;
+				px[0] = (unsigned char)(bar ? 255 - hue : (hue + x * 128 / width) % 256);
+				px[1] = (unsigned char)(bar ? 255 : y * 255 / height);
+				px[2] = (unsigned char)(bar ? hue : (seed * 13 + (x + y) * 64 / (width + height)) % 256);
+				px[3] = 255;
+			}
+		}
+		ImageIO::saveRGBA32PNG(path.string(), data.data(), width, height);
+	}
+
+	std::string getSystemName(int system)
+	{
+		std::stringstream ss;
+		ss << "bench" << (system + 1);
+		return ss.str();
+	}
+
+	void writeTheme(const fs::path& themeDir, const std::string& system)
+	{
+		pugi::xml_document doc;
+		pugi::xml_node theme = doc.append_child("theme");
+		theme.append_child("formatVersion").text().set("4");
+
+		const std::string logoPath = "../art/logo_" + system + ".png";
+		pugi::xml_node systemView = theme.append_child("view");
+		systemView.append_attribute("name") = "system";
+		pugi::xml_node systemLogo = systemView.append_child("image");
+		systemLogo.append_attribute("name") = "logo";
+		systemLogo.append_child("path").text().set(logoPath.c_str());
+
+		pugi::xml_node listViews = theme.append_child("view");
+		listViews.append_attribute("name") = "basic, detailed, video";
+		pugi::xml_node background = listViews.append_child("image");
+		background.append_attribute("name") = "background";
+		background.append_child("path").text().set("../art/background.png");
+		pugi::xml_node logo = listViews.append_child("image");
+		logo.append_attribute("name") = "logo";
+		logo.append_child("path").text().set(logoPath.c_str());
+		pugi::xml_node list = listViews.append_child("textlist");
+		list.append_attribute("name") = "gamelist";
+		list.append_child("pos").text().set("0.05 0.2");
+		list.append_child("size").text().set("0.45 0.7");
+		list.append_child("selectorColor").text().set("3366CCFF");
+		list.append_child("primaryColor").text().set("DDDDDDFF");
+		list.append_child("secondaryColor").text().set("88AAFFFF");
+
+		pugi::xml_node detailViews = theme.append_child("view");
+		detailViews.append_attribute("name") = "detailed, video";
+		pugi::xml_node image = detailViews.append_child("image");
+		image.append_attribute("name") = "md_image";
+		image.append_child("pos").text().set("0.55 0.2");
+		image.append_child("size").text().set("0.4 0.45");
+		pugi::xml_node description = detailViews.append_child("text");
+		description.append_attribute("name") = "md_description";
+		description.append_child("pos").text().set("0.55 0.72");
+		description.append_child("size").text().set("0.4 0.2");
+
+		fs::create_directories(themeDir / system);
+		doc.save_file((themeDir / system / "theme.xml").string().c_str());
+	}
+
+	void writeGamelist(const fs::path& romDir, const fs::path& mediaDir, int system)
+	{
+		static const char* genres[] = { "Platform", "Shooter", "Racing", "Puzzle", "Sports", "RPG" };
+
+		pugi::xml_document doc;
+		pugi::xml_node gameList = doc.append_child("gameList");
+		for (int i = 0; i < k_gamesPerSystem; i++)
+		{
+			std::stringstream name;
+			name << "Game " << std::setw(3) << std::setfill('0') << (i + 1);
+			const std::string file = name.str() + ".bin";
+			std::ofstream((romDir / file).string()); // empty ROM, only the gamelist matters
+
+			std::stringstream cover;
+			cover << "cover_" << ((i + system * 7) % k_coverCount) << ".png";
+
+			std::stringstream desc;
+			desc << name.str() << " is a synthetic entry of benchmark system " << (system + 1) << ". ";
+			for (int sentence = 0; sentence < 1 + (i % 4); sentence++)
+				desc << "Its description is long enough to wrap over several lines of the detailed view. ";
+
+			std::stringstream date;
+			date << (1985 + (i % 20)) << "0" << (1 + (i % 9)) << "15T000000";
+
+			std::stringstream rating;
+			rating << ((i % 11) / 10.0f);
+
+			// the files don't exist, the view still goes through all of its video handling
+			std::stringstream video;
+			video << "snap_" << std::setw(3) << std::setfill('0') << (i + 1) << ".mp4";
+
+			pugi::xml_node game = gameList.append_child("game");
+			game.append_child("path").text().set(("./" + file).c_str());
+			game.append_child("name").text().set(name.str().c_str());
+			game.append_child("desc").text().set(desc.str().c_str());
+			game.append_child("image").text().set((mediaDir / cover.str()).generic_string().c_str());
+			if (system == k_videoSystem)
+				game.append_child("video").text().set((mediaDir / video.str()).generic_string().c_str());
+			game.append_child("rating").text().set(rating.str().c_str());
+			game.append_child("releasedate").text().set(date.str().c_str());
+			game.append_child("developer").text().set("Benchmark Developer");
+			game.append_child("publisher").text().set("Benchmark Publisher");
+			game.append_child("genre").text().set(genres[i % 6]);
+			game.append_child("players").text().set(i % 3 == 0 ? "2" : "1");
+		}
+		doc.save_file((romDir / "gamelist.xml").string().c_str());
+	}
+
+	double percentile(std::vector<double> values, double p)
+	{
+		if (values.empty())
+			return 0;
+		std::sort(values.begin(), values.end());
+		return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+	}
+
+	void printSummary(std::ostream& out, const char* name, const std::vector<double>& values)
+	{
+		double total = 0, totalSquared = 0;
+		for (double value : values)
+		{
+			total += value;
+			totalSquared += value * value;
+		}
+		const double average = values.empty() ? 0 : total / values.size();
+		const double deviation = values.empty() ? 0 : std::sqrt(std::max(totalSquared / values.size() - average * average, 0.0));
+		out << name << ": avg " << average << "ms, sd " << deviation << "ms, p50 " << percentile(values, 0.5)
+			<< "ms, p95 " << percentile(values, 0.95) << "ms, p99 " << percentile(values, 0.99)
+			<< "ms, max " << percentile(values, 1.0) << "ms\n";
+	}
+
+	void waitForTextures()
+	{
+		const Uint32 start = SDL_GetTicks();
+		while (TextureResource::isLoading() && SDL_GetTicks() - start < (Uint32)k_maxLoaderWait)
+			SDL_Delay(1);
+	}
+
+	// Scrapes a game the way GuiScraperMulti does, by assigning it a whole new MetaDataList, and
+	// checks that its row shows the new name. Rows point at the name instead of copying it.
+	bool checkMetadataRefresh(SystemData* system, std::string& shown)
+	{
+		std::shared_ptr<ISimpleGameListView> view = std::dynamic_pointer_cast<ISimpleGameListView>(ViewController::get()->getGameListView(system));
+		std::vector<FileData*> games = system->getRootFolder()->getFilesRecursive(GAME);
+		if (!view || games.empty())
+			return false;
+
+		FileData* game = games.front();
+		FileData* cursor = view->getCursor();
+		const MetaDataList original = game->metadata;
+		MetaDataList scraped = original;
+		scraped.set("name", "Scraped " + original.get("name"));
+		scraped.set("desc", "Scraped description");
+
+		game->metadata = scraped;
+		view->onFileChanged(game, FILE_METADATA_CHANGED);
+		view->setCursor(game);
+		shown = view->getCursorName();
+		const bool refreshed = (shown == scraped.get("name"));
+
+		// and back, so the run navigates the library it generated
+		game->metadata = original;
+		view->onFileChanged(game, FILE_METADATA_CHANGED);
+		const bool restored = (view->getCursorName() == original.get("name"));
+		view->setCursor(cursor);
+		return refreshed && restored;
+	}
+
+	// Returns false if the window was closed
+	bool runFrame(Window& window, int step, std::vector<FrameTiming>& timings, const std::string& snapshotPath, WriteMonitor& monitor)
+	{
+		// nothing is read from real devices, but the event queue still has to be drained
+		SDL_Event event;
+		while (SDL_PollEvent(&event))
+		{
+			if (event.type == SDL_QUIT)
+				return false;
+		}
+
+		typedef std::chrono::high_resolution_clock Clock;
+		const long long writes = WriteMonitor::getThreadWrites();
+		const unsigned long long textCaches = Font::getTextCachesBuilt();
+		const Clock::time_point start = Clock::now();
+		// animations get the fixed frame time, but deferred work runs within the frame budget
+		FrameScheduler::getInstance()->beginFrame(false);
+		window.update(k_frameTime);
+		const Clock::time_point updated = Clock::now();
+		window.render();
+		Renderer::flush();
+		glFinish(); // count the rasterizing too, not just the command submission
+		const Clock::time_point rendered = Clock::now();
+		const long long frameWrites = (writes < 0) ? -1 : WriteMonitor::getThreadWrites() - writes;
+		// the log was only buffered during the frame
+		Log::flush();
+		const unsigned int frameTextCaches = (unsigned int)(Font::getTextCachesBuilt() - textCaches);
+		const int fileChanges = monitor.takeChanges();
+
+		if (!snapshotPath.empty())
+		{
+			std::vector<unsigned char> pixels;
+			Renderer::readScreen(pixels);
+			ImageIO::saveRGBA32PNG(snapshotPath, pixels.data(), Renderer::getScreenWidth(), Renderer::getScreenHeight());
+		}
+
+		Renderer::swapBuffers();
+		const Clock::time_point swapped = Clock::now();
+
+		FrameTiming timing;
+		timing.step = step;
+		timing.updateMs = std::chrono::duration<double, std::milli>(updated - start).count();
+		timing.renderMs = std::chrono::duration<double, std::milli>(rendered - updated).count();
+		timing.stats = Renderer::getFrameStats();
+		timing.writes = frameWrites;
+		timing.fileChanges = fileChanges;
+		timing.textCaches = frameTextCaches;
+		timing.frameMs = std::chrono::duration<double, std::milli>(swapped - start).count();
+		timings.push_back(timing);
+		return true;
+	}
+}
+
+bool setup_frame_benchmark_home(const std::string& outputDir)
+{
+	const fs::path home = fs::absolute(outputDir) / "home";
+	const fs::path configDir = home / ".emulationstation";
+	const fs::path themeDir = configDir / "themes" / "benchmark";
+	const fs::path mediaDir = home / "media";
+
+	// start from scratch every time, so no cache from an earlier run makes this one faster
+	if (!resetFolder(home))
+		return false;
+
+	boost::system::error_code ec;
+	fs::create_directories(themeDir / "art", ec);
+	fs::create_directories(mediaDir, ec);
+	if (ec)
+	{
+		std::cerr << "Could not create benchmark folder \"" << home.string() << "\": " << ec.message() << "\n";
+		return false;
+	}
+
+	std::cout << "Generating benchmark library in " << home.string() << "...\n";
+
+	for (int i = 0; i < k_coverCount; i++)
+	{
+		std::stringstream cover;
+		cover << "cover_" << i << ".png";
+		writeImage(mediaDir / cover.str(), 400, 560, i);
+	}
+	writeImage(themeDir / "art" / "background.png", 1280, 720, 100);
+
+	pugi::xml_document systemsDoc;
+	pugi::xml_node systemList = systemsDoc.append_child("systemList");
+	for (int i = 0; i < k_systemCount; i++)
+	{
+		const std::string name = getSystemName(i);
+		const fs::path romDir = home / "roms" / name;
+		fs::create_directories(romDir);
+		writeGamelist(romDir, mediaDir, i);
+		writeImage(themeDir / "art" / ("logo_" + name + ".png"), 480, 120, 200 + i);
+		writeTheme(themeDir, name);
+
+		std::stringstream fullName;
+		fullName << "Benchmark System " << (i + 1);
+
+		pugi::xml_node system = systemList.append_child("system");
+		system.append_child("name").text().set(name.c_str());
+		system.append_child("fullname").text().set(fullName.str().c_str());
+		system.append_child("path").text().set(romDir.generic_string().c_str());
+		system.append_child("extension").text().set(".bin");
+		system.append_child("command").text().set("true");
+		system.append_child("theme").text().set(name.c_str());
+	}
+	systemsDoc.save_file((configDir / "es_systems.cfg").string().c_str());
+
+	SDL_setenv("HOME", home.generic_string().c_str(), 1);
+	return true;
+}
+
+int run_frame_benchmark(Window& window, const std::string& outputDir, bool snapshots)
+{
+	const fs::path outputPath(outputDir);
+	const fs::path snapshotDir = outputPath / "snapshots";
+	if (snapshots && !resetFolder(snapshotDir))
+		return 1;
+
+	InputConfig* keyboard = InputManager::getInstance()->getInputConfigByDevice(DEVICE_KEYBOARD);
+	keyboard->clear();
+	for (auto& key : k_keys)
+		keyboard->mapInput(key.name, Input(DEVICE_KEYBOARD, TYPE_KEY, key.key, 1, true));
+
+	const long long startRSS = getResidentKB();
+	ViewController::get()->preload();
+
+	// refill every gamelist the way a sort or filter change does, the views exist after preload()
+	std::vector<double> populateTimes;
+	std::vector<SystemData*> systems = SystemData::GetSystems();
+	for (auto it = systems.begin(); it != systems.end(); ++it)
+	{
+		std::shared_ptr<IGameListView> view = ViewController::get()->getGameListView(*it);
+		const auto start = std::chrono::high_resolution_clock::now();
+		view->onFileChanged((*it)->getRootFolder(), FILE_SORTED);
+		populateTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+
+	std::string refreshedName;
+	const bool metadataRefreshed = !systems.empty() && checkMetadataRefresh(systems.front(), refreshedName);
+
+	ViewController::get()->goToStart();
+
+	LOG(LogInfo) << "Running frame benchmark, " << (sizeof(k_steps) / sizeof(k_steps[0])) << " steps";
+	BenchmarkLog::bufferOutput();
+
+	WriteMonitor monitor;
+	monitor.takeChanges();
+
+	std::vector<FrameTiming> timings;
+	bool running = true;
+	for (int s = 0; running && s < (int)(sizeof(k_steps) / sizeof(k_steps[0])); s++)
+	{
+		const Step& step = k_steps[s];
+		Input input;
+		const bool hasInput = step.button != nullptr && keyboard->getInputByName(step.button, &input);
+		if (hasInput)
+			window.input(keyboard, Input(DEVICE_KEYBOARD, TYPE_KEY, input.id, 1, false));
+
+		for (int f = 0; running && f < step.holdFrames; f++)
+			running = runFrame(window, s, timings, "", monitor);
+
+		if (hasInput)
+			window.input(keyboard, Input(DEVICE_KEYBOARD, TYPE_KEY, input.id, 0, false));
+
+		for (int f = 0; running && f < step.settleFrames; f++)
+		{
+			std::string snapshotPath;
+			if (snapshots && f == step.settleFrames - 1)
+			{
+				// so what's in the snapshot doesn't depend on how fast the loader thread was
+				waitForTextures();
+				std::stringstream ss;
+				ss << std::setw(2) << std::setfill('0') << s << "_" << step.name << ".png";
+				snapshotPath = (snapshotDir / ss.str()).string();
+			}
+			running = runFrame(window, s, timings, snapshotPath, monitor);
+			// the snapshot itself isn't navigation
+			if (!snapshotPath.empty())
+				monitor.takeChanges();
+		}
+	}
+
+	const long long endRSS = getResidentKB();
+
+	std::ofstream csv((outputPath / "frames.csv").string());
+	csv << "frame,step,update_ms,render_ms,draw_calls,vertices,texture_binds,writes,file_changes,text_caches,frame_ms\n";
+	csv << std::fixed << std::setprecision(3);
+	std::vector<double> updateTimes, renderTimes, frameTimes;
+	double drawCalls = 0, vertices = 0, binds = 0, textCaches = 0;
+	unsigned int maxTextCaches = 0;
+	long long selectionWrites = 0, selectionChanges = 0;
+	int selectionSteps = 0;
+	for (size_t i = 0; i < timings.size(); i++)
+	{
+		const FrameTiming& t = timings[i];
+		csv << i << "," << k_steps[t.step].name << "," << t.updateMs << "," << t.renderMs << ","
+			<< t.stats.drawCalls << "," << t.stats.vertices << "," << t.stats.textureBinds << ","
+			<< (t.writes < 0 ? "" : std::to_string(t.writes)) << "," << t.fileChanges << "," << t.textCaches << "," << t.frameMs << "\n";
+		updateTimes.push_back(t.updateMs);
+		renderTimes.push_back(t.renderMs);
+		frameTimes.push_back(t.frameMs);
+		drawCalls += t.stats.drawCalls;
+		vertices += t.stats.vertices;
+		binds += t.stats.textureBinds;
+		textCaches += t.textCaches;
+		maxTextCaches = std::max(maxTextCaches, t.textCaches);
+
+		// moving the cursor by one entry, the hot path of browsing a gamelist
+		if (std::string(k_steps[t.step].name).find("gamelist_step") != std::string::npos)
+		{
+			selectionWrites += std::max(t.writes, 0LL);
+			selectionChanges += t.fileChanges;
+			if (i == 0 || timings[i - 1].step != t.step)
+				selectionSteps++;
+		}
+	}
+
+	std::ostream& out = std::cout;
+	const double frames = std::max<double>(1, (double)timings.size());
+	out << "EmulationStation frame benchmark\n";
+	out << "===============================\n";
+	out << std::fixed << std::setprecision(2);
+	out << timings.size() << " frames at " << Renderer::getScreenWidth() << "x" << Renderer::getScreenHeight()
+		<< (Settings::getInstance()->getBool("Headless") ? " (headless)" : "") << "\n";
+	out << "GL renderer: " << (const char*)glGetString(GL_RENDERER) << "\n";
+	printSummary(out, "update", updateTimes);
+	printSummary(out, "render", renderTimes);
+	printSummary(out, "frame", frameTimes);
+	std::stringstream populateName;
+	populateName << "gamelist populate (" << k_gamesPerSystem << " entries)";
+	printSummary(out, populateName.str().c_str(), populateTimes);
+	out << "per frame: " << (drawCalls / frames) << " draw calls, " << (vertices / frames) << " vertices, "
+		<< (binds / frames) << " texture binds\n";
+	out << "text caches built per frame: " << (textCaches / frames) << " avg, " << maxTextCaches << " max\n";
+	if (startRSS >= 0 && endRSS >= 0)
+		out << "resident memory: " << (startRSS / 1024.0) << " MB before preload, " << (endRSS / 1024.0) << " MB at the end\n";
+	else
+		out << "resident memory: unavailable\n";
+	const bool writesAvailable = WriteMonitor::getThreadWrites() >= 0;
+	const bool selectionWrote = selectionWrites + selectionChanges != 0;
+	out << "selection changes: " << selectionSteps << ", ";
+	if (writesAvailable)
+		out << selectionWrites << " main thread write syscalls, ";
+	else
+		out << "main thread write syscalls unavailable, ";
+	if (monitor.available())
+		out << selectionChanges << " config folder file changes";
+	else
+		out << "config folder file changes unavailable";
+	out << (selectionWrote ? " (FAILED, expected none)" : "") << "\n";
+	out << "metadata refresh: " << (metadataRefreshed ? "row shows the new name" : "FAILED, row shows \"" + refreshedName + "\"") << "\n";
+	out << "Per-frame timings written to " << (outputPath / "frames.csv").string() << "\n";
+	if (snapshots)
+		out << "Snapshots written to " << snapshotDir.string() << "\n";
+
+	return (running && metadataRefreshed && !selectionWrote) ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+class Window;
+
+// Builds a synthetic library (systems, gamelists, box art) and theme under outputDir/home and points
+// HOME at it, so a benchmark run never reads or writes the user's own configuration. Has to run
+// before anything else reads from the home folder. Fails if outputDir/home exists but wasn't
+// created by an earlier benchmark run.
+bool setup_frame_benchmark_home(const std::string& outputDir);
+
+// Replays a fixed navigation sequence through Window::input at a fixed time step and writes the
+// update/render time of every frame to outputDir/frames.csv. With snapshots, the last frame of each
+// step is also saved to outputDir/snapshots for visual regression comparison. Returns non-zero
+// if a check made along the way fails, e.g. a scraped game's row not showing its new name.
+int run_frame_benchmark(Window& window, const std::string& outputDir, bool snapshots);
@@ -0,0 +1,57 @@
+#include "MediaCompression.h"
+#include <iostream>
+#include <iomanip>
+#include <set>
+#include "SystemData.h"
+#include "Util.h"
+#include "resources/TextureCompressor.h"
+
+int run_media_compression()
+{
+	std::ostream& out = std::cout;
+	TextureCompressor* compressor = TextureCompressor::getInstance();
+
+	out << "EmulationStation media compression\n";
+	out << "==================================\n";
+	if (!compressor->enabled())
+	{
+		out << "Texture compression is not available on this GPU or is turned off.\n";
+		return 1;
+	}
+	out << "Format: " << TextureCompressor::getFormatName(compressor->getFormat()) << "\n\n";
+	out << std::fixed << std::setprecision(2);
+
+	const char* mediaKeys[] = { "image", "thumbnail", "marquee" };
+	std::set<std::string> done; // systems and collections can share images
+	size_t totalImages = 0;
+	size_t totalSaved = 0;
+	for (auto system : SystemData::GetSystems())
+	{
+		size_t images = 0;
+		size_t saved = 0;
+		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
+		for (auto file : files)
+		{
+			for (auto key : mediaKeys)
+			{
+				const std::string path = getCanonicalPath(file->metadata.get(key));
+				if (path.empty() || !done.insert(path).second)
+					continue;
+
+				size_t savedBytes;
+				if (compressor->compressNow(path, savedBytes))
+				{
+					images++;
+					saved += savedBytes;
+				}
+			}
+		}
+
+		out << system->getFullName() << ": " << images << " images, " << saved / 1000.0f / 1000.0f << "MB VRAM saved\n";
+		totalImages += images;
+		totalSaved += saved;
+	}
+
+	out << "\n" << totalImages << " images, " << totalSaved / 1000.0f / 1000.0f << "MB VRAM saved\n";
+	return 0;
+}
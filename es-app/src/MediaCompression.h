@@ -0,0 +1,5 @@
+#pragma once
+
+// Compresses the images of every game in the loaded systems into the texture cache and prints
+// the VRAM saved. Needs the renderer to be initialised so the GPU's formats are known.
+int run_media_compression();
@@ -125,6 +125,24 @@ void MetaDataList::appendToXML(pugi::xml_node parent, bool ignoreDefaults, const
 	}
 }
 
+MetaDataList& MetaDataList::operator=(const MetaDataList& other)
+{
+	// copying the map itself may hand the nodes over to other keys
+	for(auto it = mMap.begin(); it != mMap.end(); )
+	{
+		if(other.mMap.find(it->first) == other.mMap.end())
+			it = mMap.erase(it);
+		else
+			it++;
+	}
+	for(auto it = other.mMap.begin(); it != other.mMap.end(); it++)
+		mMap[it->first] = it->second;
+
+	mType = other.mType;
+	mWasChanged = other.mWasChanged;
+	return *this;
+}
+
 void MetaDataList::set(const std::string& key, const std::string& value)
 {
 	mMap[key] = value;
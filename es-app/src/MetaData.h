@@ -48,6 +48,10 @@ public:
 	void appendToXML(pugi::xml_node parent, bool ignoreDefaults, const boost::filesystem::path& relativeTo) const;
 
 	MetaDataList(MetaDataListType type);
+	MetaDataList(const MetaDataList& other) = default;
+	// Assigns the values in place, so a reference returned by get() stays valid and sees the new
+	// value as long as its key is in both lists. Gamelists keep pointers to the name.
+	MetaDataList& operator=(const MetaDataList& other);
 	
 	void set(const std::string& key, const std::string& value);
 	void setTime(const std::string& key, const boost::posix_time::ptime& time); //times are internally stored as ISO strings (e.g. boost::posix_time::to_iso_string(ptime))
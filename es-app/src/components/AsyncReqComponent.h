@@ -33,6 +33,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	int getRedrawDelay() const override { return 0; } // spinner
 	void render(const Eigen::Affine3f& parentTrans) override;
 
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
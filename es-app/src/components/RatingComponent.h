@@ -2,6 +2,7 @@
 
 #include "GuiComponent.h"
 #include "resources/TextureResource.h"
+#include "Renderer.h"
 
 #define NUM_RATING_STARS 5
 
@@ -38,11 +39,7 @@ private:
 
 	float mValue;
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	} mVertices[12];
+	Renderer::Vertex mVertices[12];
 
 
 	GLubyte mColors[12*4];
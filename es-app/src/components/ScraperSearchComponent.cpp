@@ -347,6 +347,14 @@ bool ScraperSearchComponent::input(InputConfig* config, Input input)
 	return GuiComponent::input(config, input);
 }
 
+int ScraperSearchComponent::getRedrawDelay() const
+{
+	// the busy animation, and polling the requests in update()
+	if(mBlockAccept || mSearchHandle || mMDResolveHandle || mThumbnailReq)
+		return 0;
+	return GuiComponent::getRedrawDelay();
+}
+
 void ScraperSearchComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = parentTrans * getTransform();
@@ -1,4 +1,16 @@
 #include "TextListComponent.h"
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const int k_maxWaitTime = 1000; //ms
+	const int k_marqueeDeltaShift = 1;
+	// screens' worth of row text caches kept, the one on screen plus the pre-warmed ones either side
+	const unsigned int k_cachedScreens = 4;
+	const int k_prewarmRowsPerFrame = 2;
+}
 
 TextListComponent::TextListComponent(Window* window) :
 	BaseT(window),
@@ -16,6 +28,7 @@ TextListComponent::TextListComponent(Window* window) :
 	m_gameCollectionImage.setImage(":/star_filled.svg");
 
 	mMarqueeOffset = 0;
+	mRenderFrame = 0;
 
 	mHorizontalMargin = 0;
 	mAlignment = ALIGN_CENTER;
@@ -42,23 +55,23 @@ TextListComponent::TextListComponent(Window* window) :
 void TextListComponent::update(int deltaTime)
 {
 	listUpdate(deltaTime);
+	mMarqueeActive = false;
 	if (!isScrolling() && size() > 0)
 	{
-		static const int k_maxWaitTime = 1000; //ms
-		static const int k_marqueeDeltaShift = 1;
-
 		const Entry& selectedEntry = mEntries.at(( unsigned int ) mCursor);
 
 		float extraLeftMargin = m_gameCollectionImage.getSize().x() * mGameCollectionImageScale;
 
-		const std::string& text = selectedEntry.name;
-		const Eigen::Vector2f textSize = mFont->sizeText(text);
+		// the row's text cache knows its size, measuring the name again would lay it out every frame
+		BuildTextCache(mCursor, GetColor(mCursor, selectedEntry.data.colorId));
+		const Eigen::Vector2f textSize = selectedEntry.data.textCache->metrics.size;
 
 		const float textBoxSize = mSize.x() - mHorizontalMargin * 2 - extraLeftMargin;
 		const float exceedingTextSize = textSize.x() - textBoxSize;
 		const float extraRightMargin = 5;
 		if (exceedingTextSize > 0)
 		{
+			mMarqueeActive = true;
 			if (mMarqueeWaitTime > k_maxWaitTime)
 			{
 				if (mMarqueeGoBack)
@@ -93,11 +106,29 @@ void TextListComponent::update(int deltaTime)
 		}
 	}
 
+	PrewarmTextCaches();
+
 	mBar.posY += ( mBar.targetPosY - mBar.posY ) * 0.25f;
+	if (std::abs(mBar.targetPosY - mBar.posY) < 0.5f)
+		mBar.posY = mBar.targetPosY;
 
 	GuiComponent::update(deltaTime);
 }
 
+int TextListComponent::getRedrawDelay() const
+{
+	if (mBar.posY != mBar.targetPosY)
+		return 0;
+
+	int delay = BaseT::getRedrawDelay();
+	if (mMarqueeActive)
+	{
+		// nothing moves while the marquee waits at either end
+		delay = earliestRedraw(delay, std::max(k_maxWaitTime - mMarqueeWaitTime + 1, 0));
+	}
+	return delay;
+}
+
 void TextListComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = parentTrans * getTransform();
@@ -109,6 +140,7 @@ void TextListComponent::render(const Eigen::Affine3f& parentTrans)
 	{
 		return;
 	}
+	mRenderFrame++;
 	std::pair<int, int> edges = ComputeListEdgeIndexes();
 	RenderSelectorImage(trans, edges.first, edges.second);
 
@@ -123,7 +155,8 @@ void TextListComponent::render(const Eigen::Affine3f& parentTrans)
 		BaseT::Entry& entry = mEntries.at(( unsigned int ) i);
 
 		unsigned int color = GetColor(i , entry.data.colorId);
-		BuildTextCache(entry, color);
+		BuildTextCache(i, color);
+		entry.data.cacheUsed = mRenderFrame;
 
 		const bool isInAnyGC = IsInGameCollection(i);
 
@@ -145,6 +178,8 @@ void TextListComponent::render(const Eigen::Affine3f& parentTrans)
 
 	Renderer::popClipRect();
 
+	TrimTextCaches();
+
 	listRenderTitleOverlay(trans);
 
 	GuiComponent::renderChildren(trans);
@@ -278,14 +313,89 @@ uint32_t TextListComponent::GetColor(int i, uint32_t defaultColorId) const
 
 }
 
-void TextListComponent::BuildTextCache(BaseT::Entry& entry, uint32_t color)
+void TextListComponent::BuildTextCache(int i, uint32_t color)
 {
+	BaseT::Entry& entry = mEntries.at(( unsigned int ) i);
 	if (!entry.data.textCache)
-		entry.data.textCache = std::unique_ptr<TextCache>(mFont->buildTextCache(mUppercase ? strToUpper(entry.name) : entry.name, 0, 0, 0x000000FF));
+	{
+		std::string text;
+		switch (entry.object->getType())
+		{
+		case FOLDER:
+			text = "[ " + entry.getName() + " ]";
+			break;
+		case PLACEHOLDER:
+			text = entry.getName();
+			break;
+		default:
+			text = "  " + entry.getName();
+			break;
+		}
+		entry.data.textCache = std::unique_ptr<TextCache>(mFont->buildTextCache(mUppercase ? strToUpper(text) : text, 0, 0, 0x000000FF));
+		entry.data.cacheUsed = mRenderFrame;
+		mCachedRows.push_back(i);
+	}
 
 	entry.data.textCache->setColor(color);
 }
 
+void TextListComponent::TrimTextCaches()
+{
+	// trimmed once a quarter over, so scrolling doesn't sort the rows on every new one
+	const size_t maxRows = std::max<size_t>(GetFullyVisibleRowCount(), 1) * k_cachedScreens;
+	if (mCachedRows.size() <= maxRows + maxRows / 4)
+		return;
+
+	// forget the rows that lost their cache when the list was repopulated
+	std::sort(mCachedRows.begin(), mCachedRows.end());
+	mCachedRows.erase(std::unique(mCachedRows.begin(), mCachedRows.end()), mCachedRows.end());
+	mCachedRows.erase(std::remove_if(mCachedRows.begin(), mCachedRows.end(),
+		[this](int i) { return i >= size() || !mEntries.at(( unsigned int ) i).data.textCache; }), mCachedRows.end());
+	if (mCachedRows.size() <= maxRows)
+		return;
+
+	// most recently drawn first
+	std::sort(mCachedRows.begin(), mCachedRows.end(), [this](int a, int b)
+		{ return mEntries.at(( unsigned int ) a).data.cacheUsed > mEntries.at(( unsigned int ) b).data.cacheUsed; });
+	for (size_t row = maxRows; row < mCachedRows.size(); row++)
+		mEntries.at(( unsigned int ) mCachedRows[row]).data.textCache.reset();
+	mCachedRows.resize(maxRows);
+}
+
+void TextListComponent::ClearTextCaches()
+{
+	for (auto it = mEntries.begin(); it != mEntries.end(); it++)
+		it->data.textCache.reset();
+	mCachedRows.clear();
+}
+
+void TextListComponent::PrewarmTextCaches()
+{
+	// rows skipped over while scrolling fast are never drawn
+	if (size() == 0 || isScrolling())
+		return;
+
+	// TextCaches point into the font's glyph textures, so they're built here rather than on another
+	// thread, a few rows a frame, nearest to the screen first.
+	const std::pair<int, int> edges = ComputeListEdgeIndexes();
+	const int screenRows = edges.second - edges.first;
+	int built = 0;
+	for (int distance = 0; distance < screenRows && built < k_prewarmRowsPerFrame; distance++)
+	{
+		const int rows[] = { edges.second + distance, edges.first - 1 - distance };
+		for (int row : rows)
+		{
+			if (row >= 0 && row < size() && !mEntries.at(( unsigned int ) row).data.textCache && built < k_prewarmRowsPerFrame)
+			{
+				if (!FrameScheduler::getInstance()->runDeferred())
+					return;
+				BuildTextCache(row, GetColor(row, mEntries.at(( unsigned int ) row).data.colorId));
+				built++;
+			}
+		}
+	}
+}
+
 float TextListComponent::GetRowHeight() const
 {
 	const float rowHeight = mFont->getSize() * mLineSpacing;
@@ -370,7 +480,6 @@ bool TextListComponent::input(InputConfig* config, Input input)
 
 //list management stuff
 void TextListComponent::add(
-	const std::string& name, 
 	FileData* obj,
 	unsigned int color,
 	unsigned int imageColor)
@@ -378,14 +487,37 @@ void TextListComponent::add(
 	assert(color < COLOR_ID_COUNT);
 
 	BaseT::Entry entry;
-	entry.name = name;
+	// the name lives in the game's metadata, which is assigned in place when a game is scraped
+	entry.name = &obj->getName();
 	entry.object = obj;
 	entry.data.colorId = color;
 	entry.data.imageColorId = imageColor;
+	entry.data.cacheUsed = 0;
 
 	BaseT::add(entry);
 }
 
+void TextListComponent::refresh(FileData* obj)
+{
+	// a highlighted game has two rows
+	for (auto it = mEntries.begin(); it != mEntries.end(); it++)
+	{
+		if (it->object == obj)
+			it->data.textCache.reset();
+	}
+}
+
+void TextListComponent::onEntryRemoved(int index)
+{
+	// keep pointing at the same rows
+	mCachedRows.erase(std::remove(mCachedRows.begin(), mCachedRows.end(), index), mCachedRows.end());
+	for (auto it = mCachedRows.begin(); it != mCachedRows.end(); it++)
+	{
+		if (*it > index)
+			(*it)--;
+	}
+}
+
 void TextListComponent::onCursorChanged(const CursorState& state)
 {
 	mMarqueeOffset = 0;
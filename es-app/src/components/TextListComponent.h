@@ -19,6 +19,7 @@ struct TextListData
 	unsigned int colorId;
 	unsigned int imageColorId;
 	std::shared_ptr<TextCache> textCache;
+	unsigned int cacheUsed; // frame the text cache was last drawn in
 };
 
 //A graphical list. Supports multiple colors for rows and scrolling.
@@ -44,10 +45,14 @@ public:
 	
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	int getRedrawDelay() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
-	void add(const std::string& name, FileData* obj, unsigned int colorId, unsigned int imageColor);
+	// The entry shows the name of obj, which must outlive it: folders in brackets, games indented
+	void add(FileData* obj, unsigned int colorId, unsigned int imageColor);
+	// Redraws the rows of obj, after its name changed
+	void refresh(FileData* obj);
 	
 	enum Alignment
 	{
@@ -63,15 +68,13 @@ public:
 	inline void setFont(const std::shared_ptr<Font>& font)
 	{
 		mFont = font;
-		for(auto it = mEntries.begin(); it != mEntries.end(); it++)
-			it->data.textCache.reset();
+		ClearTextCaches();
 	}
 
 	inline void setUppercase(bool uppercase) 
 	{
 		mUppercase = true;
-		for(auto it = mEntries.begin(); it != mEntries.end(); it++)
-			it->data.textCache.reset();
+		ClearTextCaches();
 	}
 
 	inline void setSelectorHeight(float selectorScale) { mSelectorHeight = selectorScale; }
@@ -86,6 +89,7 @@ public:
 protected:
 	virtual void onScroll(int amt) { if(mScrollSound) mScrollSound->play(); }
 	virtual void onCursorChanged(const CursorState& state);
+	virtual void onEntryRemoved(int index);
 
 	struct OffsetData
 	{
@@ -101,7 +105,12 @@ protected:
 	void RenderSelectorImage(Eigen::Affine3f trans, int startEntry, int listCutoff);
 	void RenderBar(const uint32_t visibleCount);
 	uint32_t GetColor(int i, uint32_t defaultColorId) const;
-	void BuildTextCache(BaseT::Entry& entry, uint32_t color);
+	void BuildTextCache(int i, uint32_t color);
+	// Frees the text caches of the rows drawn least recently, so only a few screens' worth are kept
+	void TrimTextCaches();
+	void ClearTextCaches();
+	// Builds a few of the rows just off screen per frame, while the list isn't scrolling fast
+	void PrewarmTextCaches();
 	float GetRowHeight() const;
 	uint32_t GetFullyVisibleRowCount() const;
 	std::pair<int, int> ComputeListEdgeIndexes() const;
@@ -128,6 +137,7 @@ private:
 	int mMarqueeOffset;
 	int mMarqueeWaitTime = 0;
 	bool mMarqueeGoBack = false;
+	bool mMarqueeActive = false; // the selected name doesn't fit
 
 	Alignment mAlignment;
 	float mHorizontalMargin;
@@ -146,6 +156,9 @@ private:
 	static const unsigned int COLOR_ID_COUNT = 3;
 	unsigned int mColors[COLOR_ID_COUNT];
 
+	std::vector<int> mCachedRows; // entries that have a text cache, may hold stale indexes after a repopulate
+	unsigned int mRenderFrame;
+
 	ImageComponent mSelectorImage;
 	ImageComponent m_gameCollectionImage;
 	float mGameCollectionImageScale;
@@ -333,6 +333,7 @@ GuiMenu::GuiMenu(gui::Context& context)
 			styles.push_back("basic");
 			styles.push_back("detailed");
 			styles.push_back("video");
+			styles.push_back("grid");
 			for (auto it = styles.begin(); it != styles.end(); it++)
 				gamelist_style->add(*it, *it, Settings::getInstance()->getString("GamelistViewStyle") == *it);
 			s->addWithLabel("GAMELIST VIEW STYLE", gamelist_style);
@@ -73,11 +73,6 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 
 GuiScraperMulti::~GuiScraperMulti()
 {
-	// view type probably changed (basic -> detailed)
-	for (SystemData* system : SystemData::GetSystems())
-	{
-		ViewController::get()->reloadGameListView(system, false);
-	}
 }
 
 void GuiScraperMulti::onSizeChanged()
@@ -117,6 +112,8 @@ void GuiScraperMulti::acceptResult(const ScraperSearchResult& result)
 
 	search.game->metadata = result.mdl;
 	writeGamelistToFile(search.system);
+	// patches the game's row, or switches the view to detailed with the first image
+	ViewController::get()->onFileChanged(search.game, FILE_METADATA_CHANGED);
 
 	mSearchQueue.pop();
 	mCurrentGame++;
@@ -14,10 +14,18 @@
 #include "platform.h"
 #include "Log.h"
 #include "Window.h"
+#include "FrameScheduler.h"
 #include "SystemScreenSaver.h"
 #include "EmulationStation.h"
 #include "Settings.h"
 #include "ScraperCmdLine.h"
+#include "DecodeBenchmark.h"
+#include "MediaCompression.h"
+#include "FrameBenchmark.h"
+#include "resources/VideoPosterCache.h"
+#include "helpers/VlcMediaLoader.h"
+#include "resources/TextureCompressor.h"
+#include "resources/Font.h"
 #include <sstream>
 #include <boost/locale.hpp>
 
@@ -30,6 +38,10 @@
 namespace fs = boost::filesystem;
 
 bool scrape_cmdline = false;
+std::string decode_benchmark_dir;
+bool compress_media_cmdline = false;
+std::string frame_benchmark_dir;
+bool frame_benchmark_snapshots = false;
 
 bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height)
 {
@@ -74,9 +86,43 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 			bool vsync = (strcmp(argv[i + 1], "on") == 0 || strcmp(argv[i + 1], "1") == 0) ? true : false;
 			Settings::getInstance()->setBool("VSync", vsync);
 			i++; // skip vsync value
+		}else if(strcmp(argv[i], "--renderer") == 0)
+		{
+			bool shaders = strcmp(argv[i + 1], "shader") == 0;
+			Settings::getInstance()->setBool("ShaderRenderer", shaders);
+			i++; // skip renderer name
 		}else if(strcmp(argv[i], "--scrape") == 0)
 		{
 			scrape_cmdline = true;
+		}else if(strcmp(argv[i], "--decode-benchmark") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "No image directory supplied.";
+				return false;
+			}
+
+			decode_benchmark_dir = argv[i + 1];
+			i++; // skip the directory
+		}else if(strcmp(argv[i], "--compress-media") == 0)
+		{
+			compress_media_cmdline = true;
+		}else if(strcmp(argv[i], "--headless") == 0)
+		{
+			Settings::getInstance()->setBool("Headless", true);
+		}else if(strcmp(argv[i], "--benchmark") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "No benchmark output directory supplied.";
+				return false;
+			}
+
+			// already set up by main(), before anything read the real home folder
+			i++; // skip the directory
+		}else if(strcmp(argv[i], "--benchmark-snapshots") == 0)
+		{
+			frame_benchmark_snapshots = true;
 		}else if(strcmp(argv[i], "--max-vram") == 0)
 		{
 			int maxVRAM = atoi(argv[i + 1]);
@@ -106,7 +152,14 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 				"--scrape			scrape using command line interface\n"
 				"--windowed			not fullscreen, should be used with --resolution\n"
 				"--vsync [1/on or 0/off]		turn vsync on or off (default is on)\n"
+				"--renderer [fixed or shader]	draw with the fixed function pipeline (default) or shaders\n"
 				"--max-vram [size]		Max VRAM to use in Mb before swapping. 0 for unlimited\n"
+				"--decode-benchmark [dir]	time image decoding of the JPEG/PNG files in dir, then quit\n"
+				"--compress-media		compress all game images for this GPU ahead of time, then quit\n"
+				"--headless			render offscreen, without a display or GPU\n"
+				"--benchmark [dir]		replay a fixed navigation sequence on a generated library, write\n"
+				"				per-frame timings to dir, then quit\n"
+				"--benchmark-snapshots		also save a PNG of every benchmark step for comparison\n"
 				"--help, -h			summon a sentient, angry tuba\n\n"
 				"More information available in README.md.\n";
 			return false; //exit after printing help
@@ -161,12 +214,44 @@ bool loadSystemConfigFile(const char** errorString)
 	return true;
 }
 
+// Returns false if the event asks us to quit
+bool handleEvent(const SDL_Event& event, Window* window)
+{
+	switch(event.type)
+	{
+		case SDL_JOYHATMOTION:
+		case SDL_JOYBUTTONDOWN:
+		case SDL_JOYBUTTONUP:
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		case SDL_JOYAXISMOTION:
+		case SDL_TEXTINPUT:
+		case SDL_TEXTEDITING:
+		case SDL_JOYDEVICEADDED:
+		case SDL_JOYDEVICEREMOVED:
+			InputManager::getInstance()->parseEvent(event, window);
+			break;
+		case SDL_QUIT:
+			return false;
+	}
+	return true;
+}
+
 //called on exit, assuming we get far enough to have the log initialized
 void onExit()
 {
 	Log::close();
 }
 
+//stops the background workers before the singletons and the vlc instance they use go away
+void stopWorkers()
+{
+	VideoPosterCache::getInstance()->deinit();
+	VlcMediaLoader::getInstance()->deinit();
+	TextureCompressor::getInstance()->deinit();
+	Font::stopPrewarm();
+}
+
 int main(int argc, char* argv[])
 {
 	srand((unsigned int)time(NULL));
@@ -177,6 +262,16 @@ int main(int argc, char* argv[])
 	std::locale::global(boost::locale::generator().generate(""));
 	boost::filesystem::path::imbue(std::locale());
 
+	// the frame benchmark runs in a generated home folder, which has to be in place before
+	// settings, input config or the log are read from the real one
+	for(int i = 1; i < argc - 1; i++)
+	{
+		if(strcmp(argv[i], "--benchmark") == 0)
+			frame_benchmark_dir = argv[i + 1];
+	}
+	if(!frame_benchmark_dir.empty() && !setup_frame_benchmark_home(frame_benchmark_dir))
+		return 1;
+
 	if(!parseArgs(argc, argv, &width, &height))
 		return 0;
 
@@ -224,6 +319,10 @@ int main(int argc, char* argv[])
 	//always close the log on exit
 	atexit(&onExit);
 
+	//run the decode benchmark then quit
+	if(!decode_benchmark_dir.empty())
+		return run_decode_benchmark(decode_benchmark_dir);
+
 
 	libvlc_instance_t* vlcInstance;
 	vlc::helper::InitVLC(&vlcInstance);
@@ -285,6 +384,28 @@ int main(int argc, char* argv[])
 		return run_scraper_cmdline();
 	}
 
+	//compress game images then quit
+	if(compress_media_cmdline)
+	{
+		int ret = run_media_compression();
+		window.deinit();
+		stopWorkers();
+		SystemData::deleteSystems();
+		return ret;
+	}
+
+	//replay the benchmark sequence then quit
+	if(!frame_benchmark_dir.empty())
+	{
+		int ret = errorMsg == NULL ? run_frame_benchmark(window, frame_benchmark_dir, frame_benchmark_snapshots) : 1;
+		while(window.peekGui() != ViewController::get())
+			delete window.peekGui();
+		window.deinit();
+		stopWorkers();
+		SystemData::deleteSystems();
+		return ret;
+	}
+
 	//dont generate joystick events while we're loading (hopefully fixes "automatically started emulator" bug)
 	SDL_JoystickEventState(SDL_DISABLE);
 
@@ -310,7 +431,7 @@ int main(int argc, char* argv[])
 	//generate joystick events since we're done loading
 	SDL_JoystickEventState(SDL_ENABLE);
 
-	int lastTime = SDL_GetTicks();
+	FrameScheduler::getInstance()->reset();
 	bool running = true;
 	std::clock_t c_end = std::clock();
 	
@@ -319,41 +440,37 @@ int main(int argc, char* argv[])
 	while(running)
 	{
 		SDL_Event event;
+
+		// if nothing on screen is changing, block until there is input or something is due
+		// instead of drawing the same frame at the refresh rate
+		const int idleTimeout = window.getIdleTimeout();
+		const bool idle = idleTimeout != 0;
+		if(idle)
+		{
+			const unsigned int waitStart = SDL_GetTicks();
+			const int gotEvent = (idleTimeout > 0) ? SDL_WaitEventTimeout(&event, idleTimeout) : SDL_WaitEvent(&event);
+			window.onIdleWait(SDL_GetTicks() - waitStart);
+			if(gotEvent && !handleEvent(event, &window))
+				running = false;
+		}
+
 		while(SDL_PollEvent(&event))
 		{
-			switch(event.type)
-			{
-				case SDL_JOYHATMOTION:
-				case SDL_JOYBUTTONDOWN:
-				case SDL_JOYBUTTONUP:
-				case SDL_KEYDOWN:
-				case SDL_KEYUP:
-				case SDL_JOYAXISMOTION:
-				case SDL_TEXTINPUT:
-				case SDL_TEXTEDITING:
-				case SDL_JOYDEVICEADDED:
-				case SDL_JOYDEVICEREMOVED:
-					InputManager::getInstance()->parseEvent(event, &window);
-					break;
-				case SDL_QUIT:
-					running = false;
-					break;
-			}
+			if(!handleEvent(event, &window))
+				running = false;
 		}
 
 		if(window.isSleeping())
 		{
-			lastTime = SDL_GetTicks();
+			FrameScheduler::getInstance()->reset();
 			SDL_Delay(1); // this doesn't need to be accurate, we're just giving up our CPU time until something wakes us up
 			continue;
 		}
 
-		int curTime = SDL_GetTicks();
-		int deltaTime = curTime - lastTime;
-		lastTime = curTime;
+		int deltaTime = FrameScheduler::getInstance()->beginFrame(idle);
 
-		// cap deltaTime at 1000
-		if(deltaTime > 1000 || deltaTime < 0)
+		// cap deltaTime at 1000, unless we were idle: timers like the screensaver's have to see the whole wait
+		if((deltaTime > 1000 && !idle) || deltaTime < 0)
 			deltaTime = 1000;
 
 		window.update(deltaTime);
@@ -366,6 +483,7 @@ int main(int argc, char* argv[])
 	while(window.peekGui() != ViewController::get())
 		delete window.peekGui();
 	window.deinit();
+	stopWorkers();
 
 	SystemData::SaveConfig();
 	SystemData::deleteSystems();
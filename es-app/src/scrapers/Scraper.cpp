@@ -1,6 +1,8 @@
 #include "scrapers/Scraper.h"
 #include "Log.h"
 #include "Settings.h"
+#include "Util.h"
+#include "resources/TextureCompressor.h"
 #include <FreeImage.h>
 #include <boost/filesystem.hpp>
 #include <boost/assign.hpp>
@@ -204,6 +206,9 @@ void ImageDownloadHandle::update()
 		return;
 	}
 
+	// get it ready for the GPU before it is first shown
+	TextureCompressor::getInstance()->compressLater(getCanonicalPath(mSavePath));
+
 	setStatus(ASYNC_DONE);
 }
 
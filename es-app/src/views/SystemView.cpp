@@ -41,7 +41,7 @@ void SystemView::populate()
 			getViewElements(theme);
 
 		Entry e;
-		e.name = system->getName();
+		e.name = &system->getName();
 		e.object = system;
 
 		// make logo
@@ -359,7 +359,9 @@ void SystemView::render(const Eigen::Affine3f& parentTrans)
 	auto systemInfoZIndex = mSystemInfo.getZIndex();
 	auto minMax = std::minmax(mCarousel.zIndex, systemInfoZIndex);
 
-	renderExtras(trans, INT16_MIN, minMax.first);
+	// the bottom extras are the first thing drawn, straight onto the cleared screen
+	const Eigen::Vector4i rect((int)trans.translation().x(), (int)trans.translation().y(), (int)mSize.x(), (int)mSize.y());
+	mExtrasCache.render(rect, isAnimating(), [&] { renderExtras(trans, INT16_MIN, minMax.first); });
 	renderFade(trans);
 
 	if (mCarousel.zIndex > mSystemInfo.getZIndex()) {
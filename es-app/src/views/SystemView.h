@@ -6,6 +6,7 @@
 #include "components/ScrollableContainer.h"
 #include "components/IList.h"
 #include "resources/TextureResource.h"
+#include "RenderLayerCache.h"
 
 class SystemData;
 class AnimatedImageComponent;
@@ -74,6 +75,7 @@ private:
 	// unit is list index
 	float mCamOffset;
 	float mExtrasCamOffset;
+	RenderLayerCache mExtrasCache; // the extras below the carousel and info bar
 	float mExtrasFadeOpacity;
 
 	bool mViewNeedsReload;
@@ -477,15 +477,7 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	bool themeHasVideoView = system->getTheme()->hasView("video");
 
 	//decide type
-	GameListViewType selectedViewType = AUTOMATIC;
-
-	std::string viewPreference = Settings::getInstance()->getString("GamelistViewStyle");
-	if (viewPreference.compare("basic") == 0)
-		selectedViewType = BASIC;
-	if (viewPreference.compare("detailed") == 0)
-		selectedViewType = DETAILED;
-	if (viewPreference.compare("video") == 0)
-		selectedViewType = VIDEO;
+	GameListViewType selectedViewType = getGameListViewPreference();
 
 	if (selectedViewType == AUTOMATIC)
 	{
@@ -514,9 +506,9 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	case DETAILED:
 		view = std::shared_ptr<IGameListView>(new DetailedGameListView(mWindow, system->getRootFolder()));
 		break;
-		// case GRID placeholder for future implementation.
-		//		view = std::shared_ptr<IGameListView>(new GridGameListView(mWindow, system->getRootFolder()));
-		//		break;
+	case GRID:
+		view = std::shared_ptr<IGameListView>(new GridGameListView(mWindow, system->getRootFolder()));
+		break;
 	case BASIC:
 	default:
 		view = std::shared_ptr<IGameListView>(new BasicGameListView(mWindow, system->getRootFolder()));
@@ -581,6 +573,14 @@ void ViewController::update(int deltaTime)
 	}
 }
 
+int ViewController::getRedrawDelay() const
+{
+	// only the current view is updated, the other views are off screen or sliding in with our camera
+	if(isAnimating() || (mEasterEggImage && mEasterEggImage->isAnimating()))
+		return 0;
+	return mCurrentView ? mCurrentView->getRedrawDelay() : -1;
+}
+
 void ViewController::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = mCamera * parentTrans;
@@ -627,6 +627,35 @@ void ViewController::preload()
 	}
 }
 
+ViewController::GameListViewType ViewController::getGameListViewPreference() const
+{
+	std::string viewPreference = Settings::getInstance()->getString("GamelistViewStyle");
+	if (viewPreference.compare("basic") == 0)
+		return BASIC;
+	if (viewPreference.compare("detailed") == 0)
+		return DETAILED;
+	if (viewPreference.compare("video") == 0)
+		return VIDEO;
+	if (viewPreference.compare("grid") == 0)
+		return GRID;
+	return AUTOMATIC;
+}
+
+bool ViewController::changesGameListViewType(FileData* file)
+{
+	auto it = mGameListViews.find(file->getSystem());
+	if (it == mGameListViews.end() || getGameListViewPreference() != AUTOMATIC)
+		return false;
+
+	// only upgrades, a view goes back to basic after its last image is removed on the next full reload
+	const std::string current = it->second->getName();
+	if (current == "video")
+		return false;
+	if (!file->getVideoPath().empty() && file->getSystem()->getTheme()->hasView("video"))
+		return true;
+	return current == "basic" && !file->getThumbnailPath().empty();
+}
+
 void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
 {
 	for (auto it = mGameListViews.begin(); it != mGameListViews.end(); it++)
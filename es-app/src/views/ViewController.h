@@ -27,6 +27,9 @@ public:
 	// the current gamelist view (as it may change to be detailed).
 	void reloadGameListView(IGameListView* gamelist, bool reloadTheme = false);
 	inline void reloadGameListView(SystemData* system, bool reloadTheme = false) { reloadGameListView(getGameListView(system).get(), reloadTheme); }
+	// True if a change to file calls for another kind of view for its system's gamelist: with the
+	// automatic style, the first image or video. Other changes are patched into the existing view.
+	bool changesGameListViewType(FileData* file);
 	void reloadAll(); // Reload everything with a theme.  Used when the "ThemeSet" setting changes.
 
 	// Navigation.
@@ -47,6 +50,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	int getRedrawDelay() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
 	enum ViewMode
@@ -62,8 +66,8 @@ public:
 		AUTOMATIC,
 		BASIC,
 		DETAILED,
-		VIDEO
-		// GRID TODO!
+		VIDEO,
+		GRID
 	};
 
 	struct State
@@ -93,6 +97,7 @@ private:
 	void InitBackgroundMusic();
 	void playViewTransition(const std::string& transition);
 	int getSystemId(SystemData* system);
+	GameListViewType getGameListViewPreference() const;
 	void PlayEasterEgg();
 	void StopEasterEgg();
 	
@@ -8,6 +8,11 @@
 #include "FileFilterIndex.h"
 #include "guis/GuiTextEditPopupKeyboard.h"
 
+namespace
+{
+	const int k_prefetchAhead = 3; // entries
+}
+
 BasicGameListView::BasicGameListView(Window* window, FileData* root)
 	: ISimpleGameListView(window, root), mList(window), 
 	mFilterKey()
@@ -29,21 +34,54 @@ void BasicGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme)
 	sortChildren();
 }
 
-void BasicGameListView::onFileChanged(FileData* file, FileChangeType change)
+void BasicGameListView::updateFile(FileData* file)
 {
-	if(change == FILE_METADATA_CHANGED)
+	// with a filter on, the new metadata may take the file in or out of the list
+	if(mRoot->getSystem()->getIndex()->isFiltered() || !mFilterKey.empty())
 	{
-		// might switch to a detailed view
-		ViewController::get()->reloadGameListView(this);
+		repopulate();
 		return;
 	}
 
-	ISimpleGameListView::onFileChanged(file, change);
+	// the order stays until the list is sorted again
+	mList.refresh(file);
+	if(mList.size() > 0 && mList.getSelected() == file)
+		updateInfoPanel();
+}
+
+void BasicGameListView::prefetchMedia()
+{
+	// Nothing is shown while scrolling fast, loading what gets skipped over would only get in the way
+	if(mList.size() < 2 || mList.isScrolling())
+		return;
+
+	if(mList.getScrollingVelocity() != 0)
+		mPrefetchStep = mList.getScrollingVelocity();
+
+	const int cursor = mList.getSelectedIndex();
+	std::vector<std::string> paths;
+	auto addEntry = [this, cursor, &paths](int index)
+	{
+		const int size = mList.size();
+		index = ((index % size) + size) % size;
+		if(index == cursor)
+			return;
+		const std::vector<std::string> media = getMediaPaths(mList.getObjectAt(index));
+		paths.insert(paths.end(), media.begin(), media.end());
+	};
+
+	for(int i = 1; i <= k_prefetchAhead; i++)
+		addEntry(cursor + mPrefetchStep * i);
+	// going back one is the most likely change of direction
+	addEntry(cursor - mPrefetchStep);
+
+	mPrefetcher.prefetch(paths);
 }
 
 void BasicGameListView::populateList(const std::vector<FileData*>& files)
 {
 	mList.clear();
+	mList.reserve(files.size());
 	std::size_t hiddenCount = 0;
 	if (files.size() > 0)
 	{
@@ -83,16 +121,16 @@ void BasicGameListView::populateList(const std::vector<FileData*>& files)
 		{
 			for (FileData* filedata : highlights)
 			{
-				mList.add("  " + filedata->getName(), filedata, 0, 2);
+				mList.add(filedata, 0, 2);
 			}
 		}
 		for ( FileData* filedata : folders )
 		{
-			mList.add("[ " + filedata->getName() + " ]", filedata, 1, 0);
+			mList.add(filedata, 1, 0);
 		}
 		for ( FileData* filedata : games )
 		{
-			mList.add("  " + filedata->getName(), filedata, 0, 0);
+			mList.add(filedata, 0, 0);
 		}
 
 	}
@@ -100,12 +138,12 @@ void BasicGameListView::populateList(const std::vector<FileData*>& files)
 	{
 		// empty list - add a placeholder
 		FileData* placeholder = new FileData(PLACEHOLDER, "<No Results Found for Current Filter Criteria>", this->mRoot->getSystem());
-		mList.add(placeholder->getName(), placeholder, (placeholder->getType() == PLACEHOLDER), 0);
+		mList.add(placeholder, (placeholder->getType() == PLACEHOLDER), 0);
 		if (hiddenCount > 0)
 		{
 			const std::string text = "<" + std::to_string(hiddenCount) + " hidden games>";
 			FileData* placeholder = new FileData(PLACEHOLDER, text, this->mRoot->getSystem());
-			mList.add(placeholder->getName(), placeholder, ( placeholder->getType() == PLACEHOLDER ), 0);
+			mList.add(placeholder, ( placeholder->getType() == PLACEHOLDER ), 0);
 		}
 	}
 }
@@ -195,16 +233,6 @@ bool BasicGameListView::input(InputConfig* config, Input input)
 	return ISimpleGameListView::input(config, input);
 }
 
-void BasicGameListView::onFilterChanged(const std::string& filter)
-{
-	if (filter != mFilterKey)
-	{
-		mFilterKey = filter;
-		std::transform(mFilterKey.begin(), mFilterKey.end(), mFilterKey.begin(), ::tolower);
-		populateList(mRoot->getChildrenListToDisplay());
-	}
-}
-
 void Tokenize(const std::string& i_text, const std::string& i_delimiter, std::vector<std::string>& o_tokens)
 {
 	std::size_t start = 0;
@@ -212,30 +240,40 @@ void Tokenize(const std::string& i_text, const std::string& i_delimiter, std::ve
 	while (end != std::string::npos)
 	{
 		end = i_text.find(i_delimiter, start);
-		o_tokens.emplace_back(i_text.substr(start, end));
+		o_tokens.emplace_back(i_text.substr(start, end == std::string::npos ? end : end - start));
 		start = std::min(end + i_delimiter.length(), i_text.length());
 	};
 }
 
-bool BasicGameListView::acceptFilter(const std::string& name) const
+void BasicGameListView::onFilterChanged(const std::string& filter)
 {
-	if (mFilterKey.empty())
+	if (filter != mFilterKey)
 	{
-		return true;
+		mFilterKey = filter;
+		std::transform(mFilterKey.begin(), mFilterKey.end(), mFilterKey.begin(), ::tolower);
+		mFilterTokens.clear();
+		if (!mFilterKey.empty())
+		{
+			Tokenize(mFilterKey, " ", mFilterTokens);
+		}
+		populateList(mRoot->getChildrenListToDisplay());
 	}
-	const std::string lowerText = mFilterKey;
-	const std::string lowerName = strToLower(name);
-	std::vector<std::string> tokens;
-	Tokenize(lowerText, " ", tokens);
-	std::size_t pos = 0;
-	for (std::string& token : tokens)
+}
+
+bool BasicGameListView::acceptFilter(const std::string& name) const
+{
+	// every word of the filter, in order, ignoring case. Called for every file on a repopulate,
+	// so it compares in place rather than lowercasing a copy of the name.
+	auto equalsLower = [](char c, char lower) { return ::tolower(( unsigned char ) c) == lower; };
+	std::string::const_iterator pos = name.begin();
+	for (const std::string& token : mFilterTokens)
 	{
-		pos = lowerName.find(token, pos);
-		if  (pos == std::string::npos)
+		pos = std::search(pos, name.end(), token.begin(), token.end(), equalsLower);
+		if (pos == name.end() && !token.empty())
 		{
 			return false;
 		}
-		pos = std::min(pos + token.length(), lowerName.length());
+		pos += std::min<std::size_t>(token.length(), name.end() - pos);
 	}
 	return true;
 }
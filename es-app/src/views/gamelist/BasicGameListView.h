@@ -2,15 +2,13 @@
 
 #include "views/gamelist/ISimpleGameListView.h"
 #include "components/TextListComponent.h"
+#include "resources/TexturePrefetcher.h"
 
 class BasicGameListView : public ISimpleGameListView
 {
 public:
 	BasicGameListView(Window* window, FileData* root);
 
-	// Called when a FileData* is added, has its metadata changed, or is removed
-	virtual void onFileChanged(FileData* file, FileChangeType change);
-
 	virtual void onThemeChanged(const std::shared_ptr<ThemeData>& theme);
 
 	virtual FileData* getCursor() override;
@@ -19,6 +17,7 @@ public:
 	virtual int getCursorIndex() const override { return mList.getSelectedIndex(); }
 	virtual void setCursorIndex(int index) override { mList.setCursorIndex(index); }
 	virtual uint32_t getHighlightCount() const override { return mHighlightCount; }
+	virtual const std::string& getCursorName() override { return mList.getSelectedName(); }
 
 	virtual const char* getName() const override { return "basic"; }
 
@@ -29,14 +28,25 @@ public:
 
 protected:
 	virtual void populateList(const std::vector<FileData*>& files) override;
+	virtual void updateFile(FileData* file) override;
+	// Shows the metadata of the selected file, in views that have an info panel
+	virtual void updateInfoPanel() {}
 	virtual void remove(FileData* game) override;
 
 	void onFilterChanged(const std::string& filter);
 	bool acceptFilter(const std::string& name) const;
 
+	// The images shown for a file. Views that show images return them so they get loaded ahead of the cursor.
+	virtual std::vector<std::string> getMediaPaths(FileData* file) const { return std::vector<std::string>(); }
+	// Prefetches the media of the entries the cursor is heading for. Call whenever the cursor changes.
+	void prefetchMedia();
+
 
 	TextListComponent mList;
 	uint32_t mHighlightCount = 0;
 	std::string mFilterKey;
+	std::vector<std::string> mFilterTokens; // the words of mFilterKey
+	TexturePrefetcher mPrefetcher;
+	int mPrefetchStep = 1; // last non-zero scroll velocity, the direction and size of the next move
 
 };
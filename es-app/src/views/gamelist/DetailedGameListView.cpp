@@ -57,6 +57,10 @@ DetailedGameListView::DetailedGameListView(Window* window, FileData* root) :
 	addChild(&mLblPlayCount);
 	addChild(&mPlayCount);
 
+	// the labels never change, they join the background's cached layer if the theme puts them below the list
+	for(auto label : getMDLabels())
+		label->setStatic(true);
+
 	mDescContainer.setPosition(mSize.x() * padding, mSize.y() * 0.65f);
 	mDescContainer.setSize(mSize.x() * (0.50f - 2*padding), mSize.y() - mDescContainer.getPosition().y());
 	mDescContainer.setAutoScroll(true);
@@ -194,6 +198,7 @@ void DetailedGameListView::updateInfoPanel()
 		//mDescription.setText("");
 		fadingOut = true;
 	}else{
+		mPrefetcher.onShown(file->metadata.get("image"));
 		mImage.setImage(file->metadata.get("image"));
 		mDescription.setText(file->metadata.get("desc"));
 		mDescContainer.reset();
@@ -237,6 +242,13 @@ void DetailedGameListView::updateInfoPanel()
 			comp->setAnimation(new LambdaAnimation(func, 150), 0, nullptr, fadingOut);
 		}
 	}
+
+	prefetchMedia();
+}
+
+std::vector<std::string> DetailedGameListView::getMediaPaths(FileData* file) const
+{
+	return std::vector<std::string>(1, file->metadata.get("image"));
 }
 
 void DetailedGameListView::launch(FileData* game)
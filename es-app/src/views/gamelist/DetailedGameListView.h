@@ -16,8 +16,11 @@ public:
 
 	virtual void launch(FileData* game) override;
 
+protected:
+	virtual std::vector<std::string> getMediaPaths(FileData* file) const override;
+
 private:
-	void updateInfoPanel();
+	void updateInfoPanel() override;
 
 	void initMDLabels();
 	void initMDValues();
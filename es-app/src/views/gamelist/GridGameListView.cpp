@@ -2,17 +2,29 @@
 #include "ThemeData.h"
 #include "Window.h"
 #include "views/ViewController.h"
+#include "SystemData.h"
+#include <boost/filesystem.hpp>
 
 GridGameListView::GridGameListView(Window* window, FileData* root) : ISimpleGameListView(window, root),
 	mGrid(window)
 {
 	mGrid.setPosition(0, mSize.y() * 0.2f);
 	mGrid.setSize(mSize.x(), mSize.y() * 0.8f);
+	mGrid.setDefaultZIndex(20);
 	addChild(&mGrid);
 
 	populateList(root->getChildrenListToDisplay());
 }
 
+void GridGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme)
+{
+	ISimpleGameListView::onThemeChanged(theme);
+	using namespace ThemeFlags;
+	mGrid.applyTheme(theme, getName(), "gamegrid", ALL);
+
+	sortChildren();
+}
+
 FileData* GridGameListView::getCursor()
 {
 	return mGrid.getSelected();
@@ -20,6 +32,8 @@ FileData* GridGameListView::getCursor()
 
 void GridGameListView::setCursor(FileData* file)
 {
+	if(file->isPlaceHolder())
+		return;
 	if(!mGrid.setCursor(file))
 	{
 		populateList(file->getParent()->getChildrenListToDisplay());
@@ -38,10 +52,38 @@ bool GridGameListView::input(InputConfig* config, Input input)
 void GridGameListView::populateList(const std::vector<FileData*>& files)
 {
 	mGrid.clear();
+	if(files.size() > 0)
+		mHeaderText.setText(files.at(0)->getSystem()->getFullName());
+
+	// only paths are kept, the grid loads the thumbnails of the entries around the cursor
 	for(auto it = files.begin(); it != files.end(); it++)
 	{
+		if((*it)->getType() == GAME && (*it)->isHidden())
+			continue;
 		mGrid.add((*it)->getName(), (*it)->getThumbnailPath(), *it);
 	}
+
+	if(mGrid.size() == 0)
+	{
+		// empty list - add a placeholder
+		FileData* placeholder = new FileData(PLACEHOLDER, "<No Results Found for Current Filter Criteria>", mRoot->getSystem());
+		mGrid.add(placeholder->getName(), "", placeholder);
+	}
+}
+
+void GridGameListView::remove(FileData* game)
+{
+	boost::filesystem::remove(game->getPath());  // actually delete the file on the filesystem
+	if(getCursor() == game)                      // Select next element in grid, or prev if none
+	{
+		const int index = mGrid.getSelectedIndex();
+		if(index + 1 < mGrid.size())
+			setCursor(mGrid.getObjectAt(index + 1));
+		else if(index > 0)
+			setCursor(mGrid.getObjectAt(index - 1));
+	}
+	delete game;                                 // remove before repopulating (removes from parent)
+	onFileChanged(game, FILE_REMOVED);           // update the view, with game removed
 }
 
 void GridGameListView::launch(FileData* game)
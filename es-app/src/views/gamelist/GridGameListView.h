@@ -10,11 +10,16 @@ class GridGameListView : public ISimpleGameListView
 public:
 	GridGameListView(Window* window, FileData* root);
 
-	//virtual void onThemeChanged(const std::shared_ptr<ThemeData>& theme) override;
+	virtual void onThemeChanged(const std::shared_ptr<ThemeData>& theme) override;
 
 	virtual FileData* getCursor() override;
 	virtual void setCursor(FileData*) override;
 
+	virtual int getCursorIndex() const override { return mGrid.getSelectedIndex(); }
+	virtual void setCursorIndex(int index) override { mGrid.setCursorIndex(index); }
+	virtual uint32_t getHighlightCount() const override { return 0; }
+	virtual const std::string& getCursorName() override { return mGrid.getSelectedName(); }
+
 	virtual bool input(InputConfig* config, Input input) override;
 
 	virtual const char* getName() const override { return "grid"; }
@@ -24,6 +29,7 @@ public:
 
 protected:
 	virtual void populateList(const std::vector<FileData*>& files) override;
+	virtual void remove(FileData* game) override;
 
 	ImageGridComponent<FileData*> mGrid;
 };
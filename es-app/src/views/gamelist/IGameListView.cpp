@@ -53,6 +53,7 @@ void IGameListView::render(const Eigen::Affine3f& parentTrans)
 	Eigen::Vector2i size(mSize.x() * scaleX, mSize.y() * scaleY);
 
 	Renderer::pushClipRect(pos, size);
-	renderChildren(trans);
+	// the view is drawn straight onto the cleared screen, so its bottom layer can come from a cache
+	renderChildrenCached(trans, Eigen::Vector4i(pos.x(), pos.y(), size.x(), size.y()));
 	Renderer::popClipRect();
 }
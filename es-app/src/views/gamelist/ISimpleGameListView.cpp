@@ -9,6 +9,8 @@
 #include "guis/GuiGameCollectionsSettings.h"
 #include "guis/GuiMsgBox.h"
 #include "GameCollections.h"
+#include "Log.h"
+#include <chrono>
 
 ISimpleGameListView::ISimpleGameListView(Window* window, FileData* root) : IGameListView(window, root),
 	mHeaderText(window), mHeaderImage(window), mBackground(window), m_window(window), mHeldPressed(false), mPressEventConsumed(false)
@@ -27,6 +29,11 @@ ISimpleGameListView::ISimpleGameListView(Window* window, FileData* root) : IGame
 	mBackground.setResize(mSize.x(), mSize.y());
 	mBackground.setDefaultZIndex(0);
 
+	// drawn from a cached layer while they don't change (see IGameListView::render)
+	mBackground.setStatic(true);
+	mHeaderImage.setStatic(true);
+	mHeaderText.setStatic(true);
+
 	addChild(&mHeaderText);
 	addChild(&mBackground);
 }
@@ -69,6 +76,7 @@ void ISimpleGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme
 	mThemeExtras = ThemeData::makeExtras(theme, getName(), mWindow);
 	for (auto extra : mThemeExtras)
 	{
+		extra->setStatic(true);
 		addChild(extra);
 	}
 
@@ -84,8 +92,36 @@ void ISimpleGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme
 
 void ISimpleGameListView::onFileChanged(FileData* file, FileChangeType change)
 {
-	// we could be tricky here to be efficient;
-	// but this shouldn't happen very often so we'll just always repopulate
+	const auto start = std::chrono::high_resolution_clock::now();
+	const std::string systemName = mRoot->getSystem()->getName();
+
+	if (change == FILE_METADATA_CHANGED && ViewController::get()->changesGameListViewType(file))
+	{
+		// deletes this view
+		ViewController::get()->reloadGameListView(this);
+	}
+	else if (change == FILE_METADATA_CHANGED)
+	{
+		updateFile(file);
+	}
+	else
+	{
+		repopulate();
+	}
+
+	const auto end = std::chrono::high_resolution_clock::now();
+	LOG(LogDebug) << "Gamelist " << systemName << " updated (change " << change << ") in "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0 << "ms";
+}
+
+void ISimpleGameListView::updateFile(FileData* file)
+{
+	repopulate();
+}
+
+void ISimpleGameListView::repopulate()
+{
+	// the list is refilled in place, the cursor stays on the same file
 	FileData* cursor = getCursor();
 	if (!cursor->isPlaceHolder()) {
 		populateList(cursor->getParent()->getChildrenListToDisplay());
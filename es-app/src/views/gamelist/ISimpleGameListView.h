@@ -16,6 +16,8 @@ public:
 	// Called when a new file is added, a file is removed, a file's metadata changes, or a file's children are sorted.
 	// NOTE: FILE_SORTED is only reported for the topmost FileData, where the sort started.
 	//       Since sorts are recursive, that FileData's children probably changed too.
+	// Metadata changes are patched into the rows showing the file, the rest refill the list in
+	// place. The view is only recreated when it changes type (see ViewController::changesGameListViewType).
 	virtual void onFileChanged(FileData* file, FileChangeType change);
 	
 	// Called whenever the theme changes.
@@ -26,6 +28,8 @@ public:
 	virtual int getCursorIndex() const = 0;
 	virtual void setCursorIndex(int index) = 0;
 	virtual uint32_t getHighlightCount() const = 0;
+	// The name shown in the selected row
+	virtual const std::string& getCursorName() = 0;
 
 	virtual bool input(InputConfig* config, Input input) override;
 	virtual void launch(FileData* game) = 0;
@@ -37,6 +41,9 @@ protected:
 	void ShowQuestion(const std::string& mgs, const std::function<void()>& func, const std::string& backButton);
 
 	virtual void populateList(const std::vector<FileData*>& files) = 0;
+	// Shows the new metadata of file. By default the list is refilled.
+	virtual void updateFile(FileData* file);
+	void repopulate();
 
 	TextComponent mHeaderText;
 	ImageComponent mHeaderImage;
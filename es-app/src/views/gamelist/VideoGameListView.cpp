@@ -10,6 +10,20 @@
 #endif
 #include "components/VideoVlcComponent.h"
 #include "guis/GuiContext.h"
+#include "resources/VideoPosterCache.h"
+
+namespace
+{
+	std::string expandHomePath(std::string path)
+	{
+		if(!path.empty() && (path[0] == '~'))
+		{
+			path.erase(0, 1);
+			path.insert(0, getHomePath());
+		}
+		return path;
+	}
+}
 
 VideoGameListView::VideoGameListView(Window* window, FileData* root) :
 	BasicGameListView(window, root),
@@ -115,6 +129,10 @@ void VideoGameListView::initialize()
 	addChild(&mLblPlayCount);
 	addChild(&mPlayCount);
 
+	// the labels never change, they join the background's cached layer if the theme puts them below the list
+	for(auto label : getMDLabels())
+		label->setStatic(true);
+
 	mDescContainer.setPosition(mSize.x() * padding, mSize.y() * 0.65f);
 	mDescContainer.setSize(mSize.x() * (0.50f - 2*padding), mSize.y() - mDescContainer.getPosition().y());
 	mDescContainer.setAutoScroll(true);
@@ -252,7 +270,7 @@ void VideoGameListView::updateInfoPanel()
 {
 	FileData* file = (mList.size() == 0 || mList.isScrolling()) ? NULL : mList.getSelected();
 
-	boost::filesystem::remove(getVideoTitlePath().c_str());
+	mPosterVideo.clear();
 
 	bool fadingOut;
 	if(file == NULL)
@@ -265,34 +283,25 @@ void VideoGameListView::updateInfoPanel()
 		fadingOut = true;
 
 	}else{
-		std::string				video_path;
-		std::string				marquee_path;
-		std::string				thumbnail_path;
-		video_path 			= file->getVideoPath();
-		marquee_path 		= file->getMarqueePath();
-		thumbnail_path 		= file->getThumbnailPath();
-
-		if	(!video_path.empty() && (video_path[0] == '~'))
-		{
-			video_path.erase(0, 1);
-			video_path.insert(0, getHomePath());
-		}
-		if	(!marquee_path.empty() && (marquee_path[0] == '~'))
-		{
-			marquee_path.erase(0, 1);
-			marquee_path.insert(0, getHomePath());
-		}
-		if (!thumbnail_path.empty() && (thumbnail_path[0] == '~'))
-		{
-			thumbnail_path.erase(0, 1);
-			thumbnail_path.insert(0, getHomePath());
-		}
+		const std::string video_path		= expandHomePath(file->getVideoPath());
+		const std::string marquee_path		= expandHomePath(file->getMarqueePath());
+		std::string thumbnail_path			= expandHomePath(file->getThumbnailPath());
+
 		if (!mVideo->setVideo(video_path))
 		{
 			mVideo->setDefaultVideo();
 		}
 		mVideoPlaying = true;
 
+		// Without a thumbnail a frame of the video stands in, once it has been extracted
+		if (thumbnail_path.empty() && !video_path.empty())
+		{
+			if (getPoster(video_path, false, thumbnail_path) && thumbnail_path.empty())
+				mPosterVideo = video_path;
+		}
+
+		mPrefetcher.onShown(thumbnail_path);
+		mPrefetcher.onShown(marquee_path);
 		mVideo->setImage(thumbnail_path);
 		mMarquee.setImage(marquee_path);
 		mImage.setImage(thumbnail_path);
@@ -341,6 +350,37 @@ void VideoGameListView::updateInfoPanel()
 			comp->setAnimation(new LambdaAnimation(func, 150), 0, nullptr, fadingOut);
 		}
 	}
+
+	prefetchMedia();
+
+	// Pre-roll the videos the cursor most likely moves to next, in the direction it last moved
+	if(file != NULL && mList.size() > 1)
+	{
+		const int size = mList.size();
+		const int cursor = mList.getSelectedIndex();
+		std::vector<std::string> videos;
+		videos.push_back(expandHomePath(mList.getObjectAt((((cursor + mPrefetchStep) % size) + size) % size)->getVideoPath()));
+		videos.push_back(expandHomePath(mList.getObjectAt((((cursor - mPrefetchStep) % size) + size) % size)->getVideoPath()));
+		mVideo->prerollVideos(videos);
+	}
+}
+
+std::vector<std::string> VideoGameListView::getMediaPaths(FileData* file) const
+{
+	std::vector<std::string> paths;
+	std::string thumbnail_path = expandHomePath(file->getThumbnailPath());
+	// extracts the poster ahead of the cursor if the game has no thumbnail
+	if (thumbnail_path.empty())
+		getPoster(expandHomePath(file->getVideoPath()), true, thumbnail_path);
+	paths.push_back(thumbnail_path);
+	paths.push_back(expandHomePath(file->getMarqueePath()));
+	return paths;
+}
+
+bool VideoGameListView::getPoster(const std::string& videoPath, bool prefetch, std::string& poster) const
+{
+	libvlc_instance_t* vlcInstance = m_context ? m_context->GetVlcInstance() : nullptr;
+	return VideoPosterCache::getInstance()->getPoster(vlcInstance, videoPath, poster, prefetch);
 }
 
 void VideoGameListView::launch(FileData* game)
@@ -383,6 +423,23 @@ std::vector<GuiComponent*> VideoGameListView::getMDValues()
 void VideoGameListView::update(int deltaTime)
 {
 	BasicGameListView::update(deltaTime);
+
+	// The poster of the selected game became available, or won't ever
+	if (!mPosterVideo.empty())
+	{
+		std::string poster;
+		if (!getPoster(mPosterVideo, false, poster))
+		{
+			mPosterVideo.clear();
+		}
+		else if (!poster.empty())
+		{
+			mVideo->setImage(poster);
+			mImage.setImage(poster);
+			mPosterVideo.clear();
+		}
+	}
+
 	mVideo->update(deltaTime);
 }
 
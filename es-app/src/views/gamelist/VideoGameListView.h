@@ -23,10 +23,14 @@ public:
 
 protected:
 	virtual void update(int deltaTime) override;
+	virtual std::vector<std::string> getMediaPaths(FileData* file) const override;
 
 private:
 	void initialize();
-	void updateInfoPanel();
+	void updateInfoPanel() override;
+	// The extracted frame shown for a video without a thumbnail, empty until it is ready. False if
+	// the video won't get one.
+	bool getPoster(const std::string& videoPath, bool prefetch, std::string& poster) const;
 
 	void initMDLabels();
 	void initMDValues();
@@ -53,5 +57,6 @@ private:
 	TextComponent mDescription;
 
 	bool		mVideoPlaying;
+	std::string	mPosterVideo; // video of the selected game while its poster is extracted
 
 };
@@ -0,0 +1,139 @@
+#include "FrameScheduler.h"
+#include "Log.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	// share of the refresh interval, from the start of the frame, that deferred work may use
+	const float k_deferredBudget = 0.5f;
+	// when the display doesn't report its refresh rate
+	const long long k_defaultIntervalUs = 1000000 / 60;
+	// a frame within a quarter interval of a whole number of intervals is taken to be vsynced
+	const long long k_snapTolerance = 4;
+	// weight of a vsynced frame in the estimate of the refresh interval
+	const double k_intervalSmoothing = 1.0 / 64;
+	// how far the estimate may stray from the reported rate, which is rounded to whole Hz
+	const double k_maxIntervalError = 0.02;
+	// the difference between the clock and the animations is made up over about this many frames
+	const long long k_driftFrames = 16;
+}
+
+FrameScheduler* FrameScheduler::sInstance = nullptr;
+
+FrameScheduler* FrameScheduler::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new FrameScheduler();
+	return sInstance;
+}
+
+FrameScheduler::FrameScheduler() : mFrameStart(Clock::now()), mReportedIntervalUs(0), mIntervalUs(0), mDriftUs(0), mCarryUs(0),
+	mDeferredThisFrame(false), mPostponedThisFrame(0),
+	mFrames(0), mTotalMs(0), mTotalSquaredMs(0), mMaxMs(0), mDeferred(0), mPostponed(0)
+{
+	SDL_DisplayMode mode;
+	if (SDL_GetCurrentDisplayMode(0, &mode) == 0 && mode.refresh_rate > 0)
+	{
+		mReportedIntervalUs = 1000000 / mode.refresh_rate;
+		mIntervalUs = (double)mReportedIntervalUs;
+		LOG(LogInfo) << "Pacing frames to a " << mode.refresh_rate << "Hz display";
+	}
+	else
+	{
+		LOG(LogInfo) << "Display refresh rate unknown, animations follow the clock";
+	}
+}
+
+int FrameScheduler::beginFrame(bool idle)
+{
+	const Clock::time_point now = Clock::now();
+	const long long elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - mFrameStart).count();
+	mFrameStart = now;
+	mDeferredThisFrame = false;
+	mPostponedThisFrame = 0;
+
+	if (idle)
+	{
+		mDriftUs = 0;
+		mCarryUs = 0;
+		return (int)(elapsedUs / 1000);
+	}
+
+	const float elapsedMs = elapsedUs / 1000.0f;
+	mFrames++;
+	mTotalMs += elapsedMs;
+	mTotalSquaredMs += elapsedMs * elapsedMs;
+	mMaxMs = std::max(mMaxMs, elapsedMs);
+
+	// Under vsync a frame is shown a whole number of refresh intervals after the previous one,
+	// wherever in the interval the loop got to it. Animations advance by that. The interval is
+	// averaged from the vsynced frames, the reported rate is only whole Hz (59.94Hz shows as 59
+	// or 60). What still differs from the clock is made up a small share every frame.
+	long long stepUs = elapsedUs;
+	if (mIntervalUs > 0)
+	{
+		const long long intervals = std::llround(elapsedUs / mIntervalUs);
+		if (intervals > 0 && std::fabs(elapsedUs - intervals * mIntervalUs) < mIntervalUs / k_snapTolerance)
+		{
+			const double maxError = mReportedIntervalUs * k_maxIntervalError;
+			mIntervalUs += ((double)elapsedUs / intervals - mIntervalUs) * k_intervalSmoothing;
+			mIntervalUs = std::max(std::min(mIntervalUs, mReportedIntervalUs + maxError), mReportedIntervalUs - maxError);
+			stepUs = std::llround(intervals * mIntervalUs);
+		}
+
+		mDriftUs += elapsedUs - stepUs;
+		const long long correction = std::max(mDriftUs / k_driftFrames, -stepUs);
+		stepUs += correction;
+		mDriftUs -= correction;
+	}
+
+	// animations count whole ms, the rest goes to the next frame
+	mCarryUs += stepUs;
+	const long long stepMs = mCarryUs / 1000;
+	mCarryUs -= stepMs * 1000;
+	return (int)stepMs;
+}
+
+void FrameScheduler::reset()
+{
+	mFrameStart = Clock::now();
+	mDriftUs = 0;
+	mCarryUs = 0;
+}
+
+bool FrameScheduler::runDeferred()
+{
+	const long long budgetUs = (long long)((mIntervalUs > 0 ? mIntervalUs : k_defaultIntervalUs) * k_deferredBudget);
+	if (mDeferredThisFrame && std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - mFrameStart).count() > budgetUs)
+	{
+		mPostponedThisFrame++;
+		mPostponed++;
+		return false;
+	}
+
+	mDeferredThisFrame = true;
+	mDeferred++;
+	return true;
+}
+
+FrameScheduler::Stats FrameScheduler::takeStats()
+{
+	Stats stats = { mFrames, 0, 0, mMaxMs, mDeferred, mPostponed };
+	if (mFrames > 0)
+	{
+		const double average = mTotalMs / mFrames;
+		stats.averageMs = (float)average;
+		stats.deviationMs = (float)std::sqrt(std::max(mTotalSquaredMs / mFrames - average * average, 0.0));
+	}
+
+	mFrames = 0;
+	mTotalMs = 0;
+	mTotalSquaredMs = 0;
+	mMaxMs = 0;
+	mDeferred = 0;
+	mPostponed = 0;
+	return stats;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+
+// Paces the main loop. Frame times come from a high resolution clock, and animations advance by
+// whole display refresh intervals while the frame rate follows the display, so a frame that swaps
+// a little early or late doesn't make scrolling judder. Work that can wait for a later frame
+// (texture uploads, text caches) asks runDeferred() first and only runs while the frame is within
+// its budget.
+class FrameScheduler
+{
+public:
+	struct Stats
+	{
+		unsigned int	frames;
+		float			averageMs;	// between the starts of two frames, idle waits left out
+		float			deviationMs;
+		float			maxMs;
+		unsigned int	deferred;	// deferred work that ran
+		unsigned int	postponed;	// deferred work pushed to a later frame
+	};
+
+	static FrameScheduler* getInstance();
+
+	// Starts a frame and returns the time in ms to advance animations by. After an idle wait the
+	// whole wait is returned, timers like the screensaver's have to see it.
+	int beginFrame(bool idle);
+	// Forgets the time since the last frame, e.g. after sleeping
+	void reset();
+
+	// True if a piece of deferred work may run now. The first one in a frame always does, so
+	// everything gets done eventually.
+	bool runDeferred();
+	// True if the last frame pushed work to a later one, the loop shouldn't wait for input then
+	bool hasPostponed() const { return mPostponedThisFrame > 0; }
+
+	// Frame times since the last call, for the framerate overlay
+	Stats takeStats();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	FrameScheduler();
+
+	static FrameScheduler* sInstance;
+
+	Clock::time_point	mFrameStart;
+	long long			mReportedIntervalUs;	// from the display mode, 0 if unknown
+	double				mIntervalUs;	// measured refresh interval, 0 if unknown
+	long long			mDriftUs;		// real time minus the time given to animations
+	long long			mCarryUs;		// animation time not handed out yet, under 1ms
+	bool				mDeferredThisFrame;
+	unsigned int		mPostponedThisFrame;
+
+	unsigned int		mFrames;
+	double				mTotalMs;
+	double				mTotalSquaredMs;
+	float				mMaxMs;
+	unsigned int		mDeferred;
+	unsigned int		mPostponed;
+};
@@ -4,6 +4,11 @@
 #include "Renderer.h"
 #include "animations/AnimationController.h"
 #include "ThemeData.h"
+#include "RenderLayerCache.h"
+#include <algorithm>
+#include <float.h>
+
+unsigned int GuiComponent::sCulledCount = 0;
 
 GuiComponent::GuiComponent(Window* window) : mWindow(window), mParent(NULL), mOpacity(255),
 	mPosition(Eigen::Vector3f::Zero()), mSize(Eigen::Vector2f::Zero()), mTransform(Eigen::Affine3f::Identity()),
@@ -22,6 +27,45 @@ GuiComponent::GuiComponent(gui::Context& context)
 		mAnimationMap[ i ] = NULL;
 }
 
+GuiComponent::GuiComponent(const GuiComponent& other) : IFocusable(other), mOpacity(other.mOpacity), mWindow(other.mWindow),
+	mParent(other.mParent), mChildren(other.mChildren), mPosition(other.mPosition), mSize(other.mSize),
+	mDefaultZIndex(other.mDefaultZIndex), mZIndex(other.mZIndex), mIsProcessing(other.mIsProcessing),
+	mEnabled(other.mEnabled), mVisible(other.mVisible), mIsPersistent(other.mIsPersistent), mStatic(other.mStatic),
+	m_context(other.m_context), mTransform(other.mTransform), mBackButton(other.mBackButton)
+{
+	for(unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+		mAnimationMap[i] = other.mAnimationMap[i];
+}
+
+GuiComponent& GuiComponent::operator=(const GuiComponent& other)
+{
+	if(this == &other)
+		return *this;
+
+	IFocusable::operator=(other);
+	mOpacity = other.mOpacity;
+	mWindow = other.mWindow;
+	mParent = other.mParent;
+	mChildren = other.mChildren;
+	mPosition = other.mPosition;
+	mSize = other.mSize;
+	mDefaultZIndex = other.mDefaultZIndex;
+	mZIndex = other.mZIndex;
+	mIsProcessing = other.mIsProcessing;
+	mEnabled = other.mEnabled;
+	mVisible = other.mVisible;
+	mIsPersistent = other.mIsPersistent;
+	mStatic = other.mStatic;
+	mLayerCache.reset();
+	mBoundsValid = false;
+	m_context = other.m_context;
+	mTransform = other.mTransform;
+	for(unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+		mAnimationMap[i] = other.mAnimationMap[i];
+	mBackButton = other.mBackButton;
+	return *this;
+}
+
 GuiComponent::~GuiComponent()
 {
 	mWindow->removeGui(this);
@@ -91,8 +135,130 @@ void GuiComponent::renderChildren(const Eigen::Affine3f& transform) const
 {
 	for(unsigned int i = 0; i < getChildCount(); i++)
 	{
-		getChild(i)->render(transform);
+		if(!isCulled(getChild(i), transform))
+			getChild(i)->render(transform);
+	}
+}
+
+void GuiComponent::renderChildrenCached(const Eigen::Affine3f& transform, const Eigen::Vector4i& layerRect)
+{
+	unsigned int layerEnd = 0;
+	bool changing = false;
+	while(layerEnd < getChildCount() && getChild(layerEnd)->isStatic())
+	{
+		changing = changing || getChild(layerEnd)->getRedrawDelay() == 0;
+		layerEnd++;
+	}
+
+	if(layerEnd > 0)
+	{
+		if(!mLayerCache)
+			mLayerCache.reset(new RenderLayerCache());
+
+		mLayerCache->render(layerRect, changing, [this, &transform, layerEnd]
+		{
+			for(unsigned int i = 0; i < layerEnd; i++)
+			{
+				if(!isCulled(getChild(i), transform))
+					getChild(i)->render(transform);
+			}
+		});
+	}
+
+	for(unsigned int i = layerEnd; i < getChildCount(); i++)
+	{
+		if(!isCulled(getChild(i), transform))
+			getChild(i)->render(transform);
+	}
+}
+
+bool GuiComponent::isCulled(const GuiComponent* component, const Eigen::Affine3f& parentTrans)
+{
+	if(component->getOpacity() == 0)
+	{
+		sCulledCount++;
+		return true;
+	}
+
+	// nothing to test against if it can draw anywhere, or has no area
+	const Eigen::Vector4f& bounds = component->getSubtreeBounds();
+	if(bounds[0] <= -FLT_MAX || bounds[1] <= -FLT_MAX || bounds[2] >= FLT_MAX || bounds[3] >= FLT_MAX ||
+	   bounds[0] >= bounds[2] || bounds[1] >= bounds[3])
+		return false;
+
+	Eigen::Vector4f screenBounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for(int corner = 0; corner < 4; corner++)
+	{
+		const Eigen::Vector3f point = parentTrans * Eigen::Vector3f(bounds[(corner & 1) ? 2 : 0], bounds[(corner & 2) ? 3 : 1], 0);
+		screenBounds[0] = std::min(screenBounds[0], point.x());
+		screenBounds[1] = std::min(screenBounds[1], point.y());
+		screenBounds[2] = std::max(screenBounds[2], point.x());
+		screenBounds[3] = std::max(screenBounds[3], point.y());
+	}
+
+	if(Renderer::isVisible(screenBounds))
+		return false;
+
+	sCulledCount++;
+	return true;
+}
+
+Eigen::Vector4f GuiComponent::getDrawBounds() const
+{
+	return Eigen::Vector4f(0, 0, mSize.x(), mSize.y());
+}
+
+Eigen::Vector4f GuiComponent::getUnboundedArea()
+{
+	return Eigen::Vector4f(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+}
+
+Eigen::Vector4f GuiComponent::boundsUnion(const Eigen::Vector4f& a, const Eigen::Vector4f& b)
+{
+	return Eigen::Vector4f(std::min(a[0], b[0]), std::min(a[1], b[1]), std::max(a[2], b[2]), std::max(a[3], b[3]));
+}
+
+const Eigen::Vector4f& GuiComponent::getSubtreeBounds() const
+{
+	if(mBoundsValid)
+		return mSubtreeBounds;
+
+	// a zero sized component draws nothing itself
+	Eigen::Vector4f bounds = getDrawBounds();
+	if(bounds[0] >= bounds[2] || bounds[1] >= bounds[3])
+		bounds << FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX;
+
+	if(!clipsChildren())
+	{
+		for(unsigned int i = 0; i < getChildCount(); i++)
+			bounds = boundsUnion(bounds, getChild(i)->getSubtreeBounds());
 	}
+
+	// into the parent's coordinates, what can draw anywhere stays unbounded
+	for(int i = 0; i < 4; i++)
+	{
+		const float offset = mPosition[i % 2];
+		if(bounds[i] > -FLT_MAX && bounds[i] < FLT_MAX)
+			bounds[i] += offset;
+	}
+
+	mSubtreeBounds = bounds;
+	mBoundsValid = true;
+	return mSubtreeBounds;
+}
+
+void GuiComponent::invalidateBounds()
+{
+	// the bounds of the parents include these, and are only valid while these are
+	for(GuiComponent* cmp = this; cmp != NULL && cmp->mBoundsValid; cmp = cmp->mParent)
+		cmp->mBoundsValid = false;
+}
+
+unsigned int GuiComponent::takeCulledCount()
+{
+	const unsigned int count = sCulledCount;
+	sCulledCount = 0;
+	return count;
 }
 
 Eigen::Vector3f GuiComponent::getPosition() const
@@ -103,12 +269,14 @@ Eigen::Vector3f GuiComponent::getPosition() const
 void GuiComponent::setPosition(const Eigen::Vector3f& offset)
 {
 	mPosition = offset;
+	invalidateBounds();
 	onPositionChanged();
 }
 
 void GuiComponent::setPosition(float x, float y, float z)
 {
 	mPosition << x, y, z;
+	invalidateBounds();
 	onPositionChanged();
 }
 
@@ -120,12 +288,14 @@ Eigen::Vector2f GuiComponent::getSize() const
 void GuiComponent::setSize(const Eigen::Vector2f& size)
 {
     mSize = size;
+    invalidateBounds();
     onSizeChanged();
 }
 
 void GuiComponent::setSize(float w, float h)
 {
 	mSize << w, h;
+    invalidateBounds();
     onSizeChanged();
 }
 
@@ -158,6 +328,7 @@ void GuiComponent::addChild(GuiComponent* cmp)
 		cmp->getParent()->removeChild(cmp);
 
 	cmp->setParent(this);
+	invalidateBounds();
 }
 
 void GuiComponent::removeChild(GuiComponent* cmp)
@@ -177,6 +348,7 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 		if(*i == cmp)
 		{
 			mChildren.erase(i);
+			invalidateBounds();
 			return;
 		}
 	}
@@ -185,6 +357,7 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 void GuiComponent::clearChildren()
 {
 	mChildren.clear();
+	invalidateBounds();
 }
 
 void GuiComponent::sortChildren()
@@ -406,6 +579,39 @@ bool GuiComponent::isProcessing() const
 	return mIsProcessing;
 }
 
+bool GuiComponent::isAnimating() const
+{
+	for(unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+	{
+		if(mAnimationMap[i] != NULL)
+			return true;
+	}
+	return false;
+}
+
+int GuiComponent::getRedrawDelay() const
+{
+	if(isAnimating())
+		return 0;
+
+	int delay = -1;
+	for(auto it = mChildren.begin(); it != mChildren.end() && delay != 0; it++)
+	{
+		if((*it)->isVisible())
+			delay = earliestRedraw(delay, (*it)->getRedrawDelay());
+	}
+	return delay;
+}
+
+int GuiComponent::earliestRedraw(int a, int b)
+{
+	if(a < 0)
+		return b;
+	if(b < 0)
+		return a;
+	return std::min(a, b);
+}
+
 void GuiComponent::setEnabled(bool enabled)
 {
 	if (mEnabled != enabled)
@@ -12,6 +12,7 @@ class Animation;
 class AnimationController;
 class ThemeData;
 class Font;
+class RenderLayerCache;
 
 typedef std::pair<std::string, std::string> HelpPrompt;
 
@@ -20,6 +21,9 @@ class GuiComponent : public IFocusable
 public:
 	GuiComponent(gui::Context& context);
 	GuiComponent(Window* window);
+	// A copy starts without a cached layer, it draws somewhere else
+	GuiComponent(const GuiComponent& other);
+	GuiComponent& operator=(const GuiComponent& other);
 	virtual ~GuiComponent();
 
 	virtual void textInput(const char* text);
@@ -110,6 +114,17 @@ public:
 	// Returns true if the component is busy doing background processing (e.g. HTTP downloads)
 	bool isProcessing() const;
 
+	// Returns true if one of the animation slots is playing
+	bool isAnimating() const;
+
+	// Milliseconds until the component changes on its own: 0 while it is animating or dirty, -1 if
+	// nothing changes until there is input. Lets the main loop stop drawing identical frames.
+	// Default implementation checks the animations and the visible children.
+	virtual int getRedrawDelay() const;
+
+	// The earlier of two redraw delays
+	static int earliestRedraw(int a, int b);
+
 	void SetBackButton(const std::string& buttonName);
 
 	void setEnabled(bool enabled);
@@ -119,6 +134,28 @@ public:
 	bool isVisible() const { return mVisible; }
 	bool isPersistent() const { return mIsPersistent; }
 
+	// Static components rarely change, so parents that render with renderChildrenCached() can draw
+	// them from a cached layer
+	void setStatic(bool isStatic) { mStatic = isStatic; }
+	bool isStatic() const { return mStatic; }
+
+	// Area the component draws in, in its own coordinates (min x, min y, max x, max y). Defaults to
+	// its size; components that draw outside of it override this, with getUnboundedArea() if it
+	// can't be known up front.
+	virtual Eigen::Vector4f getDrawBounds() const;
+	// True if the children are clipped to the draw bounds (scrolling containers, lists), so they
+	// don't add to them
+	virtual bool clipsChildren() const { return false; }
+	// Draw bounds of the component and everything below it, in the parent's coordinates. Cached
+	// until the position, size or children of one of them change.
+	const Eigen::Vector4f& getSubtreeBounds() const;
+
+	static Eigen::Vector4f getUnboundedArea();
+	static Eigen::Vector4f boundsUnion(const Eigen::Vector4f& a, const Eigen::Vector4f& b);
+
+	// Number of components skipped by the renderChildren functions since the last call
+	static unsigned int takeCulledCount();
+
 
 public: //INavigation
 	bool UpdateFocus(FocusPosition position, bool enableFocus) override;
@@ -128,6 +165,16 @@ protected:
 	virtual void OnVisibleChanged(bool oldValue, bool newValue) { }
 
 	void renderChildren(const Eigen::Affine3f& transform) const;
+	// Like renderChildren, but the static children before the first non static one are drawn as one
+	// cached layer covering layerRect (x, y, w, h on screen). Only for the bottom of a view, the
+	// layer replaces what is behind it (see RenderLayerCache).
+	void renderChildrenCached(const Eigen::Affine3f& transform, const Eigen::Vector4i& layerRect);
+	// True if the component would draw nothing: fully transparent, or outside the clip rect (or the
+	// screen) when drawn with parentTrans. Counted as culled.
+	static bool isCulled(const GuiComponent* component, const Eigen::Affine3f& parentTrans);
+	// Forgets the cached bounds of this component and its parents, for changes that don't go through
+	// setPosition/setSize (e.g. a component sizing itself to its content)
+	void invalidateBounds();
 	void updateSelf(int deltaTime); // updates animations
 	void updateChildren(int deltaTime); // updates animations
 
@@ -148,6 +195,10 @@ protected:
 	bool mEnabled;
 	bool mVisible;
 	bool mIsPersistent; //Persistent Gui shouldn't be closed
+	bool mStatic = false;
+	std::unique_ptr<RenderLayerCache> mLayerCache;
+	mutable Eigen::Vector4f mSubtreeBounds;
+	mutable bool mBoundsValid = false;
 
 	gui::Context* m_context;
 
@@ -157,6 +208,7 @@ public:
 private:
 	Eigen::Affine3f mTransform; //Don't access this directly! Use getTransform()!
 	AnimationController* mAnimationMap[MAX_ANIMATIONS];
+	static unsigned int sCulledCount;
 	std::string mBackButton;
 
 
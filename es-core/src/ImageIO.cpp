@@ -4,8 +4,189 @@
 
 #include "Log.h"
 
+#ifdef HAVE_LIBJPEG
+#include <stdio.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+#endif
+#ifdef HAVE_LIBPNG
+#include <png.h>
+#endif
 
-std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height)
+namespace
+{
+	bool isJPEG(const unsigned char * data, const size_t size)
+	{
+		return size > 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+	}
+
+	bool isPNG(const unsigned char * data, const size_t size)
+	{
+		static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		return size > 8 && memcmp(data, signature, 8) == 0;
+	}
+
+#ifdef HAVE_LIBJPEG
+	struct JPEGErrorManager
+	{
+		jpeg_error_mgr pub;
+		jmp_buf setjmpBuffer;
+	};
+
+	void onJPEGError(j_common_ptr cinfo)
+	{
+		char message[JMSG_LENGTH_MAX];
+		(*cinfo->err->format_message)(cinfo, message);
+		LOG(LogError) << "Error - libjpeg: " << message;
+		longjmp(((JPEGErrorManager*)cinfo->err)->setjmpBuffer, 1);
+	}
+
+	void onJPEGMessage(j_common_ptr cinfo)
+	{
+		char message[JMSG_LENGTH_MAX];
+		(*cinfo->err->format_message)(cinfo, message);
+		LOG(LogWarning) << "libjpeg: " << message;
+	}
+#endif
+}
+
+std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height,
+	const size_t maxWidth, const size_t maxHeight, size_t* sourceWidth, size_t* sourceHeight)
+{
+	std::vector<unsigned char> rawData;
+	size_t fullWidth = 0;
+	size_t fullHeight = 0;
+	width = 0;
+	height = 0;
+	bool decoded = false;
+	if (isJPEG(data, size))
+		decoded = loadJPEG(data, size, width, height, maxWidth, maxHeight, fullWidth, fullHeight, rawData);
+	else if (isPNG(data, size))
+		decoded = loadPNG(data, size, width, height, rawData);
+
+	if (!decoded)
+		rawData = loadFromMemoryRGBA32FreeImage(data, size, width, height);
+	if (fullWidth == 0 || fullHeight == 0)
+	{
+		fullWidth = width;
+		fullHeight = height;
+	}
+
+	if (sourceWidth)
+		*sourceWidth = fullWidth;
+	if (sourceHeight)
+		*sourceHeight = fullHeight;
+	return rawData;
+}
+
+bool ImageIO::loadJPEG(const unsigned char * data, const size_t size, size_t & width, size_t & height,
+	const size_t maxWidth, const size_t maxHeight, size_t & sourceWidth, size_t & sourceHeight, std::vector<unsigned char>& rawData)
+{
+#ifdef HAVE_LIBJPEG
+	jpeg_decompress_struct cinfo;
+	JPEGErrorManager jerr;
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = onJPEGError;
+	jerr.pub.output_message = onJPEGMessage;
+	if (setjmp(jerr.setjmpBuffer))
+	{
+		jpeg_destroy_decompress(&cinfo);
+		rawData.clear();
+		width = 0;
+		height = 0;
+		return false;
+	}
+
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, (unsigned char*)data, size);
+	jpeg_read_header(&cinfo, TRUE);
+	sourceWidth = cinfo.image_width;
+	sourceHeight = cinfo.image_height;
+
+	// let the IDCT do the downscaling, but never go below the requested size
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = 1;
+	if (maxWidth > 0 && maxHeight > 0)
+	{
+		while (cinfo.scale_denom < 8 &&
+			cinfo.image_width / (cinfo.scale_denom * 2) >= maxWidth &&
+			cinfo.image_height / (cinfo.scale_denom * 2) >= maxHeight)
+		{
+			cinfo.scale_denom *= 2;
+		}
+	}
+	cinfo.dct_method = JDCT_IFAST;
+#ifdef JCS_EXTENSIONS
+	cinfo.out_color_space = JCS_EXT_RGBA;
+#else
+	cinfo.out_color_space = JCS_RGB;
+#endif
+	jpeg_start_decompress(&cinfo);
+
+	width = cinfo.output_width;
+	height = cinfo.output_height;
+	rawData.resize(width * height * 4);
+
+	// textures are stored bottom-up, so fill the buffer from the last row
+	while (cinfo.output_scanline < cinfo.output_height)
+	{
+		unsigned char* row = rawData.data() + (height - 1 - cinfo.output_scanline) * width * 4;
+		jpeg_read_scanlines(&cinfo, &row, 1);
+#ifndef JCS_EXTENSIONS
+		// expand RGB to RGBA in place, back to front so we don't overwrite unread pixels
+		for (size_t x = width; x-- > 0;)
+		{
+			row[x * 4 + 3] = 0xFF;
+			row[x * 4 + 2] = row[x * 3 + 2];
+			row[x * 4 + 1] = row[x * 3 + 1];
+			row[x * 4 + 0] = row[x * 3 + 0];
+		}
+#endif
+	}
+
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool ImageIO::loadPNG(const unsigned char * data, const size_t size, size_t & width, size_t & height, std::vector<unsigned char>& rawData)
+{
+#ifdef HAVE_LIBPNG
+	png_image image;
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_memory(&image, data, size))
+	{
+		LOG(LogError) << "Error - libpng: " << image.message;
+		return false;
+	}
+
+	image.format = PNG_FORMAT_RGBA;
+	rawData.resize(PNG_IMAGE_SIZE(image));
+
+	// a negative row stride makes libpng write the rows bottom-up
+	const png_int_32 rowStride = -(png_int_32)PNG_IMAGE_ROW_STRIDE(image);
+	if (!png_image_finish_read(&image, nullptr, rawData.data(), rowStride, nullptr))
+	{
+		LOG(LogError) << "Error - libpng: " << image.message;
+		png_image_free(&image);
+		rawData.clear();
+		return false;
+	}
+
+	width = image.width;
+	height = image.height;
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32FreeImage(const unsigned char * data, const size_t size, size_t & width, size_t & height)
 {
 	std::vector<unsigned char> rawData;
 	width = 0;
@@ -77,6 +258,33 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * d
 	return rawData;
 }
 
+bool ImageIO::saveRGBA32PNG(const std::string& path, const unsigned char * data, const size_t width, const size_t height)
+{
+	FIBITMAP * fiBitmap = FreeImage_Allocate(width, height, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+	if (fiBitmap == nullptr)
+		return false;
+
+	//FreeImage scanlines are bottom-up too, but BGRA
+	for (size_t y = 0; y < height; y++)
+	{
+		const unsigned char * src = data + (y * width * 4);
+		RGBQUAD * scanLine = (RGBQUAD *)FreeImage_GetScanLine(fiBitmap, y);
+		for (size_t x = 0; x < width; x++)
+		{
+			scanLine[x].rgbRed = src[x * 4 + 0];
+			scanLine[x].rgbGreen = src[x * 4 + 1];
+			scanLine[x].rgbBlue = src[x * 4 + 2];
+			scanLine[x].rgbReserved = src[x * 4 + 3];
+		}
+	}
+
+	const bool saved = FreeImage_Save(FIF_PNG, fiBitmap, path.c_str()) != 0;
+	if (!saved)
+		LOG(LogError) << "Error - Failed to save image to " << path;
+	FreeImage_Unload(fiBitmap);
+	return saved;
+}
+
 void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height)
 {
 	unsigned int temp;
@@ -91,3 +299,30 @@ void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const
 		}
 	}
 }
+
+void ImageIO::shrinkRGBA32(std::vector<unsigned char>& pixels, size_t& width, size_t& height, const size_t maxWidth, const size_t maxHeight)
+{
+	if (maxWidth == 0 || maxHeight == 0)
+		return;
+
+	while (width / 2 >= maxWidth && height / 2 >= maxHeight)
+	{
+		const size_t halfWidth = width / 2;
+		const size_t halfHeight = height / 2;
+		// in place, each destination pixel is behind the four it is averaged from
+		for (size_t y = 0; y < halfHeight; y++)
+		{
+			const unsigned char* row0 = &pixels[(y * 2) * width * 4];
+			const unsigned char* row1 = row0 + width * 4;
+			unsigned char* dest = &pixels[y * halfWidth * 4];
+			for (size_t x = 0; x < halfWidth; x++)
+			{
+				for (size_t c = 0; c < 4; c++)
+					dest[x * 4 + c] = (unsigned char)((row0[x * 8 + c] + row0[x * 8 + 4 + c] + row1[x * 8 + c] + row1[x * 8 + 4 + c] + 2) / 4);
+			}
+		}
+		width = halfWidth;
+		height = halfHeight;
+		pixels.resize(width * height * 4);
+	}
+}
@@ -1,11 +1,29 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <FreeImage.h>
 
 class ImageIO
 {
 public:
-	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height);
+	// Decodes JPEG and PNG data with libjpeg/libpng when available and falls back to FreeImage for
+	// everything else. Pixels are returned bottom-up, like FreeImage scanlines.
+	// If maxWidth/maxHeight are set, JPEGs may be decoded at 1/2, 1/4 or 1/8 scale as long as the
+	// result stays at least that big. width and height report the decoded size, sourceWidth and
+	// sourceHeight (if given) the size stored in the file.
+	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height,
+		const size_t maxWidth = 0, const size_t maxHeight = 0, size_t* sourceWidth = nullptr, size_t* sourceHeight = nullptr);
+	static std::vector<unsigned char> loadFromMemoryRGBA32FreeImage(const unsigned char * data, const size_t size, size_t & width, size_t & height);
 	static void flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height);
-};
\ No newline at end of file
+	// Halves RGBA pixels with a box filter for as long as the result stays at least maxWidth x maxHeight,
+	// so images in formats without a scaled decode end up about as small as a scaled JPEG would.
+	static void shrinkRGBA32(std::vector<unsigned char>& pixels, size_t& width, size_t& height, const size_t maxWidth, const size_t maxHeight);
+	// Writes bottom-up RGBA pixels (as returned by the loaders or glReadPixels) to a PNG file
+	static bool saveRGBA32PNG(const std::string& path, const unsigned char * data, const size_t width, const size_t height);
+
+private:
+	static bool loadJPEG(const unsigned char * data, const size_t size, size_t & width, size_t & height,
+		const size_t maxWidth, const size_t maxHeight, size_t & sourceWidth, size_t & sourceHeight, std::vector<unsigned char>& rawData);
+	static bool loadPNG(const unsigned char * data, const size_t size, size_t & width, size_t & height, std::vector<unsigned char>& rawData);
+};
@@ -0,0 +1,118 @@
+#include "RenderLayerCache.h"
+#include "Settings.h"
+#include <algorithm>
+
+RenderLayerCache::Stats RenderLayerCache::sStats = {};
+
+RenderLayerCache::RenderLayerCache() : mRect(0, 0, 0, 0), mValid(false), mHash(0), mCandidateHash(0), mCreateFailed(false)
+{
+}
+
+RenderLayerCache::~RenderLayerCache()
+{
+	release();
+}
+
+const RenderLayerCache::Stats& RenderLayerCache::getStats()
+{
+	return sStats;
+}
+
+void RenderLayerCache::release()
+{
+	if(mTarget.textureId)
+	{
+		sStats.vramBytes -= mTarget.rect[2] * mTarget.rect[3] * 4;
+		Renderer::deleteRenderTarget(mTarget);
+	}
+	mValid = false;
+}
+
+void RenderLayerCache::render(const Eigen::Vector4i& screenRect, bool changing, const std::function<void()>& draw)
+{
+	// only the part on screen is kept
+	const int screenWidth = (int)Renderer::getScreenWidth();
+	const int screenHeight = (int)Renderer::getScreenHeight();
+	const int left = std::max(screenRect[0], 0);
+	const int top = std::max(screenRect[1], 0);
+	const Eigen::Vector4i rect(left, top, std::min(screenRect[0] + screenRect[2], screenWidth) - left,
+		std::min(screenRect[1] + screenRect[3], screenHeight) - top);
+
+	const bool moved = rect != mRect;
+	mRect = rect;
+	if(changing || moved || mCreateFailed || rect[2] <= 0 || rect[3] <= 0 ||
+	   !Settings::getInstance()->getBool("LayerCache") || !Renderer::supportsRenderTargets())
+	{
+		mValid = false;
+		sStats.direct++;
+		draw();
+		return;
+	}
+
+	Renderer::beginCapture();
+	draw();
+	size_t hash;
+	if(!Renderer::endCapture(hash))
+	{
+		// part of it already reached the screen
+		mValid = false;
+		sStats.direct++;
+		return;
+	}
+
+	if(mValid && hash == mHash && Renderer::isRenderTargetValid(mTarget))
+	{
+		Renderer::discardQueued();
+		sStats.hits++;
+	}
+	else if(hash == mCandidateHash)
+	{
+		if(mTarget.rect != rect || !Renderer::isRenderTargetValid(mTarget))
+		{
+			release();
+			if(!Renderer::createRenderTarget(rect, mTarget))
+			{
+				// don't try again every frame, the queued draws go to the screen
+				mCreateFailed = true;
+				sStats.direct++;
+				return;
+			}
+			sStats.vramBytes += rect[2] * rect[3] * 4;
+		}
+
+		Renderer::flushToRenderTarget(mTarget);
+		mValid = true;
+		mHash = hash;
+		sStats.rebuilds++;
+	}
+	else
+	{
+		// changed since last frame, the queued draws go to the screen as usual
+		mValid = false;
+		mCandidateHash = hash;
+		sStats.direct++;
+		return;
+	}
+
+	const float x0 = (float)rect[0];
+	const float y0 = (float)rect[1];
+	const float x1 = (float)(rect[0] + rect[2]);
+	const float y1 = (float)(rect[1] + rect[3]);
+
+	// the texture is bottom-up
+	Renderer::Vertex vertices[6];
+	vertices[0].pos << x0, y0;	vertices[0].tex << 0, 1;
+	vertices[1].pos << x0, y1;	vertices[1].tex << 0, 0;
+	vertices[2].pos << x1, y0;	vertices[2].tex << 1, 1;
+	vertices[3] = vertices[2];
+	vertices[4] = vertices[1];
+	vertices[5].pos << x1, y1;	vertices[5].tex << 1, 0;
+
+	GLubyte colors[6 * 4];
+	Renderer::buildGLColorArray(colors, 0xFFFFFFFF, 6);
+
+	const Eigen::Affine3f matrix = Renderer::getMatrix();
+	Renderer::setMatrix(Eigen::Affine3f::Identity());
+	Renderer::drawTriangles(vertices, colors, 6, mTarget.textureId, GL_MODULATE, GL_ONE, GL_ZERO);
+	Renderer::setMatrix(matrix);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Renderer.h"
+#include <functional>
+
+// Keeps a layer that rarely changes (a view's background, theme extras, labels...) in an offscreen
+// texture, so it is drawn as one quad instead of element by element.
+// Every frame the layer is still queued and hashed, which is cheap next to drawing it: if it
+// matches the cached texture the draws are dropped. A layer is only rendered to the texture once it
+// has been the same for two frames, so anything that keeps changing costs nothing extra.
+// The quad replaces what is behind it, so a layer must be the bottom of what is drawn on its part of
+// the screen (it is rendered over black, like the screen is cleared).
+class RenderLayerCache
+{
+public:
+	struct Stats
+	{
+		unsigned int hits;		// frames drawn from the texture
+		unsigned int rebuilds;	// frames the texture was (re)rendered
+		unsigned int direct;	// frames drawn directly: changing, unsupported or disabled
+		size_t vramBytes;
+	};
+
+	RenderLayerCache();
+	~RenderLayerCache();
+
+	// Draws the layer covering rect (x, y, w, h on screen) through draw(). A changing layer (animating
+	// or moving) is drawn directly without being hashed.
+	void render(const Eigen::Vector4i& rect, bool changing, const std::function<void()>& draw);
+
+	static const Stats& getStats();
+
+private:
+	void release();
+
+	static Stats sStats;
+
+	Renderer::RenderTarget mTarget;
+	Eigen::Vector4i mRect;
+	bool mValid;			// mTarget holds the layer with mHash
+	size_t mHash;
+	size_t mCandidateHash;	// what was drawn directly last frame
+	bool mCreateFailed;
+};
@@ -31,9 +31,91 @@ namespace Renderer
 
 	void setMatrix(float* mat);
 	void setMatrix(const Eigen::Affine3f& transform);
+	const Eigen::Affine3f& getMatrix();
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
 	void drawRect(float x, float y, float w, float h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+
+	struct Vertex
+	{
+		Eigen::Vector2f pos;
+		Eigen::Vector2f tex;
+	};
+
+	//texEnv for textures that only hold coverage in their alpha channel (GL_ALPHA, e.g. font glyphs).
+	//Same as GL_MODULATE on the fixed function pipeline, shaders need to be told.
+	const GLenum TEXENV_ALPHA = GL_ALPHA;
+	//texEnv for distance field glyphs: the alpha channel is the distance to the outline, 0.5 on it.
+	//Only drawn right by the shader pipeline, see supportsDistanceFields().
+	const GLenum TEXENV_DISTANCE_FIELD = GL_LUMINANCE;
+
+	//queues triangles (count vertices, 4 color bytes per vertex) to be drawn with the current matrix and clip rect.
+	//draws are merged with earlier ones that use the same texture, blend mode and clip rect when
+	//nothing in between overlaps them, and reach GL on flush(). textureId 0 draws untextured.
+	//texEnv is GL_MODULATE, GL_DECAL or TEXENV_ALPHA.
+	void drawTriangles(const Vertex* vertices, const GLubyte* colors, unsigned int count, GLuint textureId, GLenum texEnv = GL_MODULATE,
+		GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+	//false if a screen space box (min x, min y, max x, max y) is entirely outside the clip rect or the screen
+	bool isVisible(const Eigen::Vector4f& bounds);
+	//draws count / 2 lines (4 color bytes per point) with the current matrix and clip rect, flushing first
+	void drawLines(const Eigen::Vector2f* points, const GLubyte* colors, unsigned int count);
+	//reads back what has been drawn this frame as bottom-up RGBA, flushing first
+	void readScreen(std::vector<unsigned char>& dataRGBA);
+	//draws everything queued. Must be called before drawing with GL directly; the clip rect (and on
+	//the fixed function pipeline, the current matrix) is loaded into GL afterwards.
+	void flush();
+
+	//true when drawing with shaders and a streaming vertex buffer rather than the fixed function
+	//pipeline, see the "ShaderRenderer" setting
+	bool usesShaders();
+	//true if TEXENV_DISTANCE_FIELD can be drawn (shaders with screen space derivatives)
+	bool supportsDistanceFields();
+
+	//while capturing, what gets queued can be hashed and then dropped instead of drawn, to tell
+	//whether a cached layer changed. beginCapture() flushes.
+	void beginCapture();
+	//returns false if something flushed since beginCapture(), the hash doesn't cover everything then
+	bool endCapture(size_t& hash);
+	void discardQueued();
+
+	//offscreen targets for caching layers that rarely change
+	struct RenderTarget
+	{
+		RenderTarget() : framebuffer(0), textureId(0), rect(0, 0, 0, 0), context(0) {}
+
+		GLuint framebuffer;
+		GLuint textureId;
+		Eigen::Vector4i rect; // x, y, w, h of the part of the screen it stands in for
+		unsigned int context;
+	};
+
+	//false if the context has no framebuffer objects (e.g. GLES 1 without OES_framebuffer_object)
+	bool supportsRenderTargets();
+	bool createRenderTarget(const Eigen::Vector4i& rect, RenderTarget& target);
+	//targets don't survive the context being recreated (e.g. around launching a game)
+	bool isRenderTargetValid(const RenderTarget& target);
+	void deleteRenderTarget(RenderTarget& target);
+	//draws everything queued into the target, as it would look on its part of a black screen, instead
+	//of onto the screen. The texture is bottom-up like the screen.
+	void flushToRenderTarget(const RenderTarget& target);
+
+	//all texture binds and deletes should go through these so redundant binds can be skipped
+	void bindTexture(GLuint textureId);
+	void deleteTexture(GLuint textureId);
+
+	struct FrameStats
+	{
+		unsigned int textureBinds; // glBindTexture calls that actually reached GL
+		unsigned int drawCalls;
+		unsigned int vertices;
+	};
+
+	//counters for the last completed frame
+	const FrameStats& getFrameStats();
+	//called by swapBuffers()
+	void endFrameStats();
+	//called by init() and deinit(), forgets what was cached about the previous context
+	void onContextChanged();
 }
 
 #endif
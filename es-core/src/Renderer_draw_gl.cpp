@@ -1,5 +1,6 @@
 #include "platform.h"
 #include "Renderer.h"
+#include "Renderer_pipeline.h"
 #include GLHEADER
 #include <iostream>
 #include "resources/Font.h"
@@ -7,9 +8,113 @@
 #include "Log.h"
 #include <stack>
 #include "Util.h"
+#include "Settings.h"
+#include <string.h>
+#include <float.h>
+#include <algorithm>
+#include <stdint.h>
+#include <SDL.h>
+#include <memory>
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_FRAMEBUFFER
+	#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_FRAMEBUFFER_BINDING
+	#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+	#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+	#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
 
 namespace Renderer {
 	std::stack<Eigen::Vector4i> clipStack;
+	Eigen::Affine3f currentMatrix = Eigen::Affine3f::Identity();
+
+	std::unique_ptr<Pipeline> pipeline;
+	bool shaderPipeline = false;
+
+	GLuint boundTexture = 0;
+	FrameStats currentStats = {};
+	FrameStats lastStats = {};
+
+	// how many batches back a draw may be merged into, if nothing drawn since overlaps it
+	const size_t k_maxBatchLookback = 16;
+
+	struct BatchState
+	{
+		GLuint texture;
+		GLenum texEnv;
+		GLenum sfactor;
+		GLenum dfactor;
+		bool clipped;
+		Eigen::Vector4i clip; // in glScissor coordinates
+
+		bool operator==(const BatchState& other) const
+		{
+			return texture == other.texture && texEnv == other.texEnv && sfactor == other.sfactor && dfactor == other.dfactor &&
+				clipped == other.clipped && (!clipped || clip == other.clip);
+		}
+	};
+
+	struct Batch
+	{
+		BatchState state;
+		Eigen::Vector4f bounds; // screen space min x, min y, max x, max y of everything in the batch
+		unsigned int first; // in sortedVertices, filled in by flush()
+		unsigned int count;
+	};
+
+	// a single drawTriangles() call, kept in order so batches can be laid out without reordering their contents
+	struct Submission
+	{
+		unsigned int batch;
+		unsigned int first; // in queuedVertices
+		unsigned int count;
+	};
+
+	std::vector<BatchVertex> queuedVertices;
+	std::vector<BatchVertex> sortedVertices;
+	std::vector<Submission> submissions;
+	std::vector<Batch> batches;
+	bool batchingEnabled = true;
+
+	bool capturing = false;
+	bool flushedWhileCapturing = false;
+
+	// framebuffer objects are core in GL 3.0 and GLES 2.0, extensions before that, so the entry points
+	// are looked up at runtime
+	typedef void (APIENTRY* GenFramebuffersProc)(GLsizei n, GLuint* framebuffers);
+	typedef void (APIENTRY* DeleteFramebuffersProc)(GLsizei n, const GLuint* framebuffers);
+	typedef void (APIENTRY* BindFramebufferProc)(GLenum target, GLuint framebuffer);
+	typedef void (APIENTRY* FramebufferTexture2DProc)(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+	typedef GLenum (APIENTRY* CheckFramebufferStatusProc)(GLenum target);
+
+	struct FramebufferFunctions
+	{
+		GenFramebuffersProc gen;
+		DeleteFramebuffersProc del;
+		BindFramebufferProc bind;
+		FramebufferTexture2DProc texture2D;
+		CheckFramebufferStatusProc checkStatus;
+	};
+
+	FramebufferFunctions fbo = {};
+	bool fboChecked = false;
+	unsigned int contextGeneration = 1;
+
+	// render target origin in GL window coordinates, scissor boxes are offset by it
+	Eigen::Vector2i targetOrigin(0, 0);
+
+	void applyScissor(const Eigen::Vector4i& box)
+	{
+		glScissor(box[0] - targetOrigin.x(), box[1] - targetOrigin.y(), box[2], box[3]);
+	}
 
 	void setColor4bArray(GLubyte* array, unsigned int color)
 	{
@@ -63,7 +168,7 @@ namespace Renderer {
 			box[3] = 0;
 
 		clipStack.push(box);
-		glScissor(box[0], box[1], box[2], box[3]);
+		applyScissor(box);
 		glEnable(GL_SCISSOR_TEST);
 	}
 
@@ -80,8 +185,7 @@ namespace Renderer {
 		{
 			glDisable(GL_SCISSOR_TEST);
 		}else{
-			Eigen::Vector4i top = clipStack.top();
-			glScissor(top[0], top[1], top[2], top[3]);
+			applyScissor(clipStack.top());
 		}
 	}
 
@@ -92,49 +196,480 @@ namespace Renderer {
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor, GLenum blend_dfactor)
 	{
-#ifdef USE_OPENGL_ES
-		GLshort points[12];
-#else
-		GLint points[12];
-#endif
+		Vertex vertices[6];
+		vertices[0].pos << (float)x, (float)y;
+		vertices[1].pos << (float)x, (float)(y + h);
+		vertices[2].pos << (float)(x + w), (float)y;
 
-		points[0] = x; points [1] = y;
-		points[2] = x; points[3] = y + h;
-		points[4] = x + w; points[5] = y;
+		vertices[3].pos << (float)(x + w), (float)y;
+		vertices[4].pos << (float)x, (float)(y + h);
+		vertices[5].pos << (float)(x + w), (float)(y + h);
 
-		points[6] = x + w; points[7] = y;
-		points[8] = x; points[9] = y + h;
-		points[10] = x + w; points[11] = y + h;
+		for(int i = 0; i < 6; i++)
+			vertices[i].tex << 0, 0;
 
 		GLubyte colors[6*4];
 		buildGLColorArray(colors, color, 6);
 
+		drawTriangles(vertices, colors, 6, 0, GL_MODULATE, blend_sfactor, blend_dfactor);
+	}
+
+	static bool overlaps(const Eigen::Vector4f& a, const Eigen::Vector4f& b)
+	{
+		return a[0] < b[2] && b[0] < a[2] && a[1] < b[3] && b[1] < a[3];
+	}
+
+	bool isVisible(const Eigen::Vector4f& bounds)
+	{
+		Eigen::Vector4f visible(0, 0, (float)getScreenWidth(), (float)getScreenHeight());
+		if(!clipStack.empty())
+		{
+			const Eigen::Vector4i& clip = clipStack.top();
+			const float top = (float)(getScreenHeight() - clip[1] - clip[3]);
+			visible << (float)clip[0], top, (float)(clip[0] + clip[2]), top + clip[3];
+		}
+		return overlaps(bounds, visible);
+	}
+
+	void drawTriangles(const Vertex* vertices, const GLubyte* colors, unsigned int count, GLuint textureId, GLenum texEnv, GLenum blend_sfactor, GLenum blend_dfactor)
+	{
+		if(count == 0)
+			return;
+
+		BatchState state;
+		state.texture = textureId;
+		state.texEnv = textureId ? texEnv : GL_MODULATE;
+		state.sfactor = blend_sfactor;
+		state.dfactor = blend_dfactor;
+		state.clipped = !clipStack.empty();
+		if(state.clipped)
+			state.clip = clipStack.top();
+
+		// transform on the CPU so draws made with different matrices can still share a draw call
+		const Eigen::Matrix4f& m = currentMatrix.matrix();
+		const unsigned int first = (unsigned int)queuedVertices.size();
+		queuedVertices.resize(first + count);
+		Eigen::Vector4f bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for(unsigned int i = 0; i < count; i++)
+		{
+			BatchVertex& v = queuedVertices[first + i];
+			const Eigen::Vector2f& pos = vertices[i].pos;
+			v.pos[0] = m(0, 0) * pos.x() + m(0, 1) * pos.y() + m(0, 3);
+			v.pos[1] = m(1, 0) * pos.x() + m(1, 1) * pos.y() + m(1, 3);
+			v.tex[0] = vertices[i].tex.x();
+			v.tex[1] = vertices[i].tex.y();
+			memcpy(v.color, &colors[i * 4], 4);
+
+			bounds[0] = std::min(bounds[0], v.pos[0]);
+			bounds[1] = std::min(bounds[1], v.pos[1]);
+			bounds[2] = std::max(bounds[2], v.pos[0]);
+			bounds[3] = std::max(bounds[3], v.pos[1]);
+		}
+
+		// drop anything entirely outside the clip rect (or the screen)
+		if(!isVisible(bounds))
+		{
+			queuedVertices.resize(first);
+			return;
+		}
+
+		// merge into the most recent batch with the same state, as long as nothing queued after it
+		// overlaps these triangles - drawing them earlier would then change the result
+		size_t batchIndex = batches.size();
+		for(size_t i = batches.size(); i > 0 && batches.size() - i < k_maxBatchLookback; i--)
+		{
+			Batch& batch = batches[i - 1];
+			if(batch.state == state)
+			{
+				batchIndex = i - 1;
+				break;
+			}
+			if(overlaps(batch.bounds, bounds))
+				break;
+		}
+
+		if(batchIndex == batches.size())
+		{
+			Batch batch;
+			batch.state = state;
+			batch.bounds = bounds;
+			batch.first = 0;
+			batch.count = 0;
+			batches.push_back(batch);
+		}
+
+		Batch& batch = batches[batchIndex];
+		batch.bounds.head<2>() = batch.bounds.head<2>().cwiseMin(bounds.head<2>());
+		batch.bounds.tail<2>() = batch.bounds.tail<2>().cwiseMax(bounds.tail<2>());
+		batch.count += count;
+
+		Submission submission = { (unsigned int)batchIndex, first, count };
+		submissions.push_back(submission);
+
+		if(!batchingEnabled)
+			flush();
+	}
+
+	void flush()
+	{
+		if(submissions.empty())
+			return;
+
+		if(capturing)
+			flushedWhileCapturing = true;
+
+		// lay the batches out one after another in the shared buffer, keeping their draw order
+		unsigned int next = 0;
+		for(auto& batch : batches)
+		{
+			batch.first = next;
+			next += batch.count;
+			batch.count = 0;
+		}
+		sortedVertices.resize(next);
+		for(auto& submission : submissions)
+		{
+			Batch& batch = batches[submission.batch];
+			memcpy(&sortedVertices[batch.first + batch.count], &queuedVertices[submission.first], submission.count * sizeof(BatchVertex));
+			batch.count += submission.count;
+		}
+
+		pipeline->begin(sortedVertices.data(), next);
 		glEnable(GL_BLEND);
-		glBlendFunc(blend_sfactor, blend_dfactor);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
 
+		const BatchState* last = NULL;
+		for(auto& batch : batches)
+		{
+			const BatchState& state = batch.state;
+			if(!last || last->texture != state.texture || last->texEnv != state.texEnv)
+				pipeline->setTexture(state.texture, state.texEnv);
+			if(!last || last->sfactor != state.sfactor || last->dfactor != state.dfactor)
+				glBlendFunc(state.sfactor, state.dfactor);
+			if(!last || last->clipped != state.clipped || (state.clipped && last->clip != state.clip))
+			{
+				if(state.clipped)
+				{
+					glEnable(GL_SCISSOR_TEST);
+					applyScissor(state.clip);
+				}else{
+					glDisable(GL_SCISSOR_TEST);
+				}
+			}
+
+			glDrawArrays(GL_TRIANGLES, batch.first, batch.count);
+			currentStats.drawCalls++;
+			currentStats.vertices += batch.count;
+			last = &state;
+		}
+
+		pipeline->end();
+		glDisable(GL_BLEND);
+
+		// leave GL as the caller set it up, for anything drawing directly
+		if(clipStack.empty())
+		{
+			glDisable(GL_SCISSOR_TEST);
+		}else{
+			glEnable(GL_SCISSOR_TEST);
+			applyScissor(clipStack.top());
+		}
+
+		queuedVertices.clear();
+		submissions.clear();
+		batches.clear();
+	}
+
+	void drawLines(const Eigen::Vector2f* points, const GLubyte* colors, unsigned int count)
+	{
+		if(count < 2)
+			return;
+
+		flush();
+
+		const Eigen::Matrix4f& m = currentMatrix.matrix();
+		std::vector<BatchVertex> vertices(count);
+		for(unsigned int i = 0; i < count; i++)
+		{
+			BatchVertex& v = vertices[i];
+			v.pos[0] = m(0, 0) * points[i].x() + m(0, 1) * points[i].y() + m(0, 3);
+			v.pos[1] = m(1, 0) * points[i].x() + m(1, 1) * points[i].y() + m(1, 3);
+			v.tex[0] = v.tex[1] = 0;
+			memcpy(v.color, &colors[i * 4], 4);
+		}
+
+		pipeline->begin(vertices.data(), count);
+		pipeline->setTexture(0, GL_MODULATE);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDrawArrays(GL_LINES, 0, count);
+		currentStats.drawCalls++;
+		currentStats.vertices += count;
+		glDisable(GL_BLEND);
+		pipeline->end();
+	}
+
+	void beginCapture()
+	{
+		flush();
+		capturing = true;
+		flushedWhileCapturing = false;
+	}
+
+	bool endCapture(size_t& hash)
+	{
+		capturing = false;
+		if(flushedWhileCapturing)
+			return false;
+
+		// FNV-1a over the states and vertices in draw order
+		uint64_t fnv = 14695981039346656037ULL;
+		auto add = [&fnv](const void* data, size_t size)
+		{
+			const unsigned char* bytes = (const unsigned char*)data;
+			for(size_t i = 0; i < size; i++)
+				fnv = (fnv ^ bytes[i]) * 1099511628211ULL;
+		};
+		for(auto& submission : submissions)
+		{
+			const BatchState& state = batches[submission.batch].state;
+			add(&state.texture, sizeof(state.texture));
+			add(&state.texEnv, sizeof(state.texEnv));
+			add(&state.sfactor, sizeof(state.sfactor));
+			add(&state.dfactor, sizeof(state.dfactor));
+			add(&state.clipped, sizeof(state.clipped));
+			if(state.clipped)
+				add(state.clip.data(), sizeof(int) * 4);
+			add(&queuedVertices[submission.first], submission.count * sizeof(BatchVertex));
+		}
+		hash = (size_t)fnv;
+		return true;
+	}
+
+	void discardQueued()
+	{
+		queuedVertices.clear();
+		submissions.clear();
+		batches.clear();
+	}
+
+	bool supportsRenderTargets()
+	{
+		if(fboChecked)
+			return fbo.gen != NULL;
+		fboChecked = true;
+
+		// ARB_framebuffer_object (and GL 3.0, GLES 2) uses the unsuffixed names
+		const char* suffixes[] = { "", "EXT", "OES" };
+		const char* extensions[] = { "GL_ARB_framebuffer_object", "GL_EXT_framebuffer_object", "GL_OES_framebuffer_object" };
+		for(int i = 0; i < 3; i++)
+		{
 #ifdef USE_OPENGL_ES
-		glVertexPointer(2, GL_SHORT, 0, points);
+			const bool core = i == 0 && usesShaders(); // shaders mean a GLES 2 context
 #else
-		glVertexPointer(2, GL_INT, 0, points);
+			const bool core = false;
 #endif
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+			if(!core && !SDL_GL_ExtensionSupported(extensions[i]))
+				continue;
 
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+			const std::string suffix = suffixes[i];
+			FramebufferFunctions functions;
+			functions.gen = (GenFramebuffersProc)SDL_GL_GetProcAddress(("glGenFramebuffers" + suffix).c_str());
+			functions.del = (DeleteFramebuffersProc)SDL_GL_GetProcAddress(("glDeleteFramebuffers" + suffix).c_str());
+			functions.bind = (BindFramebufferProc)SDL_GL_GetProcAddress(("glBindFramebuffer" + suffix).c_str());
+			functions.texture2D = (FramebufferTexture2DProc)SDL_GL_GetProcAddress(("glFramebufferTexture2D" + suffix).c_str());
+			functions.checkStatus = (CheckFramebufferStatusProc)SDL_GL_GetProcAddress(("glCheckFramebufferStatus" + suffix).c_str());
+			if(functions.gen && functions.del && functions.bind && functions.texture2D && functions.checkStatus)
+			{
+				fbo = functions;
+				LOG(LogInfo) << "Render targets: " << (core ? "GLES 2" : extensions[i]);
+				return true;
+			}
+		}
 
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		LOG(LogInfo) << "Render targets: not supported, layers are drawn directly";
+		return false;
+	}
+
+	bool createRenderTarget(const Eigen::Vector4i& rect, RenderTarget& target)
+	{
+		if(!supportsRenderTargets() || rect[2] <= 0 || rect[3] <= 0)
+			return false;
+
+		target.rect = rect;
+		target.context = contextGeneration;
+		glGetError();
+		glGenTextures(1, &target.textureId);
+		bindTexture(target.textureId);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rect[2], rect[3], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		GLint previous = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+		fbo.gen(1, &target.framebuffer);
+		fbo.bind(GL_FRAMEBUFFER, target.framebuffer);
+		fbo.texture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.textureId, 0);
+		const bool complete = fbo.checkStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE && glGetError() == GL_NO_ERROR;
+		fbo.bind(GL_FRAMEBUFFER, (GLuint)previous);
+
+		if(!complete)
+		{
+			LOG(LogWarning) << "Could not create a " << rect[2] << "x" << rect[3] << " render target";
+			deleteRenderTarget(target);
+			return false;
+		}
+		return true;
+	}
+
+	bool isRenderTargetValid(const RenderTarget& target)
+	{
+		return target.framebuffer != 0 && target.context == contextGeneration;
+	}
+
+	void deleteRenderTarget(RenderTarget& target)
+	{
+		// the names of a previous context may belong to something else by now
+		if(target.context == contextGeneration)
+		{
+			if(target.framebuffer)
+				fbo.del(1, &target.framebuffer);
+			if(target.textureId)
+				deleteTexture(target.textureId);
+		}
+		target = RenderTarget();
+	}
+
+	void flushToRenderTarget(const RenderTarget& target)
+	{
+		GLint previous = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+		fbo.bind(GL_FRAMEBUFFER, target.framebuffer);
+
+		// keep the screen projection and move the viewport instead, so the queued screen space
+		// vertices land on the target's part of the screen
+		targetOrigin << target.rect[0], (int)getScreenHeight() - target.rect[1] - target.rect[3];
+		glViewport(-targetOrigin.x(), -targetOrigin.y(), getScreenWidth(), getScreenHeight());
+		glDisable(GL_SCISSOR_TEST);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		flush();
+
+		fbo.bind(GL_FRAMEBUFFER, (GLuint)previous);
+		targetOrigin << 0, 0;
+		glViewport(0, 0, getScreenWidth(), getScreenHeight());
+		if(!clipStack.empty())
+			applyScissor(clipStack.top());
+	}
+
+	void readScreen(std::vector<unsigned char>& dataRGBA)
+	{
+		flush();
+		dataRGBA.resize(getScreenWidth() * getScreenHeight() * 4);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, getScreenWidth(), getScreenHeight(), GL_RGBA, GL_UNSIGNED_BYTE, dataRGBA.data());
+	}
+
+	void bindTexture(GLuint textureId)
+	{
+		if(textureId == boundTexture)
+			return;
+
+		glBindTexture(GL_TEXTURE_2D, textureId);
+		boundTexture = textureId;
+		currentStats.textureBinds++;
+	}
+
+	void deleteTexture(GLuint textureId)
+	{
+		//queued draws must not pick up whatever gets this id next
+		for(auto& batch : batches)
+		{
+			if(batch.state.texture == textureId)
+			{
+				flush();
+				break;
+			}
+		}
+
+		//GL reverts the binding to 0 when the bound texture is deleted
+		if(textureId == boundTexture)
+			boundTexture = 0;
+		glDeleteTextures(1, &textureId);
+	}
+
+	const FrameStats& getFrameStats()
+	{
+		return lastStats;
+	}
+
+	void endFrameStats()
+	{
+		lastStats = currentStats;
+		currentStats = FrameStats();
+
+		//looked up once a frame rather than per draw; turning it off flushes every draw, for comparison
+		batchingEnabled = Settings::getInstance()->getBool("BatchRendering");
+	}
+
+	void onContextChanged()
+	{
+		contextGeneration++;
+		fboChecked = false;
+		fbo = FramebufferFunctions();
+		boundTexture = 0; // nothing is bound in a new context
+	}
+
+	bool initPipeline(bool shaders, unsigned int width, unsigned int height)
+	{
+		bool ok = true;
+		pipeline.reset(shaders ? createShaderPipeline() : createFixedPipeline());
+		if(!pipeline->init())
+		{
+			LOG(LogWarning) << "Could not set up the " << pipeline->getName() << " renderer, falling back to fixed function";
+			pipeline.reset(createFixedPipeline());
+			pipeline->init();
+			ok = false;
+		}
+		shaderPipeline = shaders && ok;
+
+		LOG(LogInfo) << "Renderer: " << pipeline->getName() << " pipeline";
+		pipeline->setProjection(width, height);
+		pipeline->setMatrix(currentMatrix);
+		return ok;
+	}
+
+	void deinitPipeline()
+	{
+		pipeline.reset();
+		shaderPipeline = false;
+	}
+
+	bool usesShaders()
+	{
+		return shaderPipeline;
+	}
+
+	bool supportsDistanceFields()
+	{
+		return pipeline && pipeline->supportsDistanceFields();
 	}
 
 	void setMatrix(float* matrix)
 	{
-		glLoadMatrixf(matrix);
+		currentMatrix.matrix() = Eigen::Map<Eigen::Matrix4f>(matrix);
+		if(pipeline)
+			pipeline->setMatrix(currentMatrix);
 	}
 
 	void setMatrix(const Eigen::Affine3f& matrix)
 	{
 		setMatrix((float*)matrix.data());
 	}
+
+	const Eigen::Affine3f& getMatrix()
+	{
+		return currentMatrix;
+	}
 };
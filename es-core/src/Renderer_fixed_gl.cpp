@@ -0,0 +1,100 @@
+#include "Renderer_pipeline.h"
+
+#ifdef USE_OPENGL_ES
+	#define glOrtho glOrthof
+#endif
+
+namespace Renderer
+{
+	//client side vertex arrays and the texture environment, what GLES 1 and old GL drivers offer
+	class FixedPipeline : public Pipeline
+	{
+	public:
+		FixedPipeline() : mMatrix(Eigen::Affine3f::Identity()), mTextured(false) {}
+
+		const char* getName() const override { return "fixed function"; }
+
+		bool init() override
+		{
+			return true;
+		}
+
+		void setProjection(unsigned int width, unsigned int height) override
+		{
+			glMatrixMode(GL_PROJECTION);
+			glLoadIdentity();
+			glOrtho(0, width, height, 0, -1.0, 1.0);
+			glMatrixMode(GL_MODELVIEW);
+			glLoadMatrixf(mMatrix.data());
+		}
+
+		void setMatrix(const Eigen::Affine3f& matrix) override
+		{
+			mMatrix = matrix;
+			glLoadMatrixf(mMatrix.data());
+		}
+
+		void begin(const BatchVertex* vertices, unsigned int count) override
+		{
+			glLoadIdentity();
+
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+
+			glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), vertices[0].pos);
+			glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), vertices[0].tex);
+			glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), vertices[0].color);
+
+			mTextured = false;
+			mTexEnv = GL_MODULATE;
+		}
+
+		void setTexture(GLuint textureId, GLenum texEnv) override
+		{
+			if(textureId)
+			{
+				if(!mTextured)
+					glEnable(GL_TEXTURE_2D);
+				bindTexture(textureId);
+			}else if(mTextured)
+			{
+				glDisable(GL_TEXTURE_2D);
+			}
+			mTextured = textureId != 0;
+
+			//modulating an alpha texture already takes the color from the vertices. Distance fields
+			//aren't used without shaders, they'd only look blurry.
+			if(texEnv == TEXENV_ALPHA || texEnv == TEXENV_DISTANCE_FIELD)
+				texEnv = GL_MODULATE;
+			if(texEnv != mTexEnv)
+			{
+				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, (GLfloat)texEnv);
+				mTexEnv = texEnv;
+			}
+		}
+
+		void end() override
+		{
+			glDisableClientState(GL_VERTEX_ARRAY);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			glDisableClientState(GL_COLOR_ARRAY);
+			if(mTexEnv != GL_MODULATE)
+				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			if(mTextured)
+				glDisable(GL_TEXTURE_2D);
+
+			glLoadMatrixf(mMatrix.data());
+		}
+
+	private:
+		Eigen::Affine3f mMatrix;
+		bool mTextured;
+		GLenum mTexEnv;
+	};
+
+	Pipeline* createFixedPipeline()
+	{
+		return new FixedPipeline();
+	}
+}
@@ -1,18 +1,16 @@
 #include "Renderer.h"
+#include "Renderer_pipeline.h"
 #include <iostream>
 #include "platform.h"
 #include GLHEADER
 #include "resources/Font.h"
+#include "resources/TextureAtlas.h"
 #include <SDL.h>
 #include "Log.h"
 #include "ImageIO.h"
 #include "../data/Resources.h"
 #include "Settings.h"
 
-#ifdef USE_OPENGL_ES
-	#define glOrtho glOrthof
-#endif
-
 namespace Renderer
 {
 	static bool initialCursorState;
@@ -30,6 +28,15 @@ namespace Renderer
 	{
 		LOG(LogInfo) << "Creating surface...";
 
+		// headless runs (benchmarks on machines without a display or GPU) use SDL's offscreen
+		// driver, which renders through EGL, and ask Mesa for its software rasterizer
+		const bool headless = Settings::getInstance()->getBool("Headless");
+		if(headless)
+		{
+			SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+			SDL_setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+		}
+
 		if(SDL_Init(SDL_INIT_VIDEO) != 0)
 		{
 			LOG(LogError) << "Error initializing SDL!\n	" << SDL_GetError();
@@ -50,20 +57,38 @@ namespace Renderer
 		//SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 2);
 
 #ifdef USE_OPENGL_ES
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 1);
+		// GLES 2 drops the fixed function pipeline, the shader renderer needs it
+		if(Settings::getInstance()->getBool("ShaderRenderer"))
+		{
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+		}else{
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 1);
+		}
 #endif
 
 		SDL_DisplayMode dispMode;
-		SDL_GetDesktopDisplayMode(0, &dispMode);
+		if(SDL_GetDesktopDisplayMode(0, &dispMode) != 0)
+		{
+			// no real display behind the offscreen driver
+			dispMode.w = 1280;
+			dispMode.h = 720;
+		}
 		if(display_width == 0)
 			display_width = dispMode.w;
 		if(display_height == 0)
 			display_height = dispMode.h;
 
+		Uint32 windowFlags = SDL_WINDOW_OPENGL;
+		if(headless)
+			windowFlags |= SDL_WINDOW_HIDDEN;
+		else if(!Settings::getInstance()->getBool("Windowed"))
+			windowFlags |= SDL_WINDOW_FULLSCREEN;
+
 		sdlWindow = SDL_CreateWindow("EmulationStation", 
 			SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 
 			display_width, display_height, 
-			SDL_WINDOW_OPENGL | (Settings::getInstance()->getBool("Windowed") ? 0 : SDL_WINDOW_FULLSCREEN));
+			windowFlags);
 
 		if(sdlWindow == NULL)
 		{
@@ -97,6 +122,30 @@ namespace Renderer
 		}
 
 		sdlContext = SDL_GL_CreateContext(sdlWindow);
+		if(sdlContext == NULL)
+		{
+			LOG(LogError) << "Error creating OpenGL context!\n\t" << SDL_GetError();
+			return false;
+		}
+
+		const bool shaders = Settings::getInstance()->getBool("ShaderRenderer");
+		if(!initPipeline(shaders, display_width, display_height) && shaders)
+		{
+#ifdef USE_OPENGL_ES
+			// a GLES 2 context can't run the fixed function pipeline, start over with GLES 1
+			LOG(LogWarning) << "Recreating the context as GLES 1";
+			deinitPipeline();
+			SDL_GL_DeleteContext(sdlContext);
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 1);
+			sdlContext = SDL_GL_CreateContext(sdlWindow);
+			if(sdlContext == NULL)
+			{
+				LOG(LogError) << "Error creating OpenGL context!\n\t" << SDL_GetError();
+				return false;
+			}
+			initPipeline(false, display_width, display_height);
+#endif
+		}
 
 		// vsync
 		if(Settings::getInstance()->getBool("VSync"))
@@ -116,8 +165,12 @@ namespace Renderer
 
 	void swapBuffers()
 	{
+		flush();
+		// nothing queued samples the removed atlas regions anymore
+		TextureAtlas::getInstance()->applyRemovals();
 		SDL_GL_SwapWindow(sdlWindow);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		endFrameStats();
 	}
 
 	void destroySurface()
@@ -147,17 +200,20 @@ namespace Renderer
 			return false;
 
 		glViewport(0, 0, display_width, display_height);
-
-		glMatrixMode(GL_PROJECTION);
-		glOrtho(0, display_width, display_height, 0, -1.0, 1.0);
-		glMatrixMode(GL_MODELVIEW);
 		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
+		onContextChanged();
+
 		return true;
 	}
 
 	void deinit()
 	{
+		// textures unloaded before this give their atlas space back while the pages still exist
+		flush();
+		TextureAtlas::getInstance()->applyRemovals();
+		onContextChanged();
+		deinitPipeline();
 		destroySurface();
 	}
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Renderer.h"
+
+//Internal to the Renderer: the part of drawing that differs between the fixed function pipeline
+//(GL 1.x, GLES 1) and the shader pipeline (GL 2.0+, GLES 2). Renderer_draw_gl.cpp batches and sets
+//the state both share (blending, scissor, textures), the pipeline feeds vertices to GL.
+namespace Renderer
+{
+	struct BatchVertex
+	{
+		GLfloat pos[2];
+		GLfloat tex[2];
+		GLubyte color[4];
+	};
+
+	class Pipeline
+	{
+	public:
+		virtual ~Pipeline() {}
+
+		virtual const char* getName() const = 0;
+		//called once the context exists, false if the pipeline can't run on it
+		virtual bool init() = 0;
+		//maps screen pixels (y down) to the viewport
+		virtual void setProjection(unsigned int width, unsigned int height) = 0;
+		//follows Renderer::setMatrix
+		virtual void setMatrix(const Eigen::Affine3f& matrix) = 0;
+
+		//vertices are in screen space and stay valid until end(). In between, setTexture() is called
+		//whenever the texture or texEnv changes (texture 0 is untextured) and glDrawArrays draws.
+		virtual void begin(const BatchVertex* vertices, unsigned int count) = 0;
+		virtual void setTexture(GLuint textureId, GLenum texEnv) = 0;
+		virtual void end() = 0;
+
+		virtual bool supportsDistanceFields() const { return false; }
+	};
+
+	Pipeline* createFixedPipeline();
+	Pipeline* createShaderPipeline();
+
+	//called by init() once the context exists. Returns false if shaders were asked for and can't run
+	//on the context, the fixed function pipeline is used then.
+	bool initPipeline(bool shaders, unsigned int width, unsigned int height);
+	//called by deinit() while the context is still current
+	void deinitPipeline();
+}
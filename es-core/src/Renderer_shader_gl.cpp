@@ -0,0 +1,472 @@
+#include "Renderer_pipeline.h"
+#include "Log.h"
+#include <SDL.h>
+#include <stddef.h>
+#include <vector>
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_FRAGMENT_SHADER
+	#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+	#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+	#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+	#define GL_LINK_STATUS 0x8B82
+#endif
+#ifndef GL_INFO_LOG_LENGTH
+	#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_ARRAY_BUFFER
+	#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STREAM_DRAW
+	#define GL_STREAM_DRAW 0x88E0
+#endif
+
+namespace Renderer
+{
+	namespace
+	{
+		// GL 2.0 / GLES 2 entry points, looked up at runtime since GLES 1 builds don't link them
+		typedef GLuint (APIENTRY* CreateShaderProc)(GLenum type);
+		typedef void (APIENTRY* ShaderSourceProc)(GLuint shader, GLsizei count, const char* const* strings, const GLint* lengths);
+		typedef void (APIENTRY* CompileShaderProc)(GLuint shader);
+		typedef void (APIENTRY* GetShaderivProc)(GLuint shader, GLenum name, GLint* value);
+		typedef void (APIENTRY* GetShaderInfoLogProc)(GLuint shader, GLsizei size, GLsizei* length, char* log);
+		typedef void (APIENTRY* DeleteShaderProc)(GLuint shader);
+		typedef GLuint (APIENTRY* CreateProgramProc)();
+		typedef void (APIENTRY* AttachShaderProc)(GLuint program, GLuint shader);
+		typedef void (APIENTRY* BindAttribLocationProc)(GLuint program, GLuint index, const char* name);
+		typedef void (APIENTRY* LinkProgramProc)(GLuint program);
+		typedef void (APIENTRY* GetProgramivProc)(GLuint program, GLenum name, GLint* value);
+		typedef void (APIENTRY* GetProgramInfoLogProc)(GLuint program, GLsizei size, GLsizei* length, char* log);
+		typedef void (APIENTRY* DeleteProgramProc)(GLuint program);
+		typedef void (APIENTRY* UseProgramProc)(GLuint program);
+		typedef GLint (APIENTRY* GetUniformLocationProc)(GLuint program, const char* name);
+		typedef void (APIENTRY* Uniform1iProc)(GLint location, GLint value);
+		typedef void (APIENTRY* UniformMatrix4fvProc)(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+		typedef void (APIENTRY* GenBuffersProc)(GLsizei n, GLuint* buffers);
+		typedef void (APIENTRY* DeleteBuffersProc)(GLsizei n, const GLuint* buffers);
+		typedef void (APIENTRY* BindBufferProc)(GLenum target, GLuint buffer);
+		typedef void (APIENTRY* BufferDataProc)(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+		typedef void (APIENTRY* BufferSubDataProc)(GLenum target, ptrdiff_t offset, ptrdiff_t size, const void* data);
+		typedef void (APIENTRY* EnableVertexAttribArrayProc)(GLuint index);
+		typedef void (APIENTRY* VertexAttribPointerProc)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+		typedef void (APIENTRY* GenVertexArraysProc)(GLsizei n, GLuint* arrays);
+		typedef void (APIENTRY* DeleteVertexArraysProc)(GLsizei n, const GLuint* arrays);
+		typedef void (APIENTRY* BindVertexArrayProc)(GLuint array);
+
+		struct ShaderFunctions
+		{
+			CreateShaderProc createShader;
+			ShaderSourceProc shaderSource;
+			CompileShaderProc compileShader;
+			GetShaderivProc getShaderiv;
+			GetShaderInfoLogProc getShaderInfoLog;
+			DeleteShaderProc deleteShader;
+			CreateProgramProc createProgram;
+			AttachShaderProc attachShader;
+			BindAttribLocationProc bindAttribLocation;
+			LinkProgramProc linkProgram;
+			GetProgramivProc getProgramiv;
+			GetProgramInfoLogProc getProgramInfoLog;
+			DeleteProgramProc deleteProgram;
+			UseProgramProc useProgram;
+			GetUniformLocationProc getUniformLocation;
+			Uniform1iProc uniform1i;
+			UniformMatrix4fvProc uniformMatrix4fv;
+			GenBuffersProc genBuffers;
+			DeleteBuffersProc deleteBuffers;
+			BindBufferProc bindBuffer;
+			BufferDataProc bufferData;
+			BufferSubDataProc bufferSubData;
+			EnableVertexAttribArrayProc enableVertexAttribArray;
+			VertexAttribPointerProc vertexAttribPointer;
+
+			// optional, core profiles need a vertex array object bound
+			GenVertexArraysProc genVertexArrays;
+			DeleteVertexArraysProc deleteVertexArrays;
+			BindVertexArrayProc bindVertexArray;
+		};
+
+		template<typename T>
+		bool load(T& function, const char* name)
+		{
+			function = (T)SDL_GL_GetProcAddress(name);
+			return function != NULL;
+		}
+
+		enum Attribute
+		{
+			ATTRIB_POSITION,
+			ATTRIB_TEXCOORD,
+			ATTRIB_COLOR
+		};
+
+		enum Program
+		{
+			PROGRAM_COLOR,		// untextured
+			PROGRAM_MODULATE,	// texture * color, GL_MODULATE
+			PROGRAM_DECAL,		// texture over color by its alpha, GL_DECAL
+			PROGRAM_ALPHA,		// color with the texture's alpha as coverage, TEXENV_ALPHA (fonts)
+			PROGRAM_DISTANCE_FIELD,	// color with coverage from a distance field, TEXENV_DISTANCE_FIELD (optional)
+			PROGRAM_COUNT
+		};
+
+		// extensions have to be enabled before anything that isn't a directive
+#ifdef USE_OPENGL_ES
+		const char* k_shaderVersion = "#version 100\n";
+		const char* k_shaderPrecision = "precision mediump float;\n";
+		const char* k_derivativesExtension = "#extension GL_OES_standard_derivatives : enable\n";
+#else
+		const char* k_shaderVersion = "#version 110\n";
+		const char* k_shaderPrecision = "";
+		const char* k_derivativesExtension = ""; // fwidth is core in GLSL 1.10
+#endif
+
+		// vertices arrive in screen space, only the projection is left to apply
+		const char* k_vertexShader =
+			"uniform mat4 u_projection;\n"
+			"attribute vec2 a_position;\n"
+			"attribute vec2 a_texCoord;\n"
+			"attribute vec4 a_color;\n"
+			"varying vec2 v_texCoord;\n"
+			"varying vec4 v_color;\n"
+			"void main()\n"
+			"{\n"
+			"	v_texCoord = a_texCoord;\n"
+			"	v_color = a_color;\n"
+			"	gl_Position = u_projection * vec4(a_position, 0.0, 1.0);\n"
+			"}\n";
+
+		const char* k_fragmentShaders[PROGRAM_COUNT] = {
+			"varying vec4 v_color;\n"
+			"void main()\n"
+			"{\n"
+			"	gl_FragColor = v_color;\n"
+			"}\n",
+
+			"uniform sampler2D u_texture;\n"
+			"varying vec2 v_texCoord;\n"
+			"varying vec4 v_color;\n"
+			"void main()\n"
+			"{\n"
+			"	gl_FragColor = texture2D(u_texture, v_texCoord) * v_color;\n"
+			"}\n",
+
+			"uniform sampler2D u_texture;\n"
+			"varying vec2 v_texCoord;\n"
+			"varying vec4 v_color;\n"
+			"void main()\n"
+			"{\n"
+			"	vec4 texel = texture2D(u_texture, v_texCoord);\n"
+			"	gl_FragColor = vec4(mix(v_color.rgb, texel.rgb, texel.a), v_color.a);\n"
+			"}\n",
+
+			"uniform sampler2D u_texture;\n"
+			"varying vec2 v_texCoord;\n"
+			"varying vec4 v_color;\n"
+			"void main()\n"
+			"{\n"
+			"	gl_FragColor = vec4(v_color.rgb, v_color.a * texture2D(u_texture, v_texCoord).a);\n"
+			"}\n",
+
+			// the edge is smoothed over about a pixel whatever the text is scaled to
+			"uniform sampler2D u_texture;\n"
+			"varying vec2 v_texCoord;\n"
+			"varying vec4 v_color;\n"
+			"void main()\n"
+			"{\n"
+			"	float distance = texture2D(u_texture, v_texCoord).a;\n"
+			"	float width = 0.7 * fwidth(distance);\n"
+			"	gl_FragColor = vec4(v_color.rgb, v_color.a * smoothstep(0.5 - width, 0.5 + width, distance));\n"
+			"}\n"
+		};
+	}
+
+	//a program per texture environment fed from one streaming vertex buffer, for GL 2.0+ and
+	//GLES 2 drivers that only emulate (or don't offer) the fixed function pipeline
+	class ShaderPipeline : public Pipeline
+	{
+	public:
+		ShaderPipeline() : mGL(), mBuffer(0), mBufferCapacity(0), mVertexArray(0), mCurrentProgram(PROGRAM_COUNT)
+		{
+			for(int i = 0; i < PROGRAM_COUNT; i++)
+			{
+				mPrograms[i] = 0;
+				mProjectionLocations[i] = -1;
+			}
+		}
+
+		~ShaderPipeline()
+		{
+			// only ever destroyed while its context is current
+			for(int i = 0; i < PROGRAM_COUNT; i++)
+			{
+				if(mPrograms[i])
+					mGL.deleteProgram(mPrograms[i]);
+			}
+			if(mBuffer)
+				mGL.deleteBuffers(1, &mBuffer);
+			if(mVertexArray)
+				mGL.deleteVertexArrays(1, &mVertexArray);
+		}
+
+		const char* getName() const override { return "shader"; }
+
+		bool init() override
+		{
+			if(!loadFunctions())
+			{
+				LOG(LogWarning) << "Shader renderer: the context doesn't provide GL 2.0 / GLES 2 functions";
+				return false;
+			}
+
+			for(int i = 0; i < PROGRAM_COUNT; i++)
+			{
+				if(i == PROGRAM_DISTANCE_FIELD)
+				{
+					// fonts fall back to plain glyphs without it
+#ifdef USE_OPENGL_ES
+					if(!SDL_GL_ExtensionSupported("GL_OES_standard_derivatives"))
+						continue;
+#endif
+					mPrograms[i] = buildProgram(k_fragmentShaders[i], k_derivativesExtension);
+					if(!mPrograms[i])
+					{
+						LOG(LogWarning) << "Shader renderer: no distance field program, fonts are drawn from plain glyphs";
+						continue;
+					}
+				}else{
+					mPrograms[i] = buildProgram(k_fragmentShaders[i], "");
+					if(!mPrograms[i])
+						return false;
+				}
+
+				mGL.useProgram(mPrograms[i]);
+				mGL.uniform1i(mGL.getUniformLocation(mPrograms[i], "u_texture"), 0);
+				mProjectionLocations[i] = mGL.getUniformLocation(mPrograms[i], "u_projection");
+			}
+			mCurrentProgram = PROGRAM_COUNT;
+
+			if(mGL.genVertexArrays && mGL.bindVertexArray && mGL.deleteVertexArrays)
+			{
+				mGL.genVertexArrays(1, &mVertexArray);
+				mGL.bindVertexArray(mVertexArray);
+			}
+
+			mGL.genBuffers(1, &mBuffer);
+			mGL.bindBuffer(GL_ARRAY_BUFFER, mBuffer);
+			mGL.enableVertexAttribArray(ATTRIB_POSITION);
+			mGL.enableVertexAttribArray(ATTRIB_TEXCOORD);
+			mGL.enableVertexAttribArray(ATTRIB_COLOR);
+			return true;
+		}
+
+		void setProjection(unsigned int width, unsigned int height) override
+		{
+			// glOrtho(0, width, height, 0, -1, 1), column major
+			const GLfloat projection[16] = {
+				2.0f / width, 0, 0, 0,
+				0, -2.0f / height, 0, 0,
+				0, 0, -1.0f, 0,
+				-1.0f, 1.0f, 0, 1.0f
+			};
+
+			for(int i = 0; i < PROGRAM_COUNT; i++)
+			{
+				if(!mPrograms[i])
+					continue;
+				mGL.useProgram(mPrograms[i]);
+				mGL.uniformMatrix4fv(mProjectionLocations[i], 1, GL_FALSE, projection);
+			}
+			mCurrentProgram = PROGRAM_COUNT;
+		}
+
+		void setMatrix(const Eigen::Affine3f& /*matrix*/) override
+		{
+			// the batcher already applied it to the vertices
+		}
+
+		void begin(const BatchVertex* vertices, unsigned int count) override
+		{
+			// orphan the buffer before filling it, so the driver hands out fresh storage instead of
+			// waiting for draws still reading the previous contents
+			const size_t size = count * sizeof(BatchVertex);
+			if(size > mBufferCapacity)
+			{
+				mBufferCapacity = 4096;
+				while(mBufferCapacity < size)
+					mBufferCapacity *= 2;
+			}
+
+			mGL.bindBuffer(GL_ARRAY_BUFFER, mBuffer);
+			mGL.bufferData(GL_ARRAY_BUFFER, mBufferCapacity, NULL, GL_STREAM_DRAW);
+			mGL.bufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
+
+			mGL.vertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (const void*)offsetof(BatchVertex, pos));
+			mGL.vertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (const void*)offsetof(BatchVertex, tex));
+			mGL.vertexAttribPointer(ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchVertex), (const void*)offsetof(BatchVertex, color));
+		}
+
+		void setTexture(GLuint textureId, GLenum texEnv) override
+		{
+			Program program = PROGRAM_COLOR;
+			if(textureId)
+			{
+				bindTexture(textureId);
+				if(texEnv == GL_DECAL)
+					program = PROGRAM_DECAL;
+				else if(texEnv == TEXENV_ALPHA || (texEnv == TEXENV_DISTANCE_FIELD && !mPrograms[PROGRAM_DISTANCE_FIELD]))
+					program = PROGRAM_ALPHA;
+				else if(texEnv == TEXENV_DISTANCE_FIELD)
+					program = PROGRAM_DISTANCE_FIELD;
+				else
+					program = PROGRAM_MODULATE;
+			}
+
+			if(program != mCurrentProgram)
+			{
+				mGL.useProgram(mPrograms[program]);
+				mCurrentProgram = program;
+			}
+		}
+
+		void end() override
+		{
+		}
+
+		bool supportsDistanceFields() const override
+		{
+			return mPrograms[PROGRAM_DISTANCE_FIELD] != 0;
+		}
+
+	private:
+		bool loadFunctions()
+		{
+			bool ok = load(mGL.createShader, "glCreateShader") &&
+				load(mGL.shaderSource, "glShaderSource") &&
+				load(mGL.compileShader, "glCompileShader") &&
+				load(mGL.getShaderiv, "glGetShaderiv") &&
+				load(mGL.getShaderInfoLog, "glGetShaderInfoLog") &&
+				load(mGL.deleteShader, "glDeleteShader") &&
+				load(mGL.createProgram, "glCreateProgram") &&
+				load(mGL.attachShader, "glAttachShader") &&
+				load(mGL.bindAttribLocation, "glBindAttribLocation") &&
+				load(mGL.linkProgram, "glLinkProgram") &&
+				load(mGL.getProgramiv, "glGetProgramiv") &&
+				load(mGL.getProgramInfoLog, "glGetProgramInfoLog") &&
+				load(mGL.deleteProgram, "glDeleteProgram") &&
+				load(mGL.useProgram, "glUseProgram") &&
+				load(mGL.getUniformLocation, "glGetUniformLocation") &&
+				load(mGL.uniform1i, "glUniform1i") &&
+				load(mGL.uniformMatrix4fv, "glUniformMatrix4fv") &&
+				load(mGL.genBuffers, "glGenBuffers") &&
+				load(mGL.deleteBuffers, "glDeleteBuffers") &&
+				load(mGL.bindBuffer, "glBindBuffer") &&
+				load(mGL.bufferData, "glBufferData") &&
+				load(mGL.bufferSubData, "glBufferSubData") &&
+				load(mGL.enableVertexAttribArray, "glEnableVertexAttribArray") &&
+				load(mGL.vertexAttribPointer, "glVertexAttribPointer");
+
+#ifdef USE_OPENGL_ES
+			const std::string vertexArraySuffix = SDL_GL_ExtensionSupported("GL_OES_vertex_array_object") ? "OES" : "";
+#else
+			const std::string vertexArraySuffix = "";
+#endif
+			if(vertexArraySuffix.size() || SDL_GL_ExtensionSupported("GL_ARB_vertex_array_object"))
+			{
+				load(mGL.genVertexArrays, ("glGenVertexArrays" + vertexArraySuffix).c_str());
+				load(mGL.deleteVertexArrays, ("glDeleteVertexArrays" + vertexArraySuffix).c_str());
+				load(mGL.bindVertexArray, ("glBindVertexArray" + vertexArraySuffix).c_str());
+			}
+
+			return ok;
+		}
+
+		GLuint compileShader(GLenum type, const char* source, const char* extensions)
+		{
+			const char* sources[] = { k_shaderVersion, extensions, k_shaderPrecision, source };
+			GLuint shader = mGL.createShader(type);
+			mGL.shaderSource(shader, 4, sources, NULL);
+			mGL.compileShader(shader);
+
+			GLint status = GL_FALSE;
+			mGL.getShaderiv(shader, GL_COMPILE_STATUS, &status);
+			if(status != GL_TRUE)
+			{
+				LOG(LogError) << "Shader renderer: compiling a " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") <<
+					" shader failed\n	" << getLog(shader, mGL.getShaderiv, mGL.getShaderInfoLog);
+				mGL.deleteShader(shader);
+				return 0;
+			}
+			return shader;
+		}
+
+		GLuint buildProgram(const char* fragmentSource, const char* fragmentExtensions)
+		{
+			GLuint vertex = compileShader(GL_VERTEX_SHADER, k_vertexShader, "");
+			GLuint fragment = vertex ? compileShader(GL_FRAGMENT_SHADER, fragmentSource, fragmentExtensions) : 0;
+			if(!fragment)
+			{
+				if(vertex)
+					mGL.deleteShader(vertex);
+				return 0;
+			}
+
+			GLuint program = mGL.createProgram();
+			mGL.attachShader(program, vertex);
+			mGL.attachShader(program, fragment);
+			mGL.bindAttribLocation(program, ATTRIB_POSITION, "a_position");
+			mGL.bindAttribLocation(program, ATTRIB_TEXCOORD, "a_texCoord");
+			mGL.bindAttribLocation(program, ATTRIB_COLOR, "a_color");
+			mGL.linkProgram(program);
+
+			// the program keeps them alive as long as it needs them
+			mGL.deleteShader(vertex);
+			mGL.deleteShader(fragment);
+
+			GLint status = GL_FALSE;
+			mGL.getProgramiv(program, GL_LINK_STATUS, &status);
+			if(status != GL_TRUE)
+			{
+				LOG(LogError) << "Shader renderer: linking failed\n	" << getLog(program, mGL.getProgramiv, mGL.getProgramInfoLog);
+				mGL.deleteProgram(program);
+				return 0;
+			}
+			return program;
+		}
+
+		template<typename GetProc, typename LogProc>
+		static std::string getLog(GLuint object, GetProc get, LogProc log)
+		{
+			GLint length = 0;
+			get(object, GL_INFO_LOG_LENGTH, &length);
+			if(length <= 1)
+				return "(no log)";
+
+			std::vector<char> text(length);
+			log(object, length, NULL, text.data());
+			return std::string(text.data());
+		}
+
+		ShaderFunctions mGL;
+		GLuint mPrograms[PROGRAM_COUNT];
+		GLint mProjectionLocations[PROGRAM_COUNT];
+		GLuint mBuffer;
+		size_t mBufferCapacity;
+		GLuint mVertexArray;
+		Program mCurrentProgram;
+	};
+
+	Pipeline* createShaderPipeline()
+	{
+		return new ShaderPipeline();
+	}
+}
@@ -15,7 +15,9 @@ std::vector<const char*> settings_dont_save = boost::assign::list_of
 	("DebugText")
 	("ShowExit")
 	("Windowed")
+	("Headless")
 	("VSync")
+	("ShaderRenderer")
 	("HideConsole")
 	("IgnoreGamelist")
 	("SplashScreen");
@@ -43,8 +45,17 @@ void Settings::setDefaults()
 	mBoolMap["BackgroundJoystickInput"] = false;
 	mBoolMap["ParseGamelistOnly"] = false;
 	mBoolMap["DrawFramerate"] = false;
+	mBoolMap["TextureAtlas"] = true;
+	mBoolMap["CompressTextures"] = true;
+	mBoolMap["BatchRendering"] = true;
+	mBoolMap["IdleFrameSkip"] = true;
+	mBoolMap["LayerCache"] = true;
+	mBoolMap["FontCache"] = true;
+	mBoolMap["DistanceFieldFonts"] = false;
+	mBoolMap["ShaderRenderer"] = false;
 	mBoolMap["ShowExit"] = true;
 	mBoolMap["Windowed"] = false;
+	mBoolMap["Headless"] = false;
 	mBoolMap["SplashScreen"] = true;
 	mBoolMap["LoopMenuEntries"] = true;
 	mBoolMap[ "BackgroundMusicEnabled" ] = true;
@@ -75,6 +86,7 @@ void Settings::setDefaults()
 	mIntMap["ScraperResizeWidth"] = 400;
 	mIntMap["ScraperResizeHeight"] = 0;
 	mIntMap["MaxVRAM"] = 100;
+	mIntMap["PrefetchMemory"] = 16; // MB of decoded gamelist images loaded ahead of the cursor
 	mIntMap[ "HiTemperature" ] = 50;
 	mIntMap[ "AutoScrollDelay" ] = 200;
 	mIntMap[ "BackgroundMusicVolume" ] = 100;
@@ -101,6 +113,8 @@ void Settings::setDefaults()
 	#endif
 
 	mBoolMap["VideoAudio"] = true;
+	mBoolMap["VideoPosters"] = true;
+	mBoolMap["VideoPreroll"] = true;
 	mBoolMap["CaptionsCompatibility"] = true;
 	// Audio out device for Video playback using OMX player.
 	mStringMap["OMXAudioDev"] = "both";
@@ -23,7 +23,7 @@ ElementMapType makeMap(const T& mapInit)
 	return m;
 }
 
-std::vector<std::string> ThemeData::sSupportedViews = boost::assign::list_of("system")("basic")("detailed")("video");
+std::vector<std::string> ThemeData::sSupportedViews = boost::assign::list_of("system")("basic")("detailed")("video")("grid");
 std::vector<std::string> ThemeData::sSupportedFeatures = boost::assign::list_of("video")("carousel")("z-index");
 
 std::map< std::string, ElementMapType > ThemeData::sElementMap = boost::assign::map_list_of
@@ -74,6 +74,15 @@ std::map< std::string, ElementMapType > ThemeData::sElementMap = boost::assign::
 		("forceUppercase", BOOLEAN)
 		("lineSpacing", FLOAT)
 		("zIndex", FLOAT)))
+	("imagegrid", makeMap(boost::assign::map_list_of
+		("pos", NORMALIZED_PAIR)
+		("size", NORMALIZED_PAIR)
+		("tileSize", NORMALIZED_PAIR)
+		("margin", NORMALIZED_PAIR)
+		("color", COLOR)
+		("selectedColor", COLOR)
+		("default", PATH)
+		("zIndex", FLOAT)))
 	("container", makeMap(boost::assign::map_list_of
 		("pos", NORMALIZED_PAIR)
 		("size", NORMALIZED_PAIR)
@@ -8,13 +8,27 @@
 #include <iomanip>
 #include "components/HelpComponent.h"
 #include "components/ImageComponent.h"
+#include "resources/TextureAtlas.h"
+#include "resources/TextureCompressor.h"
+#include "resources/TexturePrefetcher.h"
+#include "resources/TextureResource.h"
+#include "resources/VideoTexture.h"
+#include "helpers/VlcPlayerPool.h"
+#include "RenderLayerCache.h"
+#include "FrameScheduler.h"
 
 #include "utils/Temperature.h"
 
+namespace
+{
+	// Frames drawn after input or a GUI change before the window can go idle, for components that
+	// react a frame late
+	const int k_redrawFrames = 3;
+}
 
-
-Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false)
+Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mTextureBindsElapsed(0), mDrawCallsElapsed(0), mVerticesElapsed(0), mCulledElapsed(0), mAverageDeltaTime(10),
+	mIdleTimeElapsed(0), mStatsStartTicks(0), mStatsStartClock(std::clock()), mStatsStartTextCaches(0),
+	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mRedrawFrames(k_redrawFrames), mScreenSaver(NULL), mRenderScreenSaver(false)
 {
 	mHelp = new HelpComponent(this);
 	mBackgroundOverlay = new ImageComponent(this);
@@ -40,6 +54,7 @@ void Window::pushGui(GuiComponent* gui)
 	}
 	mGuiStack.push_back(gui);
 	gui->updateHelpPrompts();
+	invalidate();
 }
 
 void Window::removeGui(GuiComponent* gui)
@@ -49,6 +64,7 @@ void Window::removeGui(GuiComponent* gui)
 		if(*i == gui)
 		{
 			i = mGuiStack.erase(i);
+			invalidate();
 
 			if(i == mGuiStack.end() && mGuiStack.size()) // we just popped the stack and the stack is not empty
 			{
@@ -77,6 +93,8 @@ bool Window::init(unsigned int width, unsigned int height)
 		return false;
 	}
 
+	TextureCompressor::getInstance()->init();
+
 	InputManager::getInstance()->init();
 
 	ResourceManager::getInstance()->reloadAll();
@@ -113,6 +131,7 @@ void Window::deinit()
 
 void Window::textInput(const char* text)
 {
+	invalidate();
 	if(peekGui())
 		peekGui()->textInput(text);
 }
@@ -120,6 +139,14 @@ void Window::textInput(const char* text)
 void Window::input(InputConfig* config, Input input)
 {
 	static bool updateBGMusic = true;
+
+	invalidate();
+	const std::tuple<int, int, int> inputKey(input.device, input.type, input.id);
+	if(input.value != 0)
+		mHeldInputs.insert(inputKey);
+	else
+		mHeldInputs.erase(inputKey);
+
 	if (mScreenSaver && input.value != 0) {
 		if(    mScreenSaver->isScreenSaverActive()
 			&& Settings::getInstance()->getBool("ScreenSaverControls") 
@@ -218,9 +245,22 @@ void Window::update(int deltaTime)
 
 	mFrameTimeElapsed += deltaTime;
 	mFrameCountElapsed++;
+	const Renderer::FrameStats& frameStats = Renderer::getFrameStats();
+	mTextureBindsElapsed += frameStats.textureBinds;
+	mDrawCallsElapsed += frameStats.drawCalls;
+	mVerticesElapsed += frameStats.vertices;
+	mCulledElapsed += GuiComponent::takeCulledCount();
+
+	Font::updatePrewarm();
+	Font::releaseIdleFaces();
 
 	if(mFrameTimeElapsed > 1000)
 	{
+		const unsigned int ticks = SDL_GetTicks();
+		const std::clock_t cpuClock = std::clock();
+		const float wallTime = (float)std::max(ticks - mStatsStartTicks, 1u);
+		const VideoTexture::Stats videoFrames = VideoTexture::takeStats();
+		const FrameScheduler::Stats pacing = FrameScheduler::getInstance()->takeStats();
 
 		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
 
@@ -240,18 +280,77 @@ void Window::update(int deltaTime)
 			ss << std::fixed << std::setprecision(1) << (1000.0f * (float)mFrameCountElapsed / (float)mFrameTimeElapsed) << "fps, ";
 			ss << std::fixed << std::setprecision(2) << ((float)mFrameTimeElapsed / (float)mFrameCountElapsed) << "ms";
 
+			// frame pacing, judder shows up as deviation
+			ss << "\nFrame time: sd " << pacing.deviationMs << "ms max " << pacing.maxMs << "ms" <<
+				  " Deferred: " << pacing.deferred << " ran, " << pacing.postponed << " postponed";
+
 			// vram
 			float textureVramUsageMb = TextureResource::getTotalMemUsage() / 1000.0f / 1000.0f;
 			float textureTotalUsageMb = TextureResource::getTotalTextureSize() / 1000.0f / 1000.0f;
 			float fontVramUsageMb = Font::getTotalMemUsage() / 1000.0f / 1000.0f;;
+			float textureSavedMb = TextureResource::getTotalMemSaved() / 1000.0f / 1000.0f;
 
 			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb <<
 				  " Tex Max: " << textureTotalUsageMb;
+			ss << "\nTex compression: " << TextureCompressor::getFormatName(TextureCompressor::getInstance()->getFormat()) <<
+				  " Saved: " << textureSavedMb;
+
+			// prefetch
+			const TexturePrefetcher::Stats& prefetch = TexturePrefetcher::getStats();
+			ss << "\nPrefetch hits: " << prefetch.hits << "/" << prefetch.shown;
+			if(prefetch.shown > 0)
+				ss << " (" << std::setprecision(0) << (100.0f * prefetch.hits / prefetch.shown) << "%)";
+
+			// texture binds
+			TextureAtlas* atlas = TextureAtlas::getInstance();
+			ss << "\nBinds/frame: " << std::setprecision(1) << ((float)mTextureBindsElapsed / (float)mFrameCountElapsed) <<
+				  " Atlas: " << atlas->getPageCount() << " pages, " << (atlas->getVRAMUsage() / 1000.0f / 1000.0f) << "MB";
+
+			// batching
+			ss << "\nDraws/frame: " << ((float)mDrawCallsElapsed / (float)mFrameCountElapsed) <<
+				  " Verts/frame: " << ((float)mVerticesElapsed / (float)mFrameCountElapsed) <<
+				  " Culled/frame: " << ((float)mCulledElapsed / (float)mFrameCountElapsed);
+
+			// each text cache built allocates its vertex arrays
+			ss << "\nText caches/frame: " << ((float)(Font::getTextCachesBuilt() - mStatsStartTextCaches) / (float)mFrameCountElapsed);
+
+			// cached layers
+			const RenderLayerCache::Stats& layers = RenderLayerCache::getStats();
+			const unsigned int layerDraws = layers.hits + layers.rebuilds + layers.direct;
+			ss << "\nLayer cache hits: " << layers.hits << "/" << layerDraws;
+			if(layerDraws > 0)
+				ss << " (" << std::setprecision(0) << (100.0f * layers.hits / layerDraws) << "%)";
+			ss << " VRAM: " << std::setprecision(1) << (layers.vramBytes / 1000.0f / 1000.0f) << "MB";
+
+			// video frames, uploads only happen for frames the decoder actually produced
+			if(videoFrames.decoded > 0 || videoFrames.uploaded > 0)
+				ss << "\nVideo frames/s: decoded " << std::setprecision(1) << (1000.0f * videoFrames.decoded / wallTime) <<
+					  " uploaded " << (1000.0f * videoFrames.uploaded / wallTime);
+
+			// time from starting a video to its first frame, since startup
+			const VlcPlayerPool::Stats& videoStarts = VlcPlayerPool::getInstance()->getStats();
+			if(videoStarts.started > 0)
+				ss << "\nVideo first frame: last " << videoStarts.lastMs << "ms avg " << videoStarts.averageMs << "ms max " << videoStarts.maxMs <<
+					  "ms, pre-rolled " << videoStarts.prerolled << "/" << videoStarts.started;
+
+			// idle frame skipping, every frame is one wakeup of the main loop
+			const float cpuTime = 1000.0f * (float)(cpuClock - mStatsStartClock) / (float)CLOCKS_PER_SEC;
+			ss << "\nIdle: " << std::setprecision(0) << (100.0f * mIdleTimeElapsed / wallTime) << "%" <<
+				  " Wakeups/s: " << std::setprecision(1) << (1000.0f * mFrameCountElapsed / wallTime) <<
+				  " CPU: " << (100.0f * cpuTime / wallTime) << "%";
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(1)->buildTextCache(ss.str(), 50.f, 50.f, 0xFF00FFFF));
 		}
 
 		mFrameTimeElapsed = 0;
 		mFrameCountElapsed = 0;
+		mTextureBindsElapsed = 0;
+		mDrawCallsElapsed = 0;
+		mVerticesElapsed = 0;
+		mCulledElapsed = 0;
+		mIdleTimeElapsed = 0;
+		mStatsStartTicks = ticks;
+		mStatsStartClock = cpuClock;
+		mStatsStartTextCaches = Font::getTextCachesBuilt();
 	}
 	
 
@@ -270,6 +369,9 @@ void Window::render()
 {
 	Eigen::Affine3f transform = Eigen::Affine3f::Identity();
 
+	if(mRedrawFrames > 0)
+		mRedrawFrames--;
+
 	mRenderedHelpPrompts = false;
 
 	// draw only bottom and top of GuiStack (if they are different)
@@ -318,6 +420,46 @@ void Window::render()
 	}
 }
 
+int Window::getIdleTimeout()
+{
+	if(mSleeping)
+		return -1;
+
+	if(!Settings::getInstance()->getBool("IdleFrameSkip") || mRedrawFrames > 0 || !mHeldInputs.empty() ||
+	   mRenderScreenSaver || isProcessing() || TextureResource::isLoading() || Font::isPrewarming() ||
+	   FrameScheduler::getInstance()->hasPostponed())
+		return 0;
+
+	// the bottom of the stack is drawn too, and may be playing a video under a menu
+	int timeout = -1;
+	if(mGuiStack.size())
+	{
+		timeout = mGuiStack.back()->getRedrawDelay();
+		if(mGuiStack.front() != mGuiStack.back())
+			timeout = GuiComponent::earliestRedraw(timeout, mGuiStack.front()->getRedrawDelay());
+	}
+
+	// the overlays are refreshed once a second
+	if(Settings::getInstance()->getBool("DrawFramerate") || Settings::getInstance()->getString("ShowTemperature") != "never")
+		timeout = GuiComponent::earliestRedraw(timeout, std::max(1001 - mFrameTimeElapsed, 0));
+
+	const unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	if(screensaverTime != 0)
+		timeout = GuiComponent::earliestRedraw(timeout, mTimeSinceLastInput < screensaverTime ? (int)(screensaverTime - mTimeSinceLastInput) : 0);
+
+	return timeout;
+}
+
+void Window::onIdleWait(unsigned int waitTime)
+{
+	mIdleTimeElapsed += waitTime;
+}
+
+void Window::invalidate()
+{
+	mRedrawFrames = k_redrawFrames;
+}
+
 void Window::normalizeNextUpdate()
 {
 	mNormalizeNextUpdate = true;
@@ -2,6 +2,9 @@
 
 #include "GuiComponent.h"
 #include <vector>
+#include <set>
+#include <tuple>
+#include <ctime>
 #include "resources/Font.h"
 #include "InputManager.h"
 #include "NavigationController.h"
@@ -39,6 +42,14 @@ public:
 	void update(int deltaTime);
 	void render();
 
+	// Milliseconds the main loop can wait for input before the next frame has to be drawn: 0 if
+	// something on screen is changing, -1 if nothing will until there is input
+	int getIdleTimeout();
+	// Called by the main loop after waiting, for the idle statistics
+	void onIdleWait(unsigned int waitTime);
+	// Draws the next few frames even if nothing reports a change, e.g. after a background job finished
+	void invalidate();
+
 	bool init(unsigned int width = 0, unsigned int height = 0);
 	void deinit();
 
@@ -78,7 +89,15 @@ private:
 
 	int mFrameTimeElapsed;
 	int mFrameCountElapsed;
+	unsigned int mTextureBindsElapsed;
+	unsigned int mDrawCallsElapsed;
+	unsigned int mVerticesElapsed;
+	unsigned int mCulledElapsed;
 	int mAverageDeltaTime;
+	unsigned int mIdleTimeElapsed;
+	unsigned int mStatsStartTicks;
+	std::clock_t mStatsStartClock;
+	unsigned long long mStatsStartTextCaches;
 
 	std::unique_ptr<TextCache> mFrameDataText;
 	std::unique_ptr<TextCache> mTemperatureText;
@@ -90,6 +109,9 @@ private:
 	bool mSleeping;
 	unsigned int mTimeSinceLastInput;
 
+	int mRedrawFrames;
+	std::set< std::tuple<int, int, int> > mHeldInputs; // device, type, id of inputs that are still pressed
+
 	bool mRenderedHelpPrompts;
 	NavigationController mNavigationController;
 };
@@ -1,5 +1,6 @@
 #include "components/AnimatedImageComponent.h"
 #include "Log.h"
+#include <algorithm>
 
 AnimatedImageComponent::AnimatedImageComponent(Window* window) : GuiComponent(window), mEnabled(false)
 {
@@ -76,6 +77,14 @@ void AnimatedImageComponent::update(int deltaTime)
 	}
 }
 
+int AnimatedImageComponent::getRedrawDelay() const
+{
+	int delay = GuiComponent::getRedrawDelay();
+	if(mEnabled && mFrames.size() > 1)
+		delay = earliestRedraw(delay, std::max(mFrames.at(mCurrentFrame).second - mFrameAccumulator, 0));
+	return delay;
+}
+
 void AnimatedImageComponent::render(const Eigen::Affine3f& trans)
 {
 	if(mFrames.size())
@@ -89,6 +89,12 @@ void ButtonComponent::updateImage()
 	mBox.setImagePath(mFocused ? ":/button_filled.png" : ":/button.png");
 }
 
+Eigen::Vector4f ButtonComponent::getDrawBounds() const
+{
+	// the box is padded around the button
+	return boundsUnion(GuiComponent::getDrawBounds(), mBox.getSubtreeBounds());
+}
+
 void ButtonComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	if (!mVisible) { return; }
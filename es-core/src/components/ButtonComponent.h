@@ -14,6 +14,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::Vector4f getDrawBounds() const override;
 
 	void setText(const std::string& text, const std::string& helpText);
 
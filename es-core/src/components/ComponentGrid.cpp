@@ -176,27 +176,27 @@ void ComponentGrid::updateSeparators()
 
 		if(it->border & BORDER_TOP || drawAll)
 		{
-			mLines.push_back(Vert(pos.x(), pos.y()));
-			mLines.push_back(Vert(pos.x() + size.x(), pos.y()));
+			mLines.push_back(Eigen::Vector2f(pos.x(), pos.y()));
+			mLines.push_back(Eigen::Vector2f(pos.x() + size.x(), pos.y()));
 		}
 		if(it->border & BORDER_BOTTOM || drawAll)
 		{
-			mLines.push_back(Vert(pos.x(), pos.y() + size.y()));
-			mLines.push_back(Vert(pos.x() + size.x(), mLines.back().y));
+			mLines.push_back(Eigen::Vector2f(pos.x(), pos.y() + size.y()));
+			mLines.push_back(Eigen::Vector2f(pos.x() + size.x(), mLines.back().y()));
 		}
 		if(it->border & BORDER_LEFT || drawAll)
 		{
-			mLines.push_back(Vert(pos.x(), pos.y()));
-			mLines.push_back(Vert(pos.x(), pos.y() + size.y()));
+			mLines.push_back(Eigen::Vector2f(pos.x(), pos.y()));
+			mLines.push_back(Eigen::Vector2f(pos.x(), pos.y() + size.y()));
 		}
 		if(it->border & BORDER_RIGHT || drawAll)
 		{
-			mLines.push_back(Vert(pos.x() + size.x(), pos.y()));
-			mLines.push_back(Vert(mLines.back().x, pos.y() + size.y()));
+			mLines.push_back(Eigen::Vector2f(pos.x() + size.x(), pos.y()));
+			mLines.push_back(Eigen::Vector2f(mLines.back().x(), pos.y() + size.y()));
 		}
 	}
 
-	mLineColors.reserve(mLines.size());
+	mLineColors.resize(mLines.size());
 	Renderer::buildGLColorArray((GLubyte*)mLineColors.data(), 0xC6C7C6FF, mLines.size());
 }
 
@@ -385,20 +385,7 @@ void ComponentGrid::render(const Eigen::Affine3f& parentTrans)
 	if(mLines.size())
 	{
 		Renderer::setMatrix(trans);
-
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, 0, &mLines[0].x);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mLineColors.data());
-
-		glDrawArrays(GL_LINES, 0, mLines.size());
-
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		Renderer::drawLines(mLines.data(), (const GLubyte*)mLineColors.data(), mLines.size());
 	}
 }
 
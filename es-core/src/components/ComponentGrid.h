@@ -108,14 +108,7 @@ private:
 	float* mRowHeights;
 	float* mColWidths;
 	
-	struct Vert
-	{
-		Vert(float xi = 0, float yi = 0) : x(xi), y(yi) {};
-		float x;
-		float y;
-	};
-
-	std::vector<Vert> mLines;
+	std::vector<Eigen::Vector2f> mLines;
 	std::vector<unsigned int> mLineColors;
 
 	// Update position & size
@@ -17,7 +17,6 @@ ComponentList::ComponentList(Window* window, std::chrono::milliseconds scrollTie
 void ComponentList::addRow(const ComponentListRow& row, bool setCursorHere)
 {
 	IList<ComponentListRow, void*>::Entry e;
-	e.name = "";
 	e.object = NULL;
 	e.data = row;
 
@@ -177,7 +176,7 @@ void ComponentList::render(const Eigen::Affine3f& parentTrans)
 	// scroll the camera
 	trans.translate(Eigen::Vector3f(0, -round(mCameraOffset), 0));
 
-	// draw our entries
+	// draw our entries, skipping the rows scrolled out
 	std::vector<GuiComponent*> drawAfterCursor;
 	bool drawAll;
 	for(unsigned int i = 0; i < mEntries.size(); i++)
@@ -186,6 +185,9 @@ void ComponentList::render(const Eigen::Affine3f& parentTrans)
 		drawAll = !mFocused || i != mCursor;
 		for(auto it = entry.data.elements.begin(); it != entry.data.elements.end(); it++)
 		{
+			if(isCulled(it->component.get(), trans))
+				continue;
+
 			if(drawAll || it->invert_when_selected)
 			{
 				it->component->render(trans);
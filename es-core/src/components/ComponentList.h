@@ -70,6 +70,8 @@ public:
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::Vector4f getDrawBounds() const override { return GuiComponent::getDrawBounds(); }
+	bool clipsChildren() const override { return true; }
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
 	void onSizeChanged() override;
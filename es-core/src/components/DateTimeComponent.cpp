@@ -3,6 +3,7 @@
 #include "Window.h"
 #include "Log.h"
 #include "Util.h"
+#include <algorithm>
 
 DateTimeComponent::DateTimeComponent(Window* window, DisplayMode dispMode) : GuiComponent(window), 
 	mEditing(false), mEditIndex(0), mDisplayMode(dispMode), mRelativeUpdateAccumulator(0), 
@@ -134,6 +135,14 @@ void DateTimeComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+int DateTimeComponent::getRedrawDelay() const
+{
+	int delay = GuiComponent::getRedrawDelay();
+	if(mDisplayMode == DISP_RELATIVE_TO_NOW)
+		delay = earliestRedraw(delay, std::max(1001 - mRelativeUpdateAccumulator, 0));
+	return delay;
+}
+
 void DateTimeComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = parentTrans * getTransform();
@@ -163,6 +172,18 @@ void DateTimeComponent::render(const Eigen::Affine3f& parentTrans)
 	}
 }
 
+Eigen::Vector4f DateTimeComponent::getDrawBounds() const
+{
+	Eigen::Vector4f bounds = GuiComponent::getDrawBounds();
+	if(!mTextCache)
+		return bounds;
+
+	// the text is vertically centered and can spill over, render() rounds its position
+	const Eigen::Vector2f& textSize = mTextCache->metrics.size;
+	const float top = (mSize.y() - textSize.y()) / 2;
+	return boundsUnion(bounds, Eigen::Vector4f(-1, top - 1, textSize.x() + 1, top + textSize.y() + 1));
+}
+
 void DateTimeComponent::setValue(const std::string& val)
 {
 	mTime = string_to_ptime(val);
@@ -252,6 +273,7 @@ void DateTimeComponent::updateTextCache()
 	const std::string dispString = mUppercase ? strToUpper(getDisplayString(mode)) : getDisplayString(mode);
 	std::shared_ptr<Font> font = getFont();
 	mTextCache = std::unique_ptr<TextCache>(font->buildTextCache(dispString, 0, 0, mColor));
+	invalidateBounds();
 
 	if(mAutoSize)
 	{
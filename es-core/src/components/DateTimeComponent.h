@@ -22,7 +22,9 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	int getRedrawDelay() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::Vector4f getDrawBounds() const override;
 	void onSizeChanged() override;
 
 	// Set how the point in time will be displayed:
@@ -56,9 +56,18 @@ class IList : public GuiComponent
 public:
 	struct Entry
 	{
-		std::string name;
+		// not a copy, the name belongs to the object (or is a static) and has to stay at the same
+		// address for as long as the entry exists. Filling a long list then doesn't allocate a string
+		// per entry. No name reads as "".
+		const std::string* name = nullptr;
 		UserData object;
 		EntryData data;
+
+		inline const std::string& getName() const
+		{
+			static const std::string noName;
+			return name ? *name : noName;
+		}
 	};
 
 protected:
@@ -153,6 +162,21 @@ public:
 		return mScrollVelocity;
 	}
 
+	int getRedrawDelay() const override
+	{
+		// scrolling, or fading the title overlay in/out
+		const unsigned char overlayTarget = (mScrollTier >= mTierList.count - 1) ? 255 : 0;
+		if(mScrollVelocity != 0 || mTitleOverlayOpacity != overlayTarget)
+			return 0;
+		return GuiComponent::getRedrawDelay();
+	}
+
+	Eigen::Vector4f getDrawBounds() const override
+	{
+		// the title overlay covers the whole screen
+		return getUnboundedArea();
+	}
+
 	void stopScrolling()
 	{
 		listInput(0);
@@ -162,6 +186,7 @@ public:
 	void clear()
 	{
 		mEntries.clear();
+		onEntriesCleared();
 		mCursor = 0;
 		listInput(0);
 		onCursorChanged(CURSOR_STOPPED);
@@ -170,7 +195,7 @@ public:
 	inline const std::string& getSelectedName()
 	{
 		assert(size() > 0);
-		return mEntries.at(mCursor).name;
+		return mEntries.at(mCursor).getName();
 	}
 
 	inline const UserData& getSelected() const
@@ -184,6 +209,11 @@ public:
 		return mCursor;
 	}
 
+	inline const UserData& getObjectAt(int index) const
+	{
+		return mEntries.at(index).object;
+	}
+
 	void setCursor(typename std::vector<Entry>::iterator& it)
 	{
 		assert(it != mEntries.end());
@@ -219,6 +249,12 @@ public:
 		mEntries.push_back(e);
 	}
 
+	// clear() keeps the storage, so refilling a list doesn't reallocate it
+	void reserve(size_t count)
+	{
+		mEntries.reserve(count);
+	}
+
 	bool remove(const UserData& obj)
 	{
 		for(auto it = mEntries.begin(); it != mEntries.end(); it++)
@@ -244,7 +280,9 @@ protected:
 			onCursorChanged(CURSOR_STOPPED);
 		}
 
+		const int index = (int)(it - mEntries.begin());
 		mEntries.erase(it);
+		onEntryRemoved(index);
 	}
 
 
@@ -366,4 +404,8 @@ protected:
 
 	virtual void onCursorChanged(const CursorState& state) {}
 	virtual void onScroll(int amt) {}
+	// the entries after index moved up by one
+	virtual void onEntryRemoved(int index) {}
+	// every entry was removed, indexes kept from before mean nothing now
+	virtual void onEntriesCleared() {}
 };
@@ -23,7 +23,7 @@ Eigen::Vector2f ImageComponent::getCenter() const
 
 ImageComponent::ImageComponent(Window* window, bool forceLoad, bool dynamic) : GuiComponent(window),
 	mTargetIsMax(false), mFlipX(false), mFlipY(false), mOrigin(0.0, 0.0), mTargetSize(0, 0), mColorShift(0xFFFFFFFF),
-	mForceLoad(forceLoad), mDynamic(dynamic), mFadeOpacity(0u), mFading(false), mGLTextEnv(GL_MODULATE)
+	mTextureRect(0, 0, 1, 1), mForceLoad(forceLoad), mDynamic(dynamic), mFadeOpacity(0u), mFading(false), mGLTextEnv(GL_MODULATE)
 {
 	updateColors();
 }
@@ -91,6 +91,7 @@ void ImageComponent::resize()
 	// mSize.y() should already be rounded
 	mTexture->rasterizeAt((int)round(mSize.x()), (int)round(mSize.y()));
 
+	invalidateBounds();
 	onSizeChanged();
 }
 
@@ -122,15 +123,26 @@ void ImageComponent::setImage(const char* path, size_t length, bool tile)
 void ImageComponent::setImage(const std::shared_ptr<TextureResource>& texture)
 {
 	mTexture = texture;
+	// a thumbnail still loading has no size yet, render() sizes the image once it has loaded
+	if(mTexture && mTexture->getSourceImageSize().isZero())
+		setSize(0, 0);
 	resize();
 }
 
 void ImageComponent::setOrigin(float originX, float originY)
 {
 	mOrigin << originX, originY;
+	invalidateBounds();
 	updateVertices();
 }
 
+Eigen::Vector4f ImageComponent::getDrawBounds() const
+{
+	// same as updateVertices(), a pixel wider for its rounding
+	const Eigen::Vector2f topLeft(-mSize.x() * mOrigin.x(), -mSize.y() * mOrigin.y());
+	return Eigen::Vector4f(floor(topLeft.x()), floor(topLeft.y()), topLeft.x() + mSize.x() + 1, topLeft.y() + mSize.y() + 1);
+}
+
 void ImageComponent::setResize(float width, float height)
 {
 	mTargetSize << width, height;
@@ -227,6 +239,10 @@ void ImageComponent::updateVertices()
 		for(int i = 1; i < 6; i++)
 			mVertices[i].tex[1] = mVertices[i].tex[1] == py ? 0 : py;
 	}
+
+	// the image may only be part of the bound texture if it was packed into the atlas
+	for(int i = 0; i < 6; i++)
+		mVertices[i].tex = mTextureRect.head<2>() + mVertices[i].tex.cwiseProduct(mTextureRect.tail<2>());
 }
 
 void ImageComponent::updateColors()
@@ -234,6 +250,14 @@ void ImageComponent::updateColors()
 	Renderer::buildGLColorArray(mColors, mColorShift, 6);
 }
 
+int ImageComponent::getRedrawDelay() const
+{
+	// fading in, or still waiting for the texture to load
+	if(mFading)
+		return 0;
+	return GuiComponent::getRedrawDelay();
+}
+
 void ImageComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
@@ -244,35 +268,21 @@ void ImageComponent::render(const Eigen::Affine3f& parentTrans)
 		if(mTexture->isInitialized())
 		{
 			// actually draw the image
-			// The bind() function returns false if the texture is not currently loaded. A blank
-			// texture is bound in this case but we want to handle a fade so it doesn't just 'jump' in
+			// The upload() function returns false if the texture is not currently loaded. A blank
+			// texture is drawn in this case but we want to handle a fade so it doesn't just 'jump' in
 			// when it finally loads
-			fadeIn(mTexture->bind());
-
-			glEnable(GL_TEXTURE_2D);
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mGLTextEnv);
-
-
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-
-			glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-			glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
+			GLuint textureId;
+			fadeIn(mTexture->upload(textureId));
+			// thumbnails only know their size once they've loaded in the background
+			if(mSize.isZero() && !mTexture->getSourceImageSize().isZero())
+				resize();
+			if(mTexture->getTextureRect() != mTextureRect)
+			{
+				mTextureRect = mTexture->getTextureRect();
+				updateVertices();
+			}
 
-			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-			glDisable(GL_TEXTURE_2D);
-			glDisable(GL_BLEND);
+			Renderer::drawTriangles(mVertices, mColors, 6, textureId, (GLenum)mGLTextEnv);
 		}else{
 			LOG(LogError) << "Image texture is not initialized!";
 			mTexture.reset();
@@ -8,6 +8,7 @@
 #include <string>
 #include <memory>
 #include "resources/TextureResource.h"
+#include "Renderer.h"
 
 class ImageComponent : public GuiComponent
 {
@@ -57,6 +58,8 @@ public:
 	bool hasImage();
 
 	void render(const Eigen::Affine3f& parentTrans) override;
+	int getRedrawDelay() const override;
+	Eigen::Vector4f getDrawBounds() const override;
 
 	virtual void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
@@ -73,11 +76,7 @@ private:
 	// Used internally whenever the resizing parameters or texture change.
 	void resize();
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	} mVertices[6];
+	Renderer::Vertex mVertices[6];
 
 	GLubyte mColors[6*4];
 
@@ -88,6 +87,7 @@ private:
 	unsigned int mColorShift;
 
 	std::shared_ptr<TextureResource> mTexture;
+	Eigen::Vector4f			 mTextureRect; // sub-rectangle mVertices were built for, see TextureResource::getTextureRect()
 	unsigned char			 mFadeOpacity;
 	bool					 mFading;
 	bool				     mForceLoad;
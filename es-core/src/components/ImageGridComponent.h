@@ -3,13 +3,18 @@
 #include "GuiComponent.h"
 #include "components/IList.h"
 #include "components/ImageComponent.h"
+#include "resources/TextureResource.h"
+#include "ThemeData.h"
 #include "Log.h"
 
 struct ImageGridData
 {
-	std::shared_ptr<TextureResource> texture;
+	std::string texturePath;
 };
 
+// A grid of images, e.g. game thumbnails. Only the rows on screen and a few rows either side of
+// them have a tile. Tiles are reused as the grid scrolls and load their image in the background,
+// decoded at tile size, so memory stays the same however many entries there are.
 template<typename T>
 class ImageGridComponent : public IList<ImageGridData, T>
 {
@@ -31,85 +36,90 @@ public:
 
 	ImageGridComponent(Window* window);
 
+	// name isn't copied, it has to outlive the entry
 	void add(const std::string& name, const std::string& imagePath, const T& obj);
-	
+
 	void onSizeChanged() override;
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
-private:
-	Eigen::Vector2f getSquareSize(std::shared_ptr<TextureResource> tex = nullptr) const
-	{
-		Eigen::Vector2f aspect(1, 1);
-
-		if(tex)
-		{
-			const Eigen::Vector2i& texSize = tex->getSize();
-
-			if(texSize.x() > texSize.y())
-				aspect[0] = (float)texSize.x() / texSize.y();
-			else
-				aspect[1] = (float)texSize.y() / texSize.x();
-		}
-
-		return Eigen::Vector2f(156 * aspect.x(), 156 * aspect.y());
-	};
-
-	Eigen::Vector2f getMaxSquareSize() const
-	{
-		Eigen::Vector2f squareSize(32, 32);
-
-		// calc biggest square size
-		for(auto it = mEntries.begin(); it != mEntries.end(); it++)
-		{
-			Eigen::Vector2f chkSize = getSquareSize(it->data.texture);
-			if(chkSize.x() > squareSize.x())
-				squareSize[0] = chkSize[0];
-			if(chkSize.y() > squareSize.y())
-				squareSize[1] = chkSize[1];
-		}
+	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
-		return squareSize;
-	};
+	// Shown for entries without an image and while images are loading
+	void setDefaultImage(const std::string& path);
 
+private:
+	// columns, rows on screen
 	Eigen::Vector2i getGridSize() const
 	{
-		Eigen::Vector2f squareSize = getMaxSquareSize();
-		Eigen::Vector2i gridSize(mSize.x() / (squareSize.x() + getPadding().x()), mSize.y() / (squareSize.y() + getPadding().y()));
-		return gridSize;
-	};
-
-	Eigen::Vector2f getPadding() const { return Eigen::Vector2f(24, 24); }
-	
-	void buildImages();
-	void updateImages();
+		const Eigen::Vector2f cell = mTileSize + mMargin;
+		return Eigen::Vector2i(std::max(1, (int)(mSize.x() / cell.x())), std::max(1, (int)(mSize.y() / cell.y())));
+	}
 
-	virtual void onCursorChanged(const CursorState& state);
+	// The first row on screen, keeping the cursor row in the middle where possible
+	int getFirstRow() const;
+	Eigen::Vector2f getTilePosition(int row, int column) const;
 
-	bool mEntriesDirty;
+	void buildTiles();
+	void updateTiles();
+	void setTileEntry(int tile, int entry);
+	// Empties every tile, so the next updateTiles() loads them from the entries as they are now
+	void resetTiles();
 
-	std::vector<ImageComponent> mImages;
+	virtual void onCursorChanged(const CursorState& state);
+	virtual void onEntryRemoved(int index);
+	virtual void onEntriesCleared();
+
+	Eigen::Vector2f	mTileSize;
+	Eigen::Vector2f	mMargin;
+	unsigned int	mColor;
+	unsigned int	mSelectedColor;
+	bool			mEntriesDirty;
+
+	std::shared_ptr<TextureResource>			mDefaultTexture;
+	ImageComponent								mPlaceholder;
+	std::vector<std::unique_ptr<ImageComponent>> mTiles;
+	std::vector<int>							mTileEntries; // entry shown by each tile, -1 for none
+	int											mTileRows;	  // rows on screen plus the rows kept either side
 };
 
+namespace ImageGrid
+{
+	// rows kept loaded above and below the screen
+	const int k_extraRows = 2;
+}
+
 template<typename T>
-ImageGridComponent<T>::ImageGridComponent(Window* window) : IList<ImageGridData, T>(window)
+ImageGridComponent<T>::ImageGridComponent(Window* window) : IList<ImageGridData, T>(window, LIST_SCROLL_STYLE_QUICK, LIST_NEVER_LOOP),
+	mTileSize(156, 156), mMargin(24, 24), mColor(0xAAAAAABB), mSelectedColor(0xFFFFFFFF), mEntriesDirty(true),
+	mPlaceholder(window), mTileRows(0)
 {
-	mEntriesDirty = true;
+	setDefaultImage(":/button.png");
 }
 
 template<typename T>
 void ImageGridComponent<T>::add(const std::string& name, const std::string& imagePath, const T& obj)
 {
 	typename IList<ImageGridData, T>::Entry entry;
-	entry.name = name;
+	entry.name = &name;
 	entry.object = obj;
-	entry.data.texture = ResourceManager::getInstance()->fileExists(imagePath) ? TextureResource::get(imagePath) : TextureResource::get(":/button.png");
+	entry.data.texturePath = imagePath;
 	static_cast<IList< ImageGridData, T >*>(this)->add(entry);
 	mEntriesDirty = true;
 }
 
+template<typename T>
+void ImageGridComponent<T>::setDefaultImage(const std::string& path)
+{
+	mDefaultTexture = TextureResource::get(path);
+	mPlaceholder.setImage(mDefaultTexture);
+	mPlaceholder.setOrigin(0.5f, 0.5f);
+	mPlaceholder.setColorShift(mColor);
+	buildTiles();
+}
+
 template<typename T>
 bool ImageGridComponent<T>::input(InputConfig* config, Input input)
 {
@@ -149,107 +159,245 @@ void ImageGridComponent<T>::update(int deltaTime)
 template<typename T>
 void ImageGridComponent<T>::render(const Eigen::Affine3f& parentTrans)
 {
-	Eigen::Affine3f trans = getTransform() * parentTrans;
+	Eigen::Affine3f trans = parentTrans * getTransform();
 
 	if(mEntriesDirty)
 	{
-		buildImages();
-		updateImages();
+		// a tile only reloads when its entry index changes, an index may hold another entry now
+		resetTiles();
+		updateTiles();
 		mEntriesDirty = false;
 	}
 
-	for(auto it = mImages.begin(); it != mImages.end(); it++)
+	const Eigen::Vector2i gridSize = getGridSize();
+	const int firstRow = getFirstRow();
+	int selected = -1;
+	for(size_t tile = 0; tile < mTiles.size(); tile++)
+	{
+		const int entry = mTileEntries[tile];
+		if(entry < 0 || entry / gridSize.x() < firstRow || entry / gridSize.x() >= firstRow + gridSize.y())
+			continue;
+
+		// the selected tile grows into the margin, it goes on top
+		if(entry == mCursor)
+		{
+			selected = (int)tile;
+			continue;
+		}
+
+		ImageComponent& image = *mTiles[tile];
+		// sized once its image has loaded
+		if(image.getSize().isZero())
+		{
+			mPlaceholder.setPosition(image.getPosition());
+			mPlaceholder.render(trans);
+		}
+		image.render(trans);
+	}
+
+	if(selected >= 0)
 	{
-		it->render(trans);
+		ImageComponent& image = *mTiles[selected];
+		if(image.getSize().isZero())
+		{
+			mPlaceholder.setPosition(image.getPosition());
+			mPlaceholder.render(trans);
+		}
+		image.render(trans);
 	}
 
+	listRenderTitleOverlay(trans);
+
 	GuiComponent::renderChildren(trans);
 }
 
+template<typename T>
+void ImageGridComponent<T>::applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties)
+{
+	GuiComponent::applyTheme(theme, view, element, properties);
+
+	const ThemeData::ThemeElement* elem = theme->getElement(view, element, "imagegrid");
+	if(!elem)
+		return;
+
+	using namespace ThemeFlags;
+	const Eigen::Vector2f screen((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
+	if(properties & SIZE)
+	{
+		if(elem->has("tileSize"))
+			mTileSize = elem->get<Eigen::Vector2f>("tileSize").cwiseProduct(screen);
+		if(elem->has("margin"))
+			mMargin = elem->get<Eigen::Vector2f>("margin").cwiseProduct(screen);
+	}
+
+	if(properties & COLOR)
+	{
+		if(elem->has("color"))
+			mColor = elem->get<unsigned int>("color");
+		if(elem->has("selectedColor"))
+			mSelectedColor = elem->get<unsigned int>("selectedColor");
+	}
+
+	// also picks up the new tile size and colors
+	setDefaultImage((properties & PATH && elem->has("default")) ? elem->get<std::string>("default") : ":/button.png");
+}
+
 template<typename T>
 void ImageGridComponent<T>::onCursorChanged(const CursorState& state)
 {
-	updateImages();
+	updateTiles();
 }
 
 template<typename T>
-void ImageGridComponent<T>::onSizeChanged()
+void ImageGridComponent<T>::onEntryRemoved(int index)
 {
-	buildImages();
-	updateImages();
+	// the tiles from the removed entry on show what is now the next entry
+	for(size_t tile = 0; tile < mTileEntries.size(); tile++)
+	{
+		if(mTileEntries[tile] >= index)
+			setTileEntry((int)tile, -1);
+	}
+	updateTiles();
 }
 
-// create and position imagecomponents (mImages)
 template<typename T>
-void ImageGridComponent<T>::buildImages()
+void ImageGridComponent<T>::onEntriesCleared()
 {
-	mImages.clear();
+	resetTiles();
+	mEntriesDirty = true;
+}
 
-	Eigen::Vector2i gridSize = getGridSize();
-	Eigen::Vector2f squareSize = getMaxSquareSize();
-	Eigen::Vector2f padding = getPadding();
+template<typename T>
+void ImageGridComponent<T>::onSizeChanged()
+{
+	buildTiles();
+}
 
-	// attempt to center within our size
-	Eigen::Vector2f totalSize(gridSize.x() * (squareSize.x() + padding.x()), gridSize.y() * (squareSize.y() + padding.y()));
-	Eigen::Vector2f offset(mSize.x() - totalSize.x(), mSize.y() - totalSize.y());
-	offset /= 2;
+template<typename T>
+int ImageGridComponent<T>::getFirstRow() const
+{
+	const Eigen::Vector2i gridSize = getGridSize();
+	const int rowCount = (size() + gridSize.x() - 1) / gridSize.x();
+	int firstRow = mCursor / gridSize.x() - gridSize.y() / 2;
+
+	// at the end, fill the screen rather than leave rows empty
+	if(firstRow + gridSize.y() > rowCount)
+		firstRow = rowCount - gridSize.y();
+	if(firstRow < 0)
+		firstRow = 0;
+	return firstRow;
+}
 
-	for(int y = 0; y < gridSize.y(); y++)
-	{
-		for(int x = 0; x < gridSize.x(); x++)
-		{
-			mImages.push_back(ImageComponent(mWindow));
-			ImageComponent& image = mImages.at(y * gridSize.x() + x);
+template<typename T>
+Eigen::Vector2f ImageGridComponent<T>::getTilePosition(int row, int column) const
+{
+	const Eigen::Vector2i gridSize = getGridSize();
+	const Eigen::Vector2f cell = mTileSize + mMargin;
 
-			image.setPosition((squareSize.x() + padding.x()) * (x + 0.5f) + offset.x(), (squareSize.y() + padding.y()) * (y + 0.5f) + offset.y());
-			image.setOrigin(0.5f, 0.5f);
-			image.setResize(squareSize.x(), squareSize.y());
-			image.setImage("");
-		}
-	}
+	// attempt to center within our size
+	const Eigen::Vector2f offset = (mSize - Eigen::Vector2f(gridSize.x() * cell.x(), gridSize.y() * cell.y())) / 2;
+	return Eigen::Vector2f(cell.x() * (column + 0.5f) + offset.x(), cell.y() * (row + 0.5f) + offset.y());
 }
 
+// create the tiles for the rows on screen and the extra rows
 template<typename T>
-void ImageGridComponent<T>::updateImages()
+void ImageGridComponent<T>::buildTiles()
 {
-	if(mImages.empty())
-		buildImages();
+	const Eigen::Vector2i gridSize = getGridSize();
+	mTileRows = gridSize.y() + ImageGrid::k_extraRows * 2;
 
-	Eigen::Vector2i gridSize = getGridSize();
+	mTiles.clear();
+	mTileEntries.assign(gridSize.x() * mTileRows, -1);
+	for(int tile = 0; tile < gridSize.x() * mTileRows; tile++)
+	{
+		ImageComponent* image = new ImageComponent(mWindow);
+		image->setOrigin(0.5f, 0.5f);
+		mTiles.push_back(std::unique_ptr<ImageComponent>(image));
+	}
 
-	int cursorRow = mCursor / gridSize.x();
-	int cursorCol = mCursor % gridSize.x();
+	mPlaceholder.setMaxSize(mTileSize);
+	mEntriesDirty = true;
+}
 
-	int start = (cursorRow - (gridSize.y() / 2)) * gridSize.x();
+// point the tiles at the entries around the cursor. A row keeps its tiles while it stays within
+// the extra rows, so scrolling only loads the rows coming into range.
+template<typename T>
+void ImageGridComponent<T>::updateTiles()
+{
+	if(mTiles.empty())
+		return;
 
-	//if we're at the end put the row as close as we can and no higher
-	if(start + (gridSize.x() * gridSize.y()) >= (int)mEntries.size())
-		start = gridSize.x() * ((int)mEntries.size()/gridSize.x() - gridSize.y() + 1);
+	const Eigen::Vector2i gridSize = getGridSize();
+	const int firstRow = getFirstRow();
 
-	if(start < 0)
-		start = 0;
+	// the loader starts with the most recent request: rows furthest off screen go first, so the
+	// rows on screen load before them
+	std::vector<int> rows;
+	for(int extra = ImageGrid::k_extraRows; extra > 0; extra--)
+	{
+		rows.push_back(firstRow - extra);
+		rows.push_back(firstRow + gridSize.y() - 1 + extra);
+	}
+	for(int row = firstRow + gridSize.y() - 1; row >= firstRow; row--)
+		rows.push_back(row);
 
-	unsigned int i = (unsigned int)start;
-	for(unsigned int img = 0; img < mImages.size(); img++)
+	for(auto it = rows.begin(); it != rows.end(); it++)
 	{
-		ImageComponent& image = mImages.at(img);
-		if(i >= (unsigned int)size())
+		const int row = *it;
+		const int tileRow = ((row % mTileRows) + mTileRows) % mTileRows;
+		for(int column = 0; column < gridSize.x(); column++)
 		{
-			image.setImage("");
-			continue;
+			const int tile = tileRow * gridSize.x() + column;
+			const int entry = row * gridSize.x() + column;
+			const bool valid = row >= 0 && entry < size();
+			if(mTileEntries[tile] != (valid ? entry : -1))
+				setTileEntry(tile, valid ? entry : -1);
+			if(!valid)
+				continue;
+
+			ImageComponent& image = *mTiles[tile];
+			const Eigen::Vector2f position = getTilePosition(row - firstRow, column);
+			image.setPosition(position.x(), position.y());
+			if(entry == mCursor)
+			{
+				image.setColorShift(mSelectedColor);
+				image.setMaxSize(mTileSize + mMargin * 0.95f);
+			}else{
+				image.setColorShift(mColor);
+				image.setMaxSize(mTileSize);
+			}
 		}
+	}
+}
 
-		Eigen::Vector2f squareSize = getSquareSize(mEntries.at(i).data.texture);
-		if(i == mCursor)
-		{
-			image.setColorShift(0xFFFFFFFF);
-			image.setResize(squareSize.x() + getPadding().x() * 0.95f, squareSize.y() + getPadding().y() * 0.95f);
-		}else{
-			image.setColorShift(0xAAAAAABB);
-			image.setResize(squareSize.x(), squareSize.y());
-		}
+template<typename T>
+void ImageGridComponent<T>::setTileEntry(int tile, int entry)
+{
+	mTileEntries[tile] = entry;
+	ImageComponent& image = *mTiles[tile];
+	if(entry < 0)
+	{
+		image.setImage(std::shared_ptr<TextureResource>());
+		return;
+	}
 
-		image.setImage(mEntries.at(i).data.texture);
-		i++;
+	// decoded at the selected size, so the selected tile isn't blurry. A missing file fails to load
+	// on the loader thread and the tile keeps showing the placeholder.
+	const std::string& path = mEntries.at(entry).data.texturePath;
+	if(!path.empty())
+	{
+		const Eigen::Vector2f maxSize = mTileSize + mMargin;
+		image.setImage(TextureResource::getThumbnail(path, (size_t)maxSize.x(), (size_t)maxSize.y()));
 	}
+	else
+	{
+		image.setImage(mDefaultTexture);
+	}
+}
+
+template<typename T>
+void ImageGridComponent<T>::resetTiles()
+{
+	for(size_t tile = 0; tile < mTileEntries.size(); tile++)
+		setTileEntry((int)tile, -1);
 }
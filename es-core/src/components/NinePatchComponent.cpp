@@ -8,7 +8,7 @@
 NinePatchComponent::NinePatchComponent(Window* window, const std::string& path, unsigned int edgeColor, unsigned int centerColor) : GuiComponent(window),
 	mEdgeColor(edgeColor), mCenterColor(centerColor), 
 	mPath(path),
-	mVertices(NULL), mColors(NULL)
+	mVertices(NULL), mColors(NULL), mTextureRect(0, 0, 1, 1)
 {
 	if(!mPath.empty())
 		buildVertices();
@@ -132,10 +132,11 @@ void NinePatchComponent::buildVertices()
 		v += 6;
 	}
 
-	// round vertices
+	// round vertices, and map onto our part of the texture in case it was packed into the atlas
 	for(int i = 0; i < 6*9; i++)
 	{
 		mVertices[i].pos = roundVector(mVertices[i].pos);
+		mVertices[i].tex = mTextureRect.head<2>() + mVertices[i].tex.cwiseProduct(mTextureRect.tail<2>());
 	}
 }
 
@@ -147,28 +148,17 @@ void NinePatchComponent::render(const Eigen::Affine3f& parentTrans)
 	{
 		Renderer::setMatrix(trans);
 
-		mTexture->bind();
-
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6 * 9);
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		GLuint textureId;
+		mTexture->upload(textureId);
+		if(mTexture->getTextureRect() != mTextureRect)
+		{
+			mTextureRect = mTexture->getTextureRect();
+			buildVertices();
+			if(mVertices == NULL)
+				return;
+		}
+
+		Renderer::drawTriangles(mVertices, mColors, 6 * 9, textureId);
 	}
 
 	renderChildren(trans);
@@ -2,6 +2,7 @@
 
 #include "GuiComponent.h"
 #include "resources/TextureResource.h"
+#include "Renderer.h"
 
 // Display an image in a way so that edges don't get too distorted no matter the final size. Useful for UI elements like backgrounds, buttons, etc.
 // This is accomplished by splitting an image into 9 pieces:
@@ -38,11 +39,7 @@ private:
 	void buildVertices();
 	void updateColors();
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	};
+	typedef Renderer::Vertex Vertex;
 
 	Vertex* mVertices;
 	GLubyte* mColors;
@@ -51,4 +48,5 @@ private:
 	unsigned int mEdgeColor;
 	unsigned int mCenterColor;
 	std::shared_ptr<TextureResource> mTexture;
+	Eigen::Vector4f mTextureRect; // sub-rectangle mVertices were built for, see TextureResource::getTextureRect()
 };
@@ -103,8 +103,16 @@ void ScrollableContainer::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+int ScrollableContainer::getRedrawDelay() const
+{
+	// auto scrolling only moves anything if the content doesn't fit
+	if(mAutoScrollSpeed != 0 && getContentSize().y() > getSize().y())
+		return 0;
+	return GuiComponent::getRedrawDelay();
+}
+
 //this should probably return a box to allow for when controls don't start at 0,0
-Eigen::Vector2f ScrollableContainer::getContentSize()
+Eigen::Vector2f ScrollableContainer::getContentSize() const
 {
 	Eigen::Vector2f max(0, 0);
 	for(unsigned int i = 0; i < mChildren.size(); i++)
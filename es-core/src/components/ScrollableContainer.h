@@ -13,10 +13,12 @@ public:
 	void reset();
 
 	void update(int deltaTime) override;
+	int getRedrawDelay() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
+	bool clipsChildren() const override { return true; }
 
 private:
-	Eigen::Vector2f getContentSize();
+	Eigen::Vector2f getContentSize() const;
 
 	Eigen::Vector2f mScrollPos;
 	Eigen::Vector2f mScrollDir;
@@ -137,6 +137,20 @@ void TextComponent::render(const Eigen::Affine3f& parentTrans)
 	}
 }
 
+Eigen::Vector4f TextComponent::getDrawBounds() const
+{
+	Eigen::Vector4f bounds = GuiComponent::getDrawBounds();
+	if(!mTextCache)
+		return bounds;
+
+	// text that doesn't fit is centered vertically and spills over, render() rounds its position
+	const Eigen::Vector2f& textSize = mTextCache->metrics.size;
+	const float top = (mSize.y() - textSize.y()) / 2.0f;
+	const Eigen::Vector4f text(std::min(0.0f, mSize.x() - textSize.x()) - 1, top - 1,
+		std::max(mSize.x(), textSize.x()) + 1, top + textSize.y() + 1);
+	return boundsUnion(bounds, text);
+}
+
 void TextComponent::calculateExtent()
 {
 	if(mAutoCalcExtent.x())
@@ -152,6 +166,7 @@ void TextComponent::calculateExtent()
 
 void TextComponent::onTextChanged()
 {
+	invalidateBounds();
 	calculateExtent();
 
 	if(!mFont || mText.empty())
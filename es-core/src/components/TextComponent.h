@@ -29,6 +29,7 @@ public:
 	void setRenderBackground(bool render);
 
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::Vector4f getDrawBounds() const override;
 
 	std::string getValue() const override;
 	void setValue(const std::string& value) override;
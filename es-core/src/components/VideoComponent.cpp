@@ -10,31 +10,45 @@
 #include "GuiComponent.h"
 #include "guis/GuiContext.h"
 #include "Settings.h"
+#include <sstream>
 
 #define FADE_TIME_MS	200
 
 void writeSubtitle(const char* gameName, const char* systemName, bool always)
 {
-	FILE* file = fopen(getVideoTitlePath().c_str(), "w");
+	std::stringstream ss;
 	if (always) {
-		fprintf(file, "1\n00:00:01,000 --> 00:00:30,000\n");
+		ss << "1\n00:00:01,000 --> 00:00:30,000\n";
 	}
 	else
 	{
-		fprintf(file, "1\n00:00:01,000 --> 00:00:08,000\n");
+		ss << "1\n00:00:01,000 --> 00:00:08,000\n";
 	}
-	fprintf(file, "%s\n", gameName);
-	fprintf(file, "<i>%s</i>\n\n", systemName);
+	ss << gameName << "\n";
+	ss << "<i>" << systemName << "</i>\n\n";
 
 	if (!always) {
-		fprintf(file, "2\n00:00:26,000 --> 00:00:30,000\n");
-		fprintf(file, "%s\n", gameName);
-		fprintf(file, "<i>%s</i>\n", systemName);
+		ss << "2\n00:00:26,000 --> 00:00:30,000\n";
+		ss << gameName << "\n";
+		ss << "<i>" << systemName << "</i>\n";
 	}
 
+	// Only the screensaver writes the title, and only when it changed
+	static std::string lastTitle;
+	const std::string path = getVideoTitlePath();
+	if (ss.str() == lastTitle && boost::filesystem::exists(path))
+		return;
+
+	boost::system::error_code ec;
+	boost::filesystem::create_directories(getVideoTitleFolder(), ec);
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == NULL)
+		return;
+	fprintf(file, "%s", ss.str().c_str());
 	fflush(file);
 	fclose(file);
 	file = NULL;
+	lastTitle = ss.str();
 }
 
 void VideoComponent::setScreensaverMode(bool isScreensaver)
@@ -54,6 +68,7 @@ VideoComponent::VideoComponent(Window* window) :
 	mDisable(false),
 	mScreensaverMode(false),
 	mTargetIsMax(false),
+	mSnapshotUntilFrame(false),
 	mOrigin(0, 0),
 	mTargetSize(0, 0)
 {
@@ -64,18 +79,12 @@ VideoComponent::VideoComponent(Window* window) :
 	if (mWindow->getGuiStackSize() > 1) {
 		topWindow(false);
 	}
-
-	std::string path = getVideoTitleFolder();
-	if(!boost::filesystem::exists(path))
-		boost::filesystem::create_directory(path);
 }
 
 VideoComponent::~VideoComponent()
 {
 	// Stop any currently running video
 	stopVideo();
-	// Delete subtitle file, if existing
-	remove(getVideoTitlePath().c_str());
 }
 
 void VideoComponent::setOrigin(float originX, float originY)
@@ -279,7 +288,7 @@ void VideoComponent::update(int deltaTime)
 
 	// If the video start is delayed and there is less than the fade time then set the image fade
 	// accordingly
-	if (mStartDelayed)
+	if (mStartDelayed && !mSnapshotUntilFrame)
 	{
 		Uint32 ticks = SDL_GetTicks();
 		if (mStartTime > ticks)
@@ -302,6 +311,14 @@ void VideoComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+int VideoComponent::getRedrawDelay() const
+{
+	// new frames arrive while playing, and the start delay is followed by a fade
+	if(mIsPlaying || mStartDelayed || mFadeIn < 1.0f)
+		return 0;
+	return GuiComponent::getRedrawDelay();
+}
+
 void VideoComponent::manageState()
 {
 	// We will only show if the component is on display and the screensaver
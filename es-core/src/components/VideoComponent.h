@@ -38,6 +38,10 @@ public:
 	// Configures the component to show the default video
 	void setDefaultVideo();
 
+	// Starts opening the videos likely to be shown next (the neighbours of the selected game), so
+	// they can start at once. Paths the component doesn't know how to pre-roll are ignored.
+	virtual void prerollVideos(const std::vector<std::string>& paths) { }
+
 	// sets whether it's going to render in screensaver mode
 	void setScreensaverMode(bool isScreensaver);
 
@@ -55,6 +59,8 @@ public:
 	void setOpacity(unsigned char opacity) override;
 
 	void render(const Eigen::Affine3f& parentTrans) override;
+	// the video and the snapshot size themselves once loaded, and the snapshot isn't a child
+	Eigen::Vector4f getDrawBounds() const override { return getUnboundedArea(); }
 	void renderSnapshot(const Eigen::Affine3f& parentTrans);
 
 	virtual void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
@@ -65,6 +71,7 @@ public:
 	Eigen::Vector2f getCenter() const;
 
 	virtual void update(int deltaTime);
+	int getRedrawDelay() const override;
 
 	// Resize the video to fit this size. If one axis is zero, scale that axis to maintain aspect ratio.
 	// If both are non-zero, potentially break the aspect ratio.  If both are zero, no resizing.
@@ -116,6 +123,9 @@ protected:
 	bool							mScreensaverActive;
 	bool							mScreensaverMode;
 	bool							mTargetIsMax;
+	// the snapshot stays up until the video shows its first frame instead of fading out at the
+	// end of the start delay
+	bool							mSnapshotUntilFrame;
 
 	Configuration					mConfig;
 };
@@ -7,38 +7,18 @@
 #include <codecvt>
 #endif
 #include "guis/GuiContext.h"
+#include "helpers/VlcMediaLoader.h"
 
 
-// VLC prepares to render a video frame.
-static void *lock(void *data, void **p_pixels) {
-	struct VideoContext *c = (struct VideoContext *)data;
-	SDL_LockMutex(c->mutex);
-	SDL_LockSurface(c->surface);
-	*p_pixels = c->surface->pixels;
-	return NULL; // Picture identifier, not needed here.
-}
-
-// VLC just rendered a video frame.
-static void unlock(void *data, void *id, void *const *p_pixels) {
-	struct VideoContext *c = (struct VideoContext *)data;
-	SDL_UnlockSurface(c->surface);
-	SDL_UnlockMutex(c->mutex);
-}
-
-// VLC wants to display a video frame.
-static void display(void *data, void *id) {
-	//Data to be displayed
-}
-
 VideoVlcComponent::VideoVlcComponent(gui::Context& guiContext) :
 	VideoComponent(guiContext.GetWindow()),
-	mMediaPlayer(nullptr)
+	mOpenRequest(0),
+	mRequestTicks(0),
+	mPrerolled(false),
+	mFirstFrameShown(false)
 {
 	m_context = &guiContext;
-	memset(&mContext, 0, sizeof(mContext));
-
-	// Get an empty texture for rendering the video
-	mTexture = TextureResource::get("");
+	mSnapshotUntilFrame = true;
 }
 
 VideoVlcComponent::~VideoVlcComponent()
@@ -64,9 +44,6 @@ void VideoVlcComponent::setMaxSize(float width, float height)
 
 void VideoVlcComponent::resize()
 {
-	if(!mTexture)
-		return;
-
 	const Eigen::Vector2f textureSize(mVideoWidth, mVideoHeight);
 
 	if(textureSize.isZero())
@@ -116,9 +93,6 @@ void VideoVlcComponent::resize()
 			}
 		}
 
-	// mSize.y() should already be rounded
-	mTexture->rasterizeAt((int)round(mSize.x()), (int)round(mSize.y()));
-
 	onSizeChanged();
 }
 
@@ -132,8 +106,17 @@ void VideoVlcComponent::render(const Eigen::Affine3f& parentTrans)
 
 	Renderer::setMatrix(trans);
 
-	if (mIsPlaying && mContext.valid)
+	if (mIsPlaying && mVideo && hasFrame())
 	{
+		// Fade in over the snapshot if the theme shows one, otherwise from black
+		const bool crossfade = (mFadeIn < 1.0f) && mConfig.showSnapshotDelay;
+		if (crossfade)
+		{
+			mStaticImage.setOpacity(255);
+			mStaticImage.render(parentTrans);
+			Renderer::setMatrix(trans);
+		}
+
 		float tex_offs_x = 0.0f;
 		float tex_offs_y = 0.0f;
 		float x2;
@@ -144,13 +127,8 @@ void VideoVlcComponent::render(const Eigen::Affine3f& parentTrans)
 		x2 = x+mSize.x();
 		y2 = y+mSize.y();
 
-		// Define a structure to contain the data for each vertex
-		struct Vertex
-		{
-			Eigen::Vector2f pos;
-			Eigen::Vector2f tex;
-			Eigen::Vector4f colour;
-		} vertices[6];
+		Renderer::Vertex vertices[6];
+		GLubyte colours[6 * 4];
 
 		// We need two triangles to cover the rectangular area
 		vertices[0].pos[0] = x; 			vertices[0].pos[1] = y;
@@ -173,70 +151,103 @@ void VideoVlcComponent::render(const Eigen::Affine3f& parentTrans)
 		// Colours - use this to fade the video in and out
 		for (int i = 0; i < (4 * 6); ++i) {
 			if ((i%4) < 3)
-				vertices[i / 4].colour[i % 4] = mFadeIn;
+				colours[i] = crossfade ? 255 : (GLubyte)(mFadeIn * 255.0f);
 			else
-				vertices[i / 4].colour[i % 4] = 1.0f;
+				colours[i] = crossfade ? (GLubyte)(mFadeIn * 255.0f) : 255;
 		}
 
-		glEnable(GL_TEXTURE_2D);
+		// Copy the frame into the texture if VLC wrote a new one since the last upload
+		SDL_LockMutex(mVideo->context.mutex);
+		const GLuint textureId = mTexture->update((const unsigned char*)mVideo->context.surface->pixels, mVideo->context.frameSequence);
+		SDL_UnlockMutex(mVideo->context.mutex);
+
+		// Render it, replacing what's underneath once faded in
+		if (crossfade)
+			Renderer::drawTriangles(vertices, colours, 6, textureId, GL_MODULATE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		else
+			Renderer::drawTriangles(vertices, colours, 6, textureId, GL_MODULATE, GL_ONE, GL_ZERO);
+	} else if (mIsPlaying && !mStartDelayed && (mOpenRequest || mVideo) && mConfig.showSnapshotDelay) {
+		// The file is still being opened or the first frame isn't decoded yet
+		mStaticImage.setOpacity(255);
+		mStaticImage.render(parentTrans);
+	} else {
+		VideoComponent::renderSnapshot(parentTrans);
+	}
+}
 
-		// Build a texture for the video frame
-		mTexture->initFromPixels((unsigned char*)mContext.surface->pixels, mContext.surface->w, mContext.surface->h);
-		mTexture->bind();
+void VideoVlcComponent::update(int deltaTime)
+{
+	VlcPlayerPool::getInstance()->update();
 
-		// Render it
-		glEnableClientState(GL_COLOR_ARRAY);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	if (mOpenRequest)
+	{
+		VlcMediaLoader::Media media;
+		if (VlcMediaLoader::getInstance()->take(mOpenRequest, media))
+		{
+			mOpenRequest = 0;
+			playMedia(media.media, media.width, media.height);
+		}
+	}
 
-		glColorPointer(4, GL_FLOAT, sizeof(Vertex), &vertices[0].colour);
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].tex);
+	VideoComponent::update(deltaTime);
 
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+	if (mVideo && !mFirstFrameShown && hasFrame())
+	{
+		VlcPlayerPool::getInstance()->recordFirstFrame(SDL_GetTicks() - mRequestTicks, mPrerolled);
+		mFirstFrameShown = true;
+	}
 
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+	// The fade in starts with the first frame
+	if (mOpenRequest || (mVideo && !mFirstFrameShown))
+		mFadeIn = 0.0f;
+}
 
-		glDisable(GL_TEXTURE_2D);
-	} else {
-		VideoComponent::renderSnapshot(parentTrans);
-	}
+bool VideoVlcComponent::hasFrame()
+{
+	return mVideo->hasFrame();
 }
 
-void VideoVlcComponent::setupContext()
+void VideoVlcComponent::prerollVideos(const std::vector<std::string>& paths)
 {
-	if (!mContext.valid)
+	// Screensaver videos are scaled to the screen, pre-rolls are decoded at their own size
+	if (mScreensaverMode)
+		return;
+
+	std::vector<std::string> vlcPaths;
+	for (auto it = paths.begin(); it != paths.end(); ++it)
 	{
-		// Create an RGBA surface to render the video into
-		mContext.surface = SDL_CreateRGBSurface(SDL_SWSURFACE, (int)mVideoWidth, (int)mVideoHeight, 32, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
-		mContext.mutex = SDL_CreateMutex();
-		mContext.valid = true;
-		resize();
+		if (!it->empty() && ResourceManager::getInstance()->fileExists(*it))
+		{
+			boost::filesystem::path fullPath = getCanonicalPath(*it);
+			fullPath.make_preferred();
+			vlcPaths.push_back(getVlcPath(fullPath));
+		}
 	}
+
+	libvlc_instance_t* vlcInstance = m_context ? m_context->GetVlcInstance() : nullptr;
+	VlcPlayerPool::getInstance()->preroll(vlcInstance, vlcPaths);
 }
 
-void VideoVlcComponent::freeContext()
+std::string VideoVlcComponent::getVlcPath(const boost::filesystem::path& path)
 {
-	if (mContext.valid)
-	{
-		SDL_FreeSurface(mContext.surface);
-		SDL_DestroyMutex(mContext.mutex);
-		mContext.valid = false;
-	}
+#ifdef WIN32
+	std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> wton;
+	return wton.to_bytes(path.c_str());
+#else
+	return std::string(path.c_str());
+#endif
 }
 
 void VideoVlcComponent::handleLooping()
 {
-	if (mIsPlaying && mMediaPlayer)
+	if (mIsPlaying && mVideo)
 	{
-		libvlc_state_t state = libvlc_media_player_get_state(mMediaPlayer);
+		libvlc_state_t state = libvlc_media_player_get_state(mVideo->player);
 		if (state == libvlc_Ended)
 		{
-			//libvlc_media_player_set_position(mMediaPlayer, 0.0f);
-			libvlc_media_player_set_media(mMediaPlayer, mMedia);
-			libvlc_media_player_play(mMediaPlayer);
+			//libvlc_media_player_set_position(mVideo->player, 0.0f);
+			libvlc_media_player_set_media(mVideo->player, mVideo->media);
+			libvlc_media_player_play(mVideo->player);
 		}
 	}
 }
@@ -247,97 +258,117 @@ void VideoVlcComponent::startVideo()
 		mVideoWidth = 0;
 		mVideoHeight = 0;
 
-#ifdef WIN32
-		std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> wton;
-		std::string path = wton.to_bytes(mVideoPath.c_str());
-#else
-		std::string path(mVideoPath.c_str());
-#endif
+		std::string path = getVlcPath(mVideoPath);
 		// Make sure we have a video path
 		libvlc_instance_t* vlcInstance = m_context ? m_context->GetVlcInstance() : nullptr;
 		if (vlcInstance && (path.size() > 0))
 		{
 			// Set the video that we are going to be playing so we don't attempt to restart it
 			mPlayingVideoPath = mVideoPath;
+			mRequestTicks = SDL_GetTicks();
+			mFirstFrameShown = false;
 
-			// Open the media
-			mMedia = libvlc_media_new_path(vlcInstance, path.c_str());
-			if (mMedia)
+			// A pre-rolled video only has to be resumed
+			std::unique_ptr<VlcVideo> video = VlcPlayerPool::getInstance()->takePrerolled(path, !Settings::getInstance()->getBool("VideoAudio"));
+			if (video && !mScreensaverMode)
 			{
-				unsigned 	track_count;
-				// Get the media metadata so we can find the aspect ratio
-				libvlc_media_parse(mMedia);
-				libvlc_media_track_t** tracks;
-				track_count = libvlc_media_tracks_get(mMedia, &tracks);
-				for (unsigned track = 0; track < track_count; ++track)
-				{
-					if (tracks[track]->i_type == libvlc_track_video)
-					{
-						mVideoWidth = tracks[track]->video->i_width;
-						mVideoHeight = tracks[track]->video->i_height;
-						break;
-					}
-				}
-				libvlc_media_tracks_release(tracks, track_count);
-
-				// Make sure we found a valid video track
-				if ((mVideoWidth > 0) && (mVideoHeight > 0))
-				{
-#ifndef _RPI_
-					if (mScreensaverMode)
-					{
-						if(!Settings::getInstance()->getBool("CaptionsCompatibility")) {
-
-							Eigen::Vector2f resizeScale((Renderer::getScreenWidth() / mVideoWidth), (Renderer::getScreenHeight() / mVideoHeight));
-
-							if(resizeScale.x() < resizeScale.y())
-							{
-								mVideoWidth *= resizeScale.x();
-								mVideoHeight *= resizeScale.x();
-							}else{
-								mVideoWidth *= resizeScale.y();
-								mVideoHeight *= resizeScale.y();
-							}
-							mVideoHeight = round(mVideoHeight);
-							mVideoWidth = round(mVideoWidth);
-						}
-					}
-#endif
-					setupContext();
+				mPrerolled = true;
+				showVideo(std::move(video));
+				return;
+			}
+			VlcPlayerPool::getInstance()->release(std::move(video));
+			mPrerolled = false;
+
+			// A file parsed before starts right away. Others are parsed in the background while the
+			// snapshot stays up, update() starts them once they're ready.
+			unsigned int width, height;
+			if (VlcMediaLoader::getInstance()->getVideoSize(path, width, height))
+			{
+				if ((width > 0) && (height > 0))
+					playMedia(libvlc_media_new_path(vlcInstance, path.c_str()), width, height);
+			}
+			else
+			{
+				mOpenRequest = VlcMediaLoader::getInstance()->open(vlcInstance, path);
+				mIsPlaying = true;
+				mFadeIn = 0.0f;
+			}
+		}
+	}
+}
+
+void VideoVlcComponent::playMedia(libvlc_media_t* media, unsigned int width, unsigned int height)
+{
+	if (!media)
+		return;
 
-					// Setup the media player
-					mMediaPlayer = libvlc_media_player_new_from_media(mMedia);
+	// Make sure we found a valid video track
+	if ((width == 0) || (height == 0))
+	{
+		libvlc_media_release(media);
+		return;
+	}
 
-					if (!Settings::getInstance()->getBool("VideoAudio"))
-					{
-						libvlc_audio_set_mute(mMediaPlayer, 1);
-					}
+#ifndef _RPI_
+	if (mScreensaverMode)
+	{
+		if(!Settings::getInstance()->getBool("CaptionsCompatibility")) {
 
-					libvlc_media_player_play(mMediaPlayer);
-					libvlc_video_set_callbacks(mMediaPlayer, lock, unlock, display, (void*)&mContext);
-					libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
+			Eigen::Vector2f resizeScale((Renderer::getScreenWidth() / width), (Renderer::getScreenHeight() / height));
 
-					// Update the playing state
-					mIsPlaying = true;
-					mFadeIn = 0.0f;
-				}
+			if(resizeScale.x() < resizeScale.y())
+			{
+				width = (unsigned int)round(width * resizeScale.x());
+				height = (unsigned int)round(height * resizeScale.x());
+			}else{
+				width = (unsigned int)round(width * resizeScale.y());
+				height = (unsigned int)round(height * resizeScale.y());
 			}
 		}
 	}
+#endif
+
+	// The screensaver shows the game's title, written by writeSubtitle
+	if (mScreensaverMode && Settings::getInstance()->getString("ScreenSaverGameInfo") != "never")
+		libvlc_media_add_option(media, (":sub-file=" + getVideoTitlePath()).c_str());
+
+	showVideo(VlcPlayerPool::getInstance()->play(media, getVlcPath(mVideoPath), width, height, !Settings::getInstance()->getBool("VideoAudio")));
+}
+
+void VideoVlcComponent::showVideo(std::unique_ptr<VlcVideo> video)
+{
+	mVideo = std::move(video);
+	mVideoWidth = mVideo->width;
+	mVideoHeight = mVideo->height;
+	if (mTexture)
+		mTexture->resize((size_t)mVideoWidth, (size_t)mVideoHeight);
+	else
+		mTexture = VideoTexture::create((size_t)mVideoWidth, (size_t)mVideoHeight);
+	resize();
+
+	// Update the playing state
+	mIsPlaying = true;
+	mFadeIn = 0.0f;
 }
 
 void VideoVlcComponent::stopVideo()
 {
 	mIsPlaying = false;
 	mStartDelayed = false;
-	// Release the media player so it stops calling back to us
-	if (mMediaPlayer)
+	// Drop a file that is still being opened
+	if (mOpenRequest)
 	{
-		libvlc_media_player_stop(mMediaPlayer);
-		libvlc_media_player_release(mMediaPlayer);
-		libvlc_media_release(mMedia);
-		mMediaPlayer = NULL;
-		freeContext();
+		VlcMediaLoader::getInstance()->cancel(mOpenRequest);
+		mOpenRequest = 0;
 	}
+	// Stop the player so it stops calling back to us, the pool keeps it for the next video. The
+	// texture stays for the next video too, until the component is hidden.
+	if (mVideo)
+		VlcPlayerPool::getInstance()->release(std::move(mVideo));
 }
 
+void VideoVlcComponent::onHide()
+{
+	VideoComponent::onHide();
+	mTexture.reset();
+}
@@ -7,13 +7,8 @@
 #include "VideoComponent.h"
 #include <vlc/vlc.h>
 #include <vlc/libvlc_media.h>
-#include "resources/TextureResource.h"
-
-struct VideoContext {
-	SDL_Surface*		surface;
-	SDL_mutex*			mutex;
-	bool				valid;
-};
+#include "resources/VideoTexture.h"
+#include "helpers/VlcPlayerPool.h"
 
 class VideoVlcComponent : public VideoComponent
 {
@@ -32,6 +27,9 @@ public:
 	virtual ~VideoVlcComponent();
 
 	void render(const Eigen::Affine3f& parentTrans) override;
+	void update(int deltaTime) override;
+	void prerollVideos(const std::vector<std::string>& paths) override;
+	void onHide() override;
 
 
 	// Resize the video to fit this size. If one axis is zero, scale that axis to maintain aspect ratio.
@@ -56,14 +54,23 @@ private:
 	// Handle looping the video. Must be called periodically
 	virtual void handleLooping();
 
-	void setupContext();
-	void freeContext();
+	// Plays an opened media, which this component owns from now on
+	void playMedia(libvlc_media_t* media, unsigned int width, unsigned int height);
+	// Shows a video that is playing
+	void showVideo(std::unique_ptr<VlcVideo> video);
+	// True once VLC decoded the first frame
+	bool hasFrame();
+
+	// The path as VLC takes it
+	static std::string getVlcPath(const boost::filesystem::path& path);
 
 private:
-	libvlc_media_t*					mMedia;
-	libvlc_media_player_t*			mMediaPlayer;
-	VideoContext					mContext;
-	std::shared_ptr<TextureResource> mTexture;
+	std::unique_ptr<VlcVideo>		mVideo;
+	std::shared_ptr<VideoTexture>	mTexture;
+	unsigned int					mOpenRequest; // VlcMediaLoader request while the file is opened, 0 otherwise
+	unsigned int					mRequestTicks; // when the video was started, for the time to first frame
+	bool							mPrerolled;
+	bool							mFirstFrameShown;
 };
 
 #endif
@@ -13,6 +13,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	int getRedrawDelay() const override { return 0; } // hold to configure timer
 	void onSizeChanged() override;
 
 private:
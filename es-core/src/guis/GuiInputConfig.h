@@ -14,6 +14,7 @@ public:
 	GuiInputConfig(Window* window, InputConfig* target, bool reconfigureAll, const std::function<void()>& okCallback);
 
 	void update(int deltaTime) override;
+	int getRedrawDelay() const override { return 0; } // hold timers and busy animation
 
 	void onSizeChanged() override;
 
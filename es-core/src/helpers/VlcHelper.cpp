@@ -1,24 +1,10 @@
 #include "VlcHelper.h"
 #include <vlc/vlc.h>
-#include "platform.h"
 
 void vlc::helper::InitVLC(libvlc_instance_t** vlcInstance)
 {
-	const std::string subtitles = getVideoTitlePath();
-	const char** args;
-	const char* newargs[] = { "--quiet", "--sub-file", subtitles.c_str() };
-	const char* singleargs[] = { "--quiet" };
-	int argslen = 0;
-
-	if (!subtitles.empty())
-	{
-		argslen = sizeof(newargs) / sizeof(newargs[ 0 ]);
-		args = newargs;
-	}
-	else
-	{
-		argslen = sizeof(singleargs) / sizeof(singleargs[ 0 ]);
-		args = singleargs;
-	}
-	*vlcInstance = libvlc_new(argslen, args);
-}
\ No newline at end of file
+	// The screensaver's game title is added to its own media (see VideoVlcComponent), an instance
+	// wide --sub-file would show it over every gamelist video too
+	const char* args[] = { "--quiet" };
+	*vlcInstance = libvlc_new(sizeof(args) / sizeof(args[ 0 ]), args);
+}
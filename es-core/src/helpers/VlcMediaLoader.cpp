@@ -0,0 +1,189 @@
+#include "helpers/VlcMediaLoader.h"
+
+namespace
+{
+	// sizes kept, more than a few gamelists of videos
+	const size_t k_maxSizes = 1024;
+}
+
+VlcMediaLoader* VlcMediaLoader::sInstance = nullptr;
+
+VlcMediaLoader* VlcMediaLoader::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new VlcMediaLoader();
+	return sInstance;
+}
+
+VlcMediaLoader::VlcMediaLoader() : mThread(nullptr), mExit(false), mNextId(1), mParsing(0), mParsingCancelled(false)
+{
+}
+
+bool VlcMediaLoader::getVideoSize(const std::string& path, unsigned int& width, unsigned int& height)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	auto it = mSizes.find(path);
+	if (it == mSizes.end())
+		return false;
+	width = it->second.width;
+	height = it->second.height;
+	mSizesUsed.splice(mSizesUsed.begin(), mSizesUsed, it->second.used);
+	return true;
+}
+
+unsigned int VlcMediaLoader::open(libvlc_instance_t* instance, const std::string& path, bool prefetch)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	Request request;
+	request.id = mNextId++;
+	if (mNextId == 0)
+		mNextId = 1;
+	request.instance = instance;
+	request.path = path;
+	if (prefetch)
+		mQueue.push_back(request);
+	else
+		mQueue.push_front(request);
+
+	if (mThread == nullptr && !mExit)
+		mThread = new std::thread(&VlcMediaLoader::threadProc, this);
+	mEvent.notify_one();
+	return request.id;
+}
+
+bool VlcMediaLoader::take(unsigned int request, Media& media)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	auto it = mDone.find(request);
+	if (it == mDone.end())
+		return false;
+	media = it->second;
+	mDone.erase(it);
+	return true;
+}
+
+void VlcMediaLoader::cancel(unsigned int request)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (auto it = mQueue.begin(); it != mQueue.end(); ++it)
+	{
+		if (it->id == request)
+		{
+			mQueue.erase(it);
+			return;
+		}
+	}
+
+	if (mParsing == request)
+	{
+		// the thread releases it once the parse returns
+		mParsingCancelled = true;
+		return;
+	}
+
+	auto it = mDone.find(request);
+	if (it != mDone.end())
+	{
+		if (it->second.media)
+			libvlc_media_release(it->second.media);
+		mDone.erase(it);
+	}
+}
+
+void VlcMediaLoader::deinit()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mExit = true;
+		mQueue.clear();
+	}
+	mEvent.notify_one();
+
+	if (mThread != nullptr)
+	{
+		mThread->join();
+		delete mThread;
+		mThread = nullptr;
+	}
+
+	for (auto& done : mDone)
+	{
+		if (done.second.media)
+			libvlc_media_release(done.second.media);
+	}
+	mDone.clear();
+}
+
+void VlcMediaLoader::storeVideoSize(const std::string& path, unsigned int width, unsigned int height)
+{
+	auto it = mSizes.find(path);
+	if (it != mSizes.end())
+	{
+		mSizesUsed.splice(mSizesUsed.begin(), mSizesUsed, it->second.used);
+	}
+	else
+	{
+		mSizesUsed.push_front(path);
+		it = mSizes.insert(std::make_pair(path, VideoSize())).first;
+		it->second.used = mSizesUsed.begin();
+	}
+	it->second.width = width;
+	it->second.height = height;
+
+	if (mSizes.size() > k_maxSizes)
+	{
+		mSizes.erase(mSizesUsed.back());
+		mSizesUsed.pop_back();
+	}
+}
+
+void VlcMediaLoader::threadProc()
+{
+	while (true)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEvent.wait(lock, [this] { return mExit || !mQueue.empty(); });
+			if (mExit)
+				return;
+			// only the newest selection of a fast scroll is still queued, the others were cancelled
+			request = mQueue.front();
+			mQueue.pop_front();
+			mParsing = request.id;
+			mParsingCancelled = false;
+		}
+
+		Media media = { libvlc_media_new_path(request.instance, request.path.c_str()), 0, 0 };
+		if (media.media)
+		{
+			libvlc_media_parse(media.media);
+			libvlc_media_track_t** tracks;
+			const unsigned int trackCount = libvlc_media_tracks_get(media.media, &tracks);
+			for (unsigned int track = 0; track < trackCount; ++track)
+			{
+				if (tracks[track]->i_type == libvlc_track_video)
+				{
+					media.width = tracks[track]->video->i_width;
+					media.height = tracks[track]->video->i_height;
+					break;
+				}
+			}
+			libvlc_media_tracks_release(tracks, trackCount);
+		}
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (media.media)
+			storeVideoSize(request.path, media.width, media.height);
+		if (mParsingCancelled)
+		{
+			if (media.media)
+				libvlc_media_release(media.media);
+		}
+		else
+		{
+			mDone[request.id] = media;
+		}
+		mParsing = 0;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <list>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vlc/vlc.h>
+
+// Opens and parses videos for VideoVlcComponent on a background thread: libvlc_media_parse reads
+// the file and can block for hundreds of milliseconds on an SD card or a network share.
+// The video size found for the most recently used files is kept, so a video that was opened
+// before starts without parsing again.
+class VlcMediaLoader
+{
+public:
+	struct Media
+	{
+		libvlc_media_t*	media;	// owned by whoever takes it, null if the file couldn't be opened
+		unsigned int	width;	// 0 if the file has no video track
+		unsigned int	height;
+	};
+
+	static VlcMediaLoader* getInstance();
+
+	// The video size of a file opened before. Returns false if it hasn't been parsed yet.
+	bool getVideoSize(const std::string& path, unsigned int& width, unsigned int& height);
+
+	// Queues a file to be opened and parsed, a video to be shown now (prefetch false) ahead of
+	// pre-rolls. Returns the request id for take() and cancel().
+	unsigned int open(libvlc_instance_t* instance, const std::string& path, bool prefetch = false);
+	// Hands over the media once the request is done, returns false while it is still pending
+	bool take(unsigned int request, Media& media);
+	// Drops a request. A media already opened for it is released.
+	void cancel(unsigned int request);
+
+	// Stops the background thread, waiting for a parse in progress, and releases the media nobody
+	// took. Must be called before the libvlc instance is released.
+	void deinit();
+
+private:
+	struct Request
+	{
+		unsigned int		id;
+		libvlc_instance_t*	instance;
+		std::string			path;
+	};
+
+	struct VideoSize
+	{
+		unsigned int						width;
+		unsigned int						height;
+		std::list<std::string>::iterator	used;	// position in mSizesUsed
+	};
+
+	VlcMediaLoader();
+
+	void threadProc();
+	// Remembers the size of a parsed file, forgetting the least recently used one past the limit.
+	// mMutex must be held.
+	void storeVideoSize(const std::string& path, unsigned int width, unsigned int height);
+
+	static VlcMediaLoader* sInstance;
+
+	std::thread*							mThread;
+	std::mutex								mMutex;
+	std::condition_variable					mEvent;
+	bool									mExit;
+	unsigned int							mNextId;
+	std::list<Request>						mQueue;
+	unsigned int							mParsing;	// request the thread is on, 0 if idle
+	bool									mParsingCancelled;
+	std::map<unsigned int, Media>			mDone;
+	std::map<std::string, VideoSize>		mSizes;
+	std::list<std::string>					mSizesUsed;	// most recently used first
+};
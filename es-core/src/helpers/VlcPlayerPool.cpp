@@ -0,0 +1,305 @@
+#include "helpers/VlcPlayerPool.h"
+#include "helpers/VlcMediaLoader.h"
+#include "resources/VideoTexture.h"
+#include "Settings.h"
+#include <algorithm>
+
+namespace
+{
+	// the next and the previous entry
+	const size_t k_maxPrerolls = 2;
+	// frames held by paused pre-rolls: one 1080p frame, or two up to 720p
+	const size_t k_maxPrerollBytes = 1920 * 1080 * 4;
+	// stopped players kept for reuse
+	const size_t k_maxIdle = 2;
+
+	// VLC prepares to render a video frame.
+	void* lock(void* data, void** p_pixels) {
+		VideoContext* c = (VideoContext*)data;
+		SDL_LockMutex(c->mutex);
+		SDL_LockSurface(c->surface);
+		*p_pixels = c->surface->pixels;
+		return NULL; // Picture identifier, not needed here.
+	}
+
+	// VLC just rendered a video frame.
+	void unlock(void* data, void* id, void* const* p_pixels) {
+		VideoContext* c = (VideoContext*)data;
+		c->frameSequence++;
+		VideoTexture::countDecodedFrame();
+		SDL_UnlockSurface(c->surface);
+		SDL_UnlockMutex(c->mutex);
+	}
+
+	// VLC wants to display a video frame.
+	void display(void* data, void* id) {
+		//Data to be displayed
+	}
+}
+
+VlcVideo::VlcVideo() : media(nullptr), player(nullptr), width(0), height(0)
+{
+	context.surface = nullptr;
+	context.mutex = SDL_CreateMutex();
+	context.frameSequence = 0;
+}
+
+VlcVideo::~VlcVideo()
+{
+	if (player)
+	{
+		libvlc_media_player_stop(player);
+		libvlc_media_player_release(player);
+	}
+	if (media)
+		libvlc_media_release(media);
+	if (context.surface)
+		SDL_FreeSurface(context.surface);
+	SDL_DestroyMutex(context.mutex);
+}
+
+bool VlcVideo::hasFrame()
+{
+	SDL_LockMutex(context.mutex);
+	const bool frame = context.frameSequence > 0;
+	SDL_UnlockMutex(context.mutex);
+	return frame;
+}
+
+VlcPlayerPool* VlcPlayerPool::sInstance = nullptr;
+
+VlcPlayerPool* VlcPlayerPool::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new VlcPlayerPool();
+	return sInstance;
+}
+
+VlcPlayerPool::VlcPlayerPool() : mStats(), mTotalMs(0)
+{
+}
+
+std::unique_ptr<VlcVideo> VlcPlayerPool::getIdle(unsigned int width, unsigned int height)
+{
+	std::unique_ptr<VlcVideo> video;
+	auto it = std::find_if(mIdle.begin(), mIdle.end(), [width, height](const std::unique_ptr<VlcVideo>& idle)
+		{ return idle->width == width && idle->height == height; });
+	if (it == mIdle.end() && !mIdle.empty())
+		it = mIdle.begin();
+
+	if (it != mIdle.end())
+	{
+		video = std::move(*it);
+		mIdle.erase(it);
+	}
+	else
+	{
+		video.reset(new VlcVideo());
+	}
+
+	if (video->width != width || video->height != height)
+	{
+		// Create an RGBA surface to render the video into
+		if (video->context.surface)
+			SDL_FreeSurface(video->context.surface);
+		video->context.surface = SDL_CreateRGBSurface(SDL_SWSURFACE, (int)width, (int)height, 32, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
+		video->width = width;
+		video->height = height;
+	}
+	video->context.frameSequence = 0;
+	return video;
+}
+
+std::unique_ptr<VlcVideo> VlcPlayerPool::play(libvlc_media_t* media, const std::string& path, unsigned int width, unsigned int height, bool mute)
+{
+	std::unique_ptr<VlcVideo> video = getIdle(width, height);
+	video->path = path;
+	video->media = media;
+
+	// Setup the media player, or point the reused one at the new media
+	if (video->player)
+		libvlc_media_player_set_media(video->player, media);
+	else
+		video->player = libvlc_media_player_new_from_media(media);
+
+	libvlc_audio_set_mute(video->player, mute ? 1 : 0);
+
+	// The callbacks must be in place before playback starts decoding
+	libvlc_video_set_callbacks(video->player, lock, unlock, display, (void*)&video->context);
+	libvlc_video_set_format(video->player, "RGBA", (int)width, (int)height, (int)width * 4);
+	libvlc_media_player_play(video->player);
+	return video;
+}
+
+std::unique_ptr<VlcVideo> VlcPlayerPool::takePrerolled(const std::string& path, bool mute)
+{
+	auto it = std::find_if(mPrerolls.begin(), mPrerolls.end(), [&path](const Preroll& preroll) { return preroll.path == path; });
+	if (it == mPrerolls.end())
+		return nullptr;
+
+	std::unique_ptr<VlcVideo> video = std::move(it->video);
+	const bool paused = it->paused;
+	// still being opened, the caller opens it as the selected video instead
+	dropPreroll(it);
+	if (!video)
+		return nullptr;
+
+	libvlc_audio_set_mute(video->player, mute ? 1 : 0);
+	if (paused)
+		libvlc_media_player_set_pause(video->player, 0);
+	return video;
+}
+
+void VlcPlayerPool::release(std::unique_ptr<VlcVideo> video)
+{
+	if (!video)
+		return;
+
+	// Stop the player so it stops calling back into the video
+	libvlc_media_player_stop(video->player);
+	libvlc_media_release(video->media);
+	video->media = nullptr;
+	video->path.clear();
+
+	mIdle.push_front(std::move(video));
+	while (mIdle.size() > k_maxIdle)
+		mIdle.pop_back();
+}
+
+std::list<VlcPlayerPool::Preroll>::iterator VlcPlayerPool::dropPreroll(std::list<Preroll>::iterator it)
+{
+	if (it->openRequest)
+		VlcMediaLoader::getInstance()->cancel(it->openRequest);
+	if (it->media)
+		libvlc_media_release(it->media);
+	release(std::move(it->video));
+	return mPrerolls.erase(it);
+}
+
+void VlcPlayerPool::preroll(libvlc_instance_t* instance, const std::vector<std::string>& paths)
+{
+	std::vector<std::string> wanted;
+	if (instance && Settings::getInstance()->getBool("VideoPreroll"))
+	{
+		for (auto it = paths.begin(); it != paths.end() && wanted.size() < k_maxPrerolls; ++it)
+		{
+			if (!it->empty() && std::find(wanted.begin(), wanted.end(), *it) == wanted.end())
+				wanted.push_back(*it);
+		}
+	}
+
+	for (auto it = mPrerolls.begin(); it != mPrerolls.end(); )
+	{
+		if (std::find(wanted.begin(), wanted.end(), it->path) == wanted.end())
+			it = dropPreroll(it);
+		else
+			++it;
+	}
+
+	for (auto path = wanted.begin(); path != wanted.end(); ++path)
+	{
+		if (std::find_if(mPrerolls.begin(), mPrerolls.end(), [&path](const Preroll& preroll) { return preroll.path == *path; }) != mPrerolls.end())
+			continue;
+
+		Preroll preroll;
+		preroll.path = *path;
+		preroll.openRequest = 0;
+		preroll.media = nullptr;
+		preroll.width = 0;
+		preroll.height = 0;
+		preroll.paused = false;
+
+		// a file parsed before doesn't need the loader
+		unsigned int width, height;
+		if (VlcMediaLoader::getInstance()->getVideoSize(*path, width, height))
+		{
+			if ((width == 0) || (height == 0) || ((size_t)width * height * 4 > k_maxPrerollBytes))
+				continue;
+			preroll.media = libvlc_media_new_path(instance, path->c_str());
+			preroll.width = width;
+			preroll.height = height;
+		}
+		else
+		{
+			preroll.openRequest = VlcMediaLoader::getInstance()->open(instance, *path, true);
+		}
+		mPrerolls.push_back(std::move(preroll));
+	}
+}
+
+void VlcPlayerPool::update()
+{
+	if (mPrerolls.empty())
+		return;
+
+	// Pause the pre-rolls that reached their first frame
+	bool decoding = false;
+	size_t frameBytes = 0;
+	for (auto it = mPrerolls.begin(); it != mPrerolls.end(); ++it)
+	{
+		if (!it->video)
+			continue;
+		frameBytes += it->video->width * it->video->height * 4;
+		if (!it->paused)
+		{
+			if (it->video->hasFrame())
+			{
+				libvlc_media_player_set_pause(it->video->player, 1);
+				it->paused = true;
+			}
+			else
+			{
+				decoding = true;
+			}
+		}
+	}
+
+	// Collect the opened files
+	for (auto it = mPrerolls.begin(); it != mPrerolls.end(); )
+	{
+		VlcMediaLoader::Media media;
+		if (it->openRequest && VlcMediaLoader::getInstance()->take(it->openRequest, media))
+		{
+			it->openRequest = 0;
+			it->media = media.media;
+			it->width = media.width;
+			it->height = media.height;
+			if (!it->media || (it->width == 0) || (it->height == 0))
+			{
+				it = dropPreroll(it);
+				continue;
+			}
+		}
+		++it;
+	}
+
+	// Start one at a time, so pre-rolls don't compete with the video on screen for the CPU
+	if (decoding)
+		return;
+	for (auto it = mPrerolls.begin(); it != mPrerolls.end(); ++it)
+	{
+		if (!it->media)
+			continue;
+
+		const size_t bytes = (size_t)it->width * it->height * 4;
+		if (frameBytes + bytes > k_maxPrerollBytes)
+		{
+			dropPreroll(it);
+			return;
+		}
+		it->video = play(it->media, it->path, it->width, it->height, true);
+		it->media = nullptr;
+		return;
+	}
+}
+
+void VlcPlayerPool::recordFirstFrame(unsigned int ms, bool prerolled)
+{
+	mStats.started++;
+	if (prerolled)
+		mStats.prerolled++;
+	mStats.lastMs = ms;
+	mStats.maxMs = std::max(mStats.maxMs, ms);
+	mTotalMs += ms;
+	mStats.averageMs = (unsigned int)(mTotalMs / mStats.started);
+}
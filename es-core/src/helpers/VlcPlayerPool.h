@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <SDL.h>
+#include <SDL_mutex.h>
+#include <vlc/vlc.h>
+
+struct VideoContext {
+	SDL_Surface*		surface;
+	SDL_mutex*			mutex;
+	unsigned int		frameSequence; // counts the frames written to surface, guarded by mutex
+};
+
+// A libvlc player decoding a video into memory
+struct VlcVideo
+{
+	VlcVideo();
+	~VlcVideo();
+
+	// True once VLC decoded the first frame
+	bool hasFrame();
+
+	std::string				path;
+	libvlc_media_t*			media;
+	libvlc_media_player_t*	player;
+	VideoContext			context;
+	unsigned int			width;
+	unsigned int			height;
+};
+
+// Keeps libvlc players for VideoVlcComponent: creating and releasing one on every selection change
+// costs more than the decoding. Stopped players are reused, and the videos next to the cursor are
+// opened ahead of time and paused on their first frame (pre-rolled), so selecting one of them only
+// swaps the player that is shown.
+// Pre-rolls are bounded: only a few at a time, within a frame memory budget, and only one decodes
+// its first frame at a time.
+class VlcPlayerPool
+{
+public:
+	struct Stats
+	{
+		unsigned int	started;	// videos that showed their first frame
+		unsigned int	prerolled;	// of which were pre-rolled
+		unsigned int	lastMs;		// time to first frame of the last one
+		unsigned int	averageMs;
+		unsigned int	maxMs;
+	};
+
+	static VlcPlayerPool* getInstance();
+
+	// Plays an opened media, owned by the video from now on, into a width x height frame
+	std::unique_ptr<VlcVideo> play(libvlc_media_t* media, const std::string& path, unsigned int width, unsigned int height, bool mute);
+	// Returns the video pre-rolled for path, playing again, or null if there is none
+	std::unique_ptr<VlcVideo> takePrerolled(const std::string& path, bool mute);
+	// Stops a video, its player is kept for the next one
+	void release(std::unique_ptr<VlcVideo> video);
+
+	// Sets the videos to pre-roll, most likely first. Pre-rolls not in the list are dropped.
+	void preroll(libvlc_instance_t* instance, const std::vector<std::string>& paths);
+	// Starts the opened pre-rolls and pauses them on their first frame. Called every frame.
+	void update();
+
+	// Time from asking for a video to its first frame on screen
+	void recordFirstFrame(unsigned int ms, bool prerolled);
+	const Stats& getStats() const { return mStats; }
+
+private:
+	struct Preroll
+	{
+		std::string					path;
+		unsigned int				openRequest; // VlcMediaLoader request while the file is opened
+		libvlc_media_t*				media;		 // opened, waiting for its turn to decode
+		unsigned int				width;
+		unsigned int				height;
+		std::unique_ptr<VlcVideo>	video;		 // playing or paused on its first frame
+		bool						paused;
+	};
+
+	VlcPlayerPool();
+
+	// A stopped video with a frame of the given size
+	std::unique_ptr<VlcVideo> getIdle(unsigned int width, unsigned int height);
+	std::list<Preroll>::iterator dropPreroll(std::list<Preroll>::iterator it);
+
+	static VlcPlayerPool* sInstance;
+
+	std::list<Preroll>						mPrerolls;
+	std::list<std::unique_ptr<VlcVideo>>	mIdle;
+	Stats									mStats;
+	unsigned long long						mTotalMs;
+};
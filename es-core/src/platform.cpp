@@ -6,6 +6,9 @@
 #include <fcntl.h>
 #include <chrono>
 #include <thread>
+#include <ctime>
+#include <vector>
+#include <algorithm>
 #ifdef WIN32
 #include <codecvt>
 #endif
@@ -54,6 +57,52 @@ std::string getVideoTitleFolder()
 	return home + "/.emulationstation/tmp/";
 }
 
+std::string getCacheFolder()
+{
+	std::string home = getHomePath();
+	return home + "/.emulationstation/cache/";
+}
+
+void trimCacheFolder(const std::string& folder, unsigned long long maxBytes)
+{
+	namespace fs = boost::filesystem;
+
+	struct CacheFile
+	{
+		fs::path path;
+		std::time_t modified;
+		unsigned long long size;
+	};
+
+	std::vector<CacheFile> files;
+	unsigned long long totalBytes = 0;
+	boost::system::error_code ec;
+	for (fs::directory_iterator it(folder, ec), end; !ec && it != end; it.increment(ec))
+	{
+		if (!fs::is_regular_file(it->status()))
+			continue;
+
+		boost::system::error_code timeEc, sizeEc;
+		CacheFile file = { it->path(), fs::last_write_time(it->path(), timeEc), fs::file_size(it->path(), sizeEc) };
+		if (timeEc || sizeEc)
+			continue;
+		files.push_back(file);
+		totalBytes += file.size;
+	}
+
+	if (totalBytes <= maxBytes)
+		return;
+
+	// oldest first; a cache file is rewritten whenever what it was made from changes
+	std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.modified < b.modified; });
+	for (auto it = files.begin(); it != files.end() && totalBytes > maxBytes; ++it)
+	{
+		fs::remove(it->path, ec);
+		if (!ec)
+			totalBytes -= it->size;
+	}
+}
+
 int runShutdownCommand()
 {
 #ifdef WIN32 // windows
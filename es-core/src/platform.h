@@ -20,6 +20,8 @@
 std::string getHomePath();
 std::string getVideoTitlePath();
 std::string getVideoTitleFolder();
+std::string getCacheFolder(); // ~/.emulationstation/cache/, for data we can always regenerate
+void trimCacheFolder(const std::string& folder, unsigned long long maxBytes); // deletes the oldest files until the folder fits in maxBytes
 
 
 int runShutdownCommand(); // shut down the system (returns 0 if successful)
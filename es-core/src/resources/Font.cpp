@@ -2,16 +2,261 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <list>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
 #include <boost/filesystem.hpp>
 #include "Renderer.h"
 #include "Log.h"
+#include "Settings.h"
 #include "Util.h"
 
+namespace fs = boost::filesystem;
+
+std::vector<std::string> getFallbackFontPaths();
+
+namespace
+{
+	const char k_cacheMagic[4] = { 'E', 'S', 'G', 'C' };
+	const unsigned int k_cacheVersion = 1;
+	// the glyph cache folder is cut back to this when the first font uses it, oldest first
+	const unsigned long long k_maxCacheBytes = 16 * 1024 * 1024;
+	// a font file nothing rasterized from for this long is closed
+	const std::chrono::seconds k_faceIdleTime(10);
+	// how often releaseIdleFaces() looks
+	const std::chrono::seconds k_faceCheckInterval(1);
+
+	// FNV-1a, for font files (hashed once when the font is created) and text layout keys
+	unsigned long long hashData(const unsigned char* data, size_t length, unsigned long long hash = 14695981039346656037ULL)
+	{
+		for(size_t i = 0; i < length; i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	const size_t k_layoutCacheSize = 64;
+	const size_t k_wrapCacheSize = 32;
+
+	template<typename T>
+	unsigned long long hashValue(const T& value, unsigned long long hash)
+	{
+		return hashData((const unsigned char*)&value, sizeof(value), hash);
+	}
+
+	unsigned long long hashText(const std::string& text)
+	{
+		return hashData((const unsigned char*)text.data(), text.length());
+	}
+
+	const double k_far = 1e20;
+
+	// squared euclidean distance transform of one row or column of grid, in place (Felzenszwalb and
+	// Huttenlocher). f, v and z are scratch space for length elements (z one more).
+	void distanceTransform(double* grid, int offset, int stride, int length, std::vector<double>& f, std::vector<int>& v, std::vector<double>& z)
+	{
+		for(int q = 0; q < length; q++)
+			f[q] = grid[offset + q * stride];
+
+		int k = 0;
+		v[0] = 0;
+		z[0] = -k_far;
+		z[1] = k_far;
+		for(int q = 1; q < length; q++)
+		{
+			double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+			while(s <= z[k])
+			{
+				k--;
+				s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = k_far;
+		}
+
+		k = 0;
+		for(int q = 0; q < length; q++)
+		{
+			while(z[k + 1] < q)
+				k++;
+			grid[offset + q * stride] = (q - v[k]) * (q - v[k]) + f[v[k]];
+		}
+	}
+
+	// Distance field of an antialiased glyph bitmap, padding pixels wider on each side. 128 is the
+	// outline and the values reach 0 / 255 padding pixels away from it. Partly covered pixels move the
+	// edge inside them, so the field keeps the antialiasing's precision.
+	void buildDistanceField(const unsigned char* bitmap, int width, int height, int pitch, int padding, std::vector<unsigned char>& field)
+	{
+		const int w = width + padding * 2;
+		const int h = height + padding * 2;
+
+		// squared distances to the outside and to the inside
+		std::vector<double> outer(w * h, k_far);
+		std::vector<double> inner(w * h, 0.0);
+		for(int y = 0; y < height; y++)
+		{
+			for(int x = 0; x < width; x++)
+			{
+				const double a = bitmap[y * pitch + x] / 255.0;
+				const int i = (y + padding) * w + x + padding;
+				if(a >= 1.0)
+				{
+					outer[i] = 0.0;
+					inner[i] = k_far;
+				}else if(a > 0.0)
+				{
+					const double d = 0.5 - a;
+					outer[i] = d > 0.0 ? d * d : 0.0;
+					inner[i] = d < 0.0 ? d * d : 0.0;
+				}
+			}
+		}
+
+		const int length = std::max(w, h);
+		std::vector<double> f(length);
+		std::vector<int> v(length);
+		std::vector<double> z(length + 1);
+		double* grids[] = { outer.data(), inner.data() };
+		for(double* grid : grids)
+		{
+			for(int x = 0; x < w; x++)
+				distanceTransform(grid, x, w, h, f, v, z);
+			for(int y = 0; y < h; y++)
+				distanceTransform(grid, y * w, 1, w, f, v, z);
+		}
+
+		field.resize(w * h);
+		for(int i = 0; i < w * h; i++)
+		{
+			const double distance = sqrt(outer[i]) - sqrt(inner[i]); // negative inside
+			const double value = 0.5 - distance / (2 * padding);
+			field[i] = (unsigned char)lround(std::min(std::max(value, 0.0), 1.0) * 255.0);
+		}
+	}
+
+	// the glyph set pre-warmed in the background: ASCII and Latin-1
+	bool isPrewarmChar(UnicodeChar id)
+	{
+		return (id >= 32 && id < 127) || (id >= 160 && id < 256);
+	}
+
+	struct PrewarmJob
+	{
+		std::pair<std::string, int> font;
+		ResourceData data;
+	};
+
+	struct PrewarmGlyph
+	{
+		UnicodeChar id;
+		Eigen::Vector2i size;
+		Eigen::Vector2f advance;
+		Eigen::Vector2f bearing;
+		std::vector<unsigned char> bitmap;
+	};
+
+	struct PrewarmResult
+	{
+		std::pair<std::string, int> font;
+		std::vector<PrewarmGlyph> glyphs;
+	};
+
+	std::thread* sPrewarmThread = nullptr;
+	std::mutex sPrewarmMutex;
+	std::condition_variable sPrewarmEvent;
+	bool sPrewarmExit = false;
+	std::list<PrewarmJob> sPrewarmJobs;
+	std::list<PrewarmResult> sPrewarmResults;
+	unsigned int sPrewarmPending = 0; // jobs whose result wasn't picked up yet, main thread only
+
+	void prewarmThreadProc()
+	{
+		// FreeType objects can't be used from two threads, this thread has its own library
+		FT_Library library = NULL;
+		if(FT_Init_FreeType(&library))
+		{
+			LOG(LogWarning) << "Error initializing FreeType for the font pre-warm thread, fonts are rasterized when drawn";
+			library = NULL;
+		}
+
+		while(true)
+		{
+			std::list<PrewarmJob> jobs;
+			{
+				std::unique_lock<std::mutex> lock(sPrewarmMutex);
+				sPrewarmEvent.wait(lock, [] { return sPrewarmExit || !sPrewarmJobs.empty(); });
+				if(sPrewarmExit)
+					break;
+				jobs.splice(jobs.begin(), sPrewarmJobs, sPrewarmJobs.begin());
+			}
+			const PrewarmJob& job = jobs.front();
+
+			PrewarmResult result;
+			result.font = job.font;
+
+			FT_Face face;
+			if(library && !FT_New_Memory_Face(library, job.data.ptr.get(), job.data.length, 0, &face))
+			{
+				FT_Set_Pixel_Sizes(face, 0, job.font.second);
+				for(UnicodeChar id = 32; id < 256; id++)
+				{
+					// characters missing from the font come from the fallback fonts when they're drawn
+					if(!isPrewarmChar(id) || FT_Get_Char_Index(face, id) == 0 || FT_Load_Char(face, id, FT_LOAD_RENDER))
+						continue;
+
+					const FT_GlyphSlot g = face->glyph;
+					PrewarmGlyph glyph;
+					glyph.id = id;
+					glyph.size << g->bitmap.width, g->bitmap.rows;
+					glyph.advance << (float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f;
+					glyph.bearing << (float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f;
+					glyph.bitmap.resize(glyph.size.x() * glyph.size.y());
+					for(int y = 0; y < glyph.size.y(); y++)
+						memcpy(&glyph.bitmap[y * glyph.size.x()], g->bitmap.buffer + y * g->bitmap.pitch, glyph.size.x());
+					result.glyphs.push_back(std::move(glyph));
+				}
+				FT_Done_Face(face);
+			}
+
+			std::unique_lock<std::mutex> lock(sPrewarmMutex);
+			sPrewarmResults.push_back(std::move(result));
+		}
+
+		if(library)
+			FT_Done_FreeType(library);
+	}
+
+	// the glyph cache folder, trimmed the first time a font asks for it
+	std::string getGlyphCacheFolder()
+	{
+		static const std::string folder = getCacheFolder() + "fonts/";
+		static bool trimmed = false;
+		if(!trimmed)
+		{
+			trimCacheFolder(folder, k_maxCacheBytes);
+			trimmed = true;
+		}
+		return folder;
+	}
+}
+
 FT_Library Font::sLibrary = NULL;
+unsigned long long Font::sTextCachesBuilt = 0;
 
 int Font::getSize() const { return mSize; }
 
 std::map< std::pair<std::string, int>, std::weak_ptr<Font> > Font::sFontMap;
+std::map< std::string, std::shared_ptr<Font::FontFace> > Font::sFaceMap;
+std::map< std::string, std::weak_ptr<Font::DistanceFieldAtlas> > Font::sDistanceFieldMap;
 
 
 // utf8 stuff
@@ -137,12 +382,11 @@ UnicodeChar Font::readUnicodeChar(const std::string& str, size_t& cursor)
 }
 
 
-Font::FontFace::FontFace(ResourceData&& d, int size) : data(d)
+Font::FontFace::FontFace(ResourceData&& d) : data(d), lastUsed(std::chrono::steady_clock::now())
 {
-	int err = FT_New_Memory_Face(sLibrary, data.ptr.get(), data.length, 0, &face);
-	assert(!err);
-	
-	FT_Set_Pixel_Sizes(face, 0, size);
+	if(FT_New_Memory_Face(sLibrary, data.ptr.get(), data.length, 0, &face))
+		face = NULL;
+	assert(face);
 }
 
 Font::FontFace::~FontFace()
@@ -151,6 +395,41 @@ Font::FontFace::~FontFace()
 		FT_Done_Face(face);
 }
 
+std::shared_ptr<Font::FontFace> Font::FontFace::get(const std::string& path)
+{
+	auto it = sFaceMap.find(path);
+	if(it != sFaceMap.end())
+		return it->second;
+
+	ResourceData data = ResourceManager::getInstance()->getFileData(path);
+	std::shared_ptr<FontFace> fontFace(new FontFace(std::move(data)));
+	sFaceMap[path] = fontFace;
+	return fontFace;
+}
+
+Font::FaceSize::FaceSize(const std::shared_ptr<FontFace>& f, int pixelSize) : fontFace(f), size(NULL)
+{
+	if(fontFace->face && !FT_New_Size(fontFace->face, &size))
+	{
+		FT_Activate_Size(size);
+		FT_Set_Pixel_Sizes(fontFace->face, 0, pixelSize);
+	}
+}
+
+Font::FaceSize::~FaceSize()
+{
+	// the face can outlive this Font, so its size is released here
+	if(size)
+		FT_Done_Size(size);
+}
+
+FT_Face Font::FaceSize::activate()
+{
+	if(size)
+		FT_Activate_Size(size);
+	return fontFace->face;
+}
+
 void Font::initLibrary()
 {
 	assert(sLibrary == NULL);
@@ -165,10 +444,7 @@ size_t Font::getMemUsage() const
 {
 	size_t memUsage = 0;
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
-		memUsage += it->textureSize.x() * it->textureSize.y() * 4;
-
-	for(auto it = mFaceCache.begin(); it != mFaceCache.end(); it++)
-		memUsage += it->second->data.length;
+		memUsage += (*it)->textureSize.x() * (*it)->textureSize.y() * 4 + (*it)->pixels.size();
 
 	return memUsage;
 }
@@ -190,23 +466,55 @@ size_t Font::getTotalMemUsage()
 		it++;
 	}
 
+	// font files are shared between sizes, count each once
+	for(auto faceIt = sFaceMap.begin(); faceIt != sFaceMap.end(); faceIt++)
+		total += faceIt->second->data.length;
+
+	auto atlasIt = sDistanceFieldMap.begin();
+	while(atlasIt != sDistanceFieldMap.end())
+	{
+		std::shared_ptr<DistanceFieldAtlas> atlas = atlasIt->second.lock();
+		if(!atlas)
+		{
+			atlasIt = sDistanceFieldMap.erase(atlasIt);
+			continue;
+		}
+
+		total += atlas->getMemUsage();
+		atlasIt++;
+	}
+
 	return total;
 }
 
-Font::Font(int size, const std::string& path) : mSize(size), mPath(path)
+Font::Font(int size, const std::string& path) : mCacheDirty(false), mPrewarmQueued(false), mPrewarmed(false),
+	mLayoutCache(k_layoutCacheSize), mWrapCache(k_wrapCacheSize), mGlyphScale(1.0f), mGlyphPadding(0.0f), mSize(size), mPath(path)
 {
 	assert(mSize > 0);
 	
 	mMaxGlyphHeight = 0;
+	std::fill(mGlyphLookup, mGlyphLookup + 256, (Glyph*)NULL);
 
 	if(!sLibrary)
 		initLibrary();
 
+	if(Settings::getInstance()->getBool("DistanceFieldFonts") && Renderer::supportsDistanceFields())
+	{
+		// the glyphs live in the shared atlas, there's nothing of this size to cache or pre-warm
+		mDistanceField = DistanceFieldAtlas::get(mPath);
+		mGlyphScale = (float)mSize / DistanceFieldAtlas::SIZE;
+		mGlyphPadding = DistanceFieldAtlas::PADDING * mGlyphScale;
+	}
+	else if(Settings::getInstance()->getBool("FontCache"))
+	{
+		mCachePath = getCachePath(ResourceManager::getInstance()->getFileData(mPath));
+		if(loadCache())
+			return;
+	}
+
 	// always initialize ASCII characters
 	for(UnicodeChar i = 32; i < 128; i++)
 		getGlyph(i);
-
-	clearFaceCache();
 }
 
 Font::~Font()
@@ -221,7 +529,18 @@ void Font::reload(std::shared_ptr<ResourceManager>& rm)
 
 void Font::unload(std::shared_ptr<ResourceManager>& rm)
 {
+	saveCache();
 	unloadTextures();
+	clearFaceCache();
+
+	// nothing will rasterize until the fonts are reloaded, close the files no other font holds
+	for(auto it = sFaceMap.begin(); it != sFaceMap.end(); )
+	{
+		if(it->second.use_count() == 1)
+			it = sFaceMap.erase(it);
+		else
+			it++;
+	}
 }
 
 std::shared_ptr<Font> Font::get(int size, const std::string& path)
@@ -246,7 +565,7 @@ void Font::unloadTextures()
 {
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
 	{
-		it->deinitTexture();
+		(*it)->deinitTexture();
 	}
 }
 
@@ -256,6 +575,7 @@ Font::FontTexture::FontTexture()
 	textureSize << 2048, 512;
 	writePos = Eigen::Vector2i::Zero();
 	rowHeight = 0;
+	linear = false;
 }
 
 Font::FontTexture::~FontTexture()
@@ -293,18 +613,58 @@ bool Font::FontTexture::findEmpty(const Eigen::Vector2i& size, Eigen::Vector2i&
 	return true;
 }
 
+void Font::FontTexture::writeGlyph(const Eigen::Vector2i& cursor, const Eigen::Vector2i& size, const unsigned char* bitmap, int pitch)
+{
+	if(size.x() <= 0 || size.y() <= 0)
+		return;
+
+	const size_t usedSize = (size_t)(cursor.y() + size.y()) * textureSize.x();
+	if(pixels.size() < usedSize)
+		pixels.resize(usedSize, 0);
+
+	for(int y = 0; y < size.y(); y++)
+		memcpy(&pixels[(cursor.y() + y) * textureSize.x() + cursor.x()], bitmap + y * pitch, size.x());
+
+	// uploaded with the rest of the page when the textures are rebuilt
+	if(textureId == 0)
+		return;
+
+	Renderer::bindTexture(textureId);
+	if(pitch == size.x())
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), size.x(), size.y(), GL_ALPHA, GL_UNSIGNED_BYTE, bitmap);
+	}else{
+		// GLES can't upload rows with a stride
+		std::vector<unsigned char> rows(size.x() * size.y());
+		for(int y = 0; y < size.y(); y++)
+			memcpy(&rows[y * size.x()], bitmap + y * pitch, size.x());
+		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), size.x(), size.y(), GL_ALPHA, GL_UNSIGNED_BYTE, rows.data());
+	}
+	Renderer::bindTexture(0);
+}
+
+void Font::FontTexture::uploadPixels()
+{
+	if(textureId == 0 || pixels.empty())
+		return;
+
+	Renderer::bindTexture(textureId);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureSize.x(), pixels.size() / textureSize.x(), GL_ALPHA, GL_UNSIGNED_BYTE, pixels.data());
+	Renderer::bindTexture(0);
+}
+
 void Font::FontTexture::initTexture()
 {
 	assert(textureId == 0);
 
 	glGenTextures(1, &textureId);
-	glBindTexture(GL_TEXTURE_2D, textureId);
+	Renderer::bindTexture(textureId);
 
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
 
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -316,17 +676,18 @@ void Font::FontTexture::deinitTexture()
 {
 	if(textureId != 0)
 	{
-		glDeleteTextures(1, &textureId);
+		Renderer::deleteTexture(textureId);
 		textureId = 0;
 	}
 }
 
-void Font::getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*& tex_out, Eigen::Vector2i& cursor_out)
+void Font::getTextureForNewGlyph(std::vector< std::unique_ptr<FontTexture> >& textures, bool linear, const Eigen::Vector2i& glyphSize,
+	FontTexture*& tex_out, Eigen::Vector2i& cursor_out)
 {
-	if(mTextures.size())
+	if(textures.size())
 	{
 		// check if the most recent texture has space
-		tex_out = &mTextures.back();
+		tex_out = textures.back().get();
 
 		// will this one work?
 		if(tex_out->findEmpty(glyphSize, cursor_out))
@@ -335,8 +696,9 @@ void Font::getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*&
 
 	// current textures are full,
 	// make a new one
-	mTextures.push_back(FontTexture());
-	tex_out = &mTextures.back();
+	textures.push_back(std::unique_ptr<FontTexture>(new FontTexture()));
+	tex_out = textures.back().get();
+	tex_out->linear = linear;
 	tex_out->initTexture();
 	
 	bool ok = tex_out->findEmpty(glyphSize, cursor_out);
@@ -401,30 +763,48 @@ std::vector<std::string> getFallbackFontPaths()
 }
 
 FT_Face Font::getFaceForChar(UnicodeChar id)
+{
+	return getFaceForChar(mFaceCache, mPath, mSize, id);
+}
+
+FT_Face Font::getFaceForChar(FaceCache& faceCache, const std::string& fontPath, int size, UnicodeChar id)
 {
 	static const std::vector<std::string> fallbackFonts = getFallbackFontPaths();
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
 	// look through our current font + fallback fonts to see if any have the glyph we're looking for
 	for(unsigned int i = 0; i < fallbackFonts.size() + 1; i++)
 	{
-		auto fit = mFaceCache.find(i);
+		auto fit = faceCache.find(i);
 
-		if(fit == mFaceCache.end()) // doesn't exist yet
+		if(fit == faceCache.end()) // doesn't exist yet
 		{
-			// i == 0 -> mPath
+			// i == 0 -> fontPath
 			// otherwise, take from fallbackFonts
-			const std::string& path = (i == 0 ? mPath : fallbackFonts.at(i - 1));
-			ResourceData data = ResourceManager::getInstance()->getFileData(path);
-			mFaceCache[i] = std::unique_ptr<FontFace>(new FontFace(std::move(data), mSize));
-			fit = mFaceCache.find(i);
+			const std::string& path = (i == 0 ? fontPath : fallbackFonts.at(i - 1));
+			faceCache[i] = std::unique_ptr<FaceSize>(new FaceSize(FontFace::get(path), size));
+			fit = faceCache.find(i);
 		}
 
-		if(FT_Get_Char_Index(fit->second->face, id) != 0)
-			return fit->second->face;
+		fit->second->fontFace->lastUsed = now;
+		const FT_Face face = fit->second->fontFace->face;
+		if(face && FT_Get_Char_Index(face, id) != 0)
+			return fit->second->activate();
 	}
 
 	// nothing has a valid glyph - return the "real" face so we get a "missing" character
-	return mFaceCache.begin()->second->face;
+	return faceCache.begin()->second->activate();
+}
+
+void Font::releaseIdleSizes(FaceCache& faceCache, const std::chrono::steady_clock::time_point& idleSince)
+{
+	for(auto it = faceCache.begin(); it != faceCache.end(); )
+	{
+		if(it->second->fontFace->lastUsed < idleSince)
+			it = faceCache.erase(it);
+		else
+			it++;
+	}
 }
 
 void Font::clearFaceCache()
@@ -432,14 +812,66 @@ void Font::clearFaceCache()
 	mFaceCache.clear();
 }
 
+void Font::releaseIdleFaces()
+{
+	static std::chrono::steady_clock::time_point nextCheck;
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if(sFaceMap.empty() || now < nextCheck)
+		return;
+	nextCheck = now + k_faceCheckInterval;
+
+	// the fonts let go of their sizes of idle faces first, then the faces only sFaceMap holds close
+	const std::chrono::steady_clock::time_point idleSince = now - k_faceIdleTime;
+	for(auto it = sFontMap.begin(); it != sFontMap.end(); it++)
+	{
+		std::shared_ptr<Font> font = it->second.lock();
+		if(font)
+			releaseIdleSizes(font->mFaceCache, idleSince);
+	}
+	for(auto it = sDistanceFieldMap.begin(); it != sDistanceFieldMap.end(); it++)
+	{
+		std::shared_ptr<DistanceFieldAtlas> atlas = it->second.lock();
+		if(atlas)
+			atlas->releaseIdleSizes(idleSince);
+	}
+
+	for(auto it = sFaceMap.begin(); it != sFaceMap.end(); )
+	{
+		if(it->second.use_count() == 1 && it->second->lastUsed < idleSince)
+			it = sFaceMap.erase(it);
+		else
+			it++;
+	}
+}
+
 Font::Glyph* Font::getGlyph(UnicodeChar id)
 {
 	// is it already loaded?
-	auto it = mGlyphMap.find(id);
-	if(it != mGlyphMap.end())
-		return &it->second;
+	if(id < 256)
+	{
+		if(mGlyphLookup[id])
+			return mGlyphLookup[id];
+	}else{
+		auto it = mGlyphMap.find(id);
+		if(it != mGlyphMap.end())
+			return &it->second;
+	}
 
 	// nope, need to make a glyph
+	if(mDistanceField)
+	{
+		const Glyph* source = mDistanceField->getGlyph(id);
+		if(source == NULL)
+			return NULL;
+
+		// same texture rectangle, scaled metrics
+		Glyph glyph = *source;
+		glyph.advance *= mGlyphScale;
+		glyph.bearing *= mGlyphScale;
+		const float height = (source->texSize.y() * source->texture->textureSize.y() - DistanceFieldAtlas::PADDING * 2) * mGlyphScale;
+		return &insertGlyph(id, glyph, height);
+	}
+
 	FT_Face face = getFaceForChar(id);
 	if(!face)
 	{
@@ -455,11 +887,16 @@ Font::Glyph* Font::getGlyph(UnicodeChar id)
 		return NULL;
 	}
 
-	Eigen::Vector2i glyphSize(g->bitmap.width, g->bitmap.rows);
+	return addGlyph(id, Eigen::Vector2i(g->bitmap.width, g->bitmap.rows), g->bitmap.buffer, g->bitmap.pitch,
+		Eigen::Vector2f((float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f),
+		Eigen::Vector2f((float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f));
+}
 
+Font::Glyph* Font::addGlyph(UnicodeChar id, const Eigen::Vector2i& glyphSize, const unsigned char* bitmap, int pitch, const Eigen::Vector2f& advance, const Eigen::Vector2f& bearing)
+{
 	FontTexture* tex = NULL;
 	Eigen::Vector2i cursor;
-	getTextureForNewGlyph(glyphSize, tex, cursor);
+	getTextureForNewGlyph(mTextures, false, glyphSize, tex, cursor);
 
 	// getTextureForNewGlyph can fail if the glyph is bigger than the max texture size (absurdly large font size)
 	if(tex == NULL)
@@ -469,99 +906,373 @@ Font::Glyph* Font::getGlyph(UnicodeChar id)
 	}
 
 	// create glyph
-	Glyph& glyph = mGlyphMap[id];
+	Glyph glyph;
 	
 	glyph.texture = tex;
 	glyph.texPos << cursor.x() / (float)tex->textureSize.x(), cursor.y() / (float)tex->textureSize.y();
 	glyph.texSize << glyphSize.x() / (float)tex->textureSize.x(), glyphSize.y() / (float)tex->textureSize.y();
 
-	glyph.advance << (float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f;
-	glyph.bearing << (float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f;
+	glyph.advance = advance;
+	glyph.bearing = bearing;
 
 	// upload glyph bitmap to texture
-	glBindTexture(GL_TEXTURE_2D, tex->textureId);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, g->bitmap.buffer);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	// update max glyph height
-	if(glyphSize.y() > mMaxGlyphHeight)
-		mMaxGlyphHeight = glyphSize.y();
+	tex->writeGlyph(cursor, glyphSize, bitmap, pitch);
 
 	// done
-	return &glyph;
+	return &insertGlyph(id, glyph, (float)glyphSize.y());
+}
+
+Font::Glyph& Font::insertGlyph(UnicodeChar id, const Glyph& source, float height)
+{
+	Glyph& glyph = mGlyphMap[id];
+	glyph = source;
+
+	if(id < 256)
+		mGlyphLookup[id] = &glyph;
+
+	// update max glyph height, the line height of every layout changes with it
+	const int glyphHeight = (int)ceilf(height);
+	if(glyphHeight > mMaxGlyphHeight)
+	{
+		mMaxGlyphHeight = glyphHeight;
+		mLayoutCache.clear();
+	}
+
+	mCacheDirty = true;
+	return glyph;
 }
 
-// completely recreate the texture data for all textures based on mGlyphs information
+// recreate the textures from the pages' pixels, FreeType isn't needed for that
 void Font::rebuildTextures()
 {
-	// recreate OpenGL textures
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
 	{
-		it->initTexture();
+		if((*it)->textureId == 0)
+			(*it)->initTexture();
+		(*it)->uploadPixels();
 	}
+}
 
-	// reupload the texture data
-	for(auto it = mGlyphMap.begin(); it != mGlyphMap.end(); it++)
+std::string Font::getCachePath(const ResourceData& data) const
+{
+	// glyphs missing from the font come from the fallback fonts, so those are part of the key too
+	static const std::vector<std::string> fallbackFonts = getFallbackFontPaths();
+	std::string fallbackKey;
+	for(auto it = fallbackFonts.begin(); it != fallbackFonts.end(); it++)
+		fallbackKey += *it + ";";
+
+	std::stringstream ss;
+	ss << getGlyphCacheFolder() << std::hex << hashData(data.ptr.get(), data.length) << "_"
+		<< std::hash<std::string>()(fallbackKey) << std::dec << "_" << mSize << ".glyphs";
+	return ss.str();
+}
+
+bool Font::loadCache()
+{
+	std::ifstream stream(mCachePath, std::ios::in | std::ios::binary);
+	if(!stream)
+		return false;
+
+	char magic[sizeof(k_cacheMagic)];
+	unsigned int header[6]; // version, size, pre-warmed, max glyph height, pages, glyphs
+	stream.read(magic, sizeof(magic));
+	stream.read((char*)header, sizeof(header));
+	if(!stream || memcmp(magic, k_cacheMagic, sizeof(magic)) != 0 || header[0] != k_cacheVersion || header[1] != (unsigned int)mSize)
+		return false;
+
+	std::vector< std::unique_ptr<FontTexture> > textures;
+	for(unsigned int i = 0; i < header[4]; i++)
 	{
-		FT_Face face = getFaceForChar(it->first);
-		FT_GlyphSlot glyphSlot = face->glyph;
+		int page[6]; // width, height, write position, row height, rows stored
+		stream.read((char*)page, sizeof(page));
+		if(!stream || page[0] <= 0 || page[1] <= 0 || page[5] < 0 || page[5] > page[1])
+			return false;
+
+		std::unique_ptr<FontTexture> tex(new FontTexture());
+		tex->textureSize << page[0], page[1];
+		tex->writePos << page[2], page[3];
+		tex->rowHeight = page[4];
+		tex->pixels.resize((size_t)page[0] * page[5]);
+		stream.read((char*)tex->pixels.data(), tex->pixels.size());
+		textures.push_back(std::move(tex));
+	}
 
-		// load the glyph bitmap through FT
-		FT_Load_Char(face, it->first, FT_LOAD_RENDER);
+	std::map<UnicodeChar, Glyph> glyphs;
+	for(unsigned int i = 0; i < header[5]; i++)
+	{
+		unsigned int idPage[2];
+		int rect[4];
+		float metrics[4]; // advance, bearing
+		stream.read((char*)idPage, sizeof(idPage));
+		stream.read((char*)rect, sizeof(rect));
+		stream.read((char*)metrics, sizeof(metrics));
+		if(!stream || idPage[1] >= textures.size())
+			return false;
+
+		FontTexture* tex = textures[idPage[1]].get();
+		const int rows = (int)(tex->pixels.size() / tex->textureSize.x());
+		if(rect[0] < 0 || rect[1] < 0 || rect[0] + rect[2] > tex->textureSize.x() || rect[1] + rect[3] > rows)
+			return false;
+
+		Glyph& glyph = glyphs[idPage[0]];
+		glyph.texture = tex;
+		glyph.texPos << rect[0] / (float)tex->textureSize.x(), rect[1] / (float)tex->textureSize.y();
+		glyph.texSize << rect[2] / (float)tex->textureSize.x(), rect[3] / (float)tex->textureSize.y();
+		glyph.advance << metrics[0], metrics[1];
+		glyph.bearing << metrics[2], metrics[3];
+	}
 
-		FontTexture* tex = it->second.texture;
-		
-		// find the position/size
-		Eigen::Vector2i cursor(it->second.texPos.x() * tex->textureSize.x(), it->second.texPos.y() * tex->textureSize.y());
-		Eigen::Vector2i glyphSize(it->second.texSize.x() * tex->textureSize.x(), it->second.texSize.y() * tex->textureSize.y());
-		
-		// upload to texture
-		glBindTexture(GL_TEXTURE_2D, tex->textureId);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, glyphSlot->bitmap.buffer);
+	mTextures = std::move(textures);
+	mGlyphMap = std::move(glyphs);
+	for(auto it = mGlyphMap.begin(); it != mGlyphMap.end() && it->first < 256; it++)
+		mGlyphLookup[it->first] = &it->second;
+	mMaxGlyphHeight = (int)header[3];
+	mPrewarmed = header[2] != 0;
+
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+	{
+		(*it)->initTexture();
+		(*it)->uploadPixels();
 	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	LOG(LogDebug) << "Loaded " << mGlyphMap.size() << " glyphs for font " << mPath << ", size " << mSize << " from the glyph cache";
+	return true;
 }
 
-void Font::renderTextCache(TextCache* cache)
+void Font::saveCache()
 {
-	if(cache == NULL)
+	if(!mCacheDirty || mCachePath.empty())
+		return;
+	mCacheDirty = false;
+
+	boost::system::error_code ec;
+	fs::create_directories(fs::path(mCachePath).parent_path(), ec);
+
+	// write to a temporary file first so a reader never sees half a cache
+	const std::string tempPath = mCachePath + ".tmp";
 	{
-		LOG(LogError) << "Attempted to draw NULL TextCache!";
+		std::ofstream stream(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if(!stream)
+			return;
+
+		const unsigned int header[6] = { k_cacheVersion, (unsigned int)mSize, mPrewarmed ? 1u : 0u, (unsigned int)mMaxGlyphHeight,
+			(unsigned int)mTextures.size(), (unsigned int)mGlyphMap.size() };
+		stream.write(k_cacheMagic, sizeof(k_cacheMagic));
+		stream.write((const char*)header, sizeof(header));
+
+		std::map<const FontTexture*, unsigned int> pageIndex;
+		for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+		{
+			const FontTexture& tex = **it;
+			const int page[6] = { tex.textureSize.x(), tex.textureSize.y(), tex.writePos.x(), tex.writePos.y(), tex.rowHeight,
+				(int)(tex.pixels.size() / tex.textureSize.x()) };
+			stream.write((const char*)page, sizeof(page));
+			stream.write((const char*)tex.pixels.data(), tex.pixels.size());
+			pageIndex[&tex] = (unsigned int)pageIndex.size();
+		}
+
+		for(auto it = mGlyphMap.begin(); it != mGlyphMap.end(); it++)
+		{
+			const Glyph& glyph = it->second;
+			const Eigen::Vector2i& textureSize = glyph.texture->textureSize;
+			const unsigned int idPage[2] = { (unsigned int)it->first, pageIndex[glyph.texture] };
+			const int rect[4] = { (int)lround(glyph.texPos.x() * textureSize.x()), (int)lround(glyph.texPos.y() * textureSize.y()),
+				(int)lround(glyph.texSize.x() * textureSize.x()), (int)lround(glyph.texSize.y() * textureSize.y()) };
+			const float metrics[4] = { glyph.advance.x(), glyph.advance.y(), glyph.bearing.x(), glyph.bearing.y() };
+			stream.write((const char*)idPage, sizeof(idPage));
+			stream.write((const char*)rect, sizeof(rect));
+			stream.write((const char*)metrics, sizeof(metrics));
+		}
+
+		if(!stream)
+		{
+			stream.close();
+			fs::remove(tempPath, ec);
+			return;
+		}
+	}
+
+	fs::rename(tempPath, mCachePath, ec);
+	if(ec)
+		fs::remove(tempPath, ec);
+}
+
+void Font::prewarm()
+{
+	if(mPrewarmQueued || mPrewarmed || mDistanceField)
 		return;
+	mPrewarmQueued = true;
+
+	PrewarmJob job = { std::make_pair(mPath, mSize), ResourceManager::getInstance()->getFileData(mPath) };
+	if(!job.data.ptr)
+		return;
+
+	std::unique_lock<std::mutex> lock(sPrewarmMutex);
+	if(sPrewarmExit)
+		return;
+	sPrewarmJobs.push_back(std::move(job));
+	sPrewarmPending++;
+	if(sPrewarmThread == nullptr)
+		sPrewarmThread = new std::thread(prewarmThreadProc);
+	sPrewarmEvent.notify_one();
+}
+
+void Font::updatePrewarm()
+{
+	std::list<PrewarmResult> results;
+	{
+		std::unique_lock<std::mutex> lock(sPrewarmMutex);
+		results.swap(sPrewarmResults);
 	}
 
-	for(auto it = cache->vertexLists.begin(); it != cache->vertexLists.end(); it++)
+	for(auto it = results.begin(); it != results.end(); it++)
 	{
-		assert(*it->textureIdPtr != 0);
+		sPrewarmPending--;
+
+		auto fontIt = sFontMap.find(it->font);
+		std::shared_ptr<Font> font = (fontIt != sFontMap.end()) ? fontIt->second.lock() : nullptr;
+		if(!font)
+			continue; // released before it was done
+
+		for(auto glyph = it->glyphs.begin(); glyph != it->glyphs.end(); glyph++)
+		{
+			if(font->mGlyphLookup[glyph->id] == NULL)
+				font->addGlyph(glyph->id, glyph->size, glyph->bitmap.data(), glyph->size.x(), glyph->advance, glyph->bearing);
+		}
+		font->mPrewarmed = true;
+		font->mCacheDirty = true;
+	}
+}
+
+bool Font::isPrewarming()
+{
+	return sPrewarmPending > 0;
+}
+
+void Font::stopPrewarm()
+{
+	{
+		std::unique_lock<std::mutex> lock(sPrewarmMutex);
+		sPrewarmExit = true;
+		sPrewarmJobs.clear();
+	}
+	sPrewarmEvent.notify_one();
+
+	if(sPrewarmThread != nullptr)
+	{
+		sPrewarmThread->join();
+		delete sPrewarmThread;
+		sPrewarmThread = nullptr;
+	}
+}
+
+std::shared_ptr<Font::DistanceFieldAtlas> Font::DistanceFieldAtlas::get(const std::string& path)
+{
+	auto it = sDistanceFieldMap.find(path);
+	if(it != sDistanceFieldMap.end())
+	{
+		std::shared_ptr<DistanceFieldAtlas> atlas = it->second.lock();
+		if(atlas)
+			return atlas;
+	}
+
+	std::shared_ptr<DistanceFieldAtlas> atlas(new DistanceFieldAtlas(path));
+	sDistanceFieldMap[path] = atlas;
+	ResourceManager::getInstance()->addReloadable(atlas);
+	return atlas;
+}
+
+Font::DistanceFieldAtlas::DistanceFieldAtlas(const std::string& path) : mPath(path)
+{
+}
+
+const Font::Glyph* Font::DistanceFieldAtlas::getGlyph(UnicodeChar id)
+{
+	auto it = mGlyphMap.find(id);
+	if(it != mGlyphMap.end())
+		return &it->second;
+
+	FT_Face face = getFaceForChar(mFaceCache, mPath, SIZE, id);
+	if(!face || FT_Load_Char(face, id, FT_LOAD_RENDER))
+	{
+		LOG(LogError) << "Could not find glyph for character " << id << " for font " << mPath << " (distance field)!";
+		return NULL;
+	}
+
+	const FT_GlyphSlot g = face->glyph;
+	std::vector<unsigned char> field;
+	buildDistanceField(g->bitmap.buffer, g->bitmap.width, g->bitmap.rows, g->bitmap.pitch, PADDING, field);
+	const Eigen::Vector2i glyphSize(g->bitmap.width + PADDING * 2, g->bitmap.rows + PADDING * 2);
+
+	FontTexture* tex = NULL;
+	Eigen::Vector2i cursor;
+	getTextureForNewGlyph(mTextures, true, glyphSize, tex, cursor);
+	if(tex == NULL)
+	{
+		LOG(LogError) << "Could not create glyph for character " << id << " for font " << mPath << " (distance field, no suitable texture found)!";
+		return NULL;
+	}
+
+	Glyph& glyph = mGlyphMap[id];
+	glyph.texture = tex;
+	glyph.texPos << cursor.x() / (float)tex->textureSize.x(), cursor.y() / (float)tex->textureSize.y();
+	glyph.texSize << glyphSize.x() / (float)tex->textureSize.x(), glyphSize.y() / (float)tex->textureSize.y();
+	glyph.advance << (float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f;
+	glyph.bearing << (float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f;
 
-		auto vertexList = *it;
+	tex->writeGlyph(cursor, glyphSize, field.data(), glyphSize.x());
+	return &glyph;
+}
 
-		glBindTexture(GL_TEXTURE_2D, *it->textureIdPtr);
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void Font::DistanceFieldAtlas::releaseIdleSizes(const std::chrono::steady_clock::time_point& idleSince)
+{
+	Font::releaseIdleSizes(mFaceCache, idleSince);
+}
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
+size_t Font::DistanceFieldAtlas::getMemUsage() const
+{
+	size_t memUsage = 0;
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+		memUsage += (*it)->textureSize.x() * (*it)->textureSize.y() * 4 + (*it)->pixels.size();
 
-		glVertexPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].pos.data());
-		glTexCoordPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].tex.data());
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, it->colors.data());
+	return memUsage;
+}
+
+void Font::DistanceFieldAtlas::unload(std::shared_ptr<ResourceManager>& rm)
+{
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+		(*it)->deinitTexture();
+	mFaceCache.clear();
+}
+
+void Font::DistanceFieldAtlas::reload(std::shared_ptr<ResourceManager>& rm)
+{
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+	{
+		if((*it)->textureId == 0)
+			(*it)->initTexture();
+		(*it)->uploadPixels();
+	}
+}
 
-		glDrawArrays(GL_TRIANGLES, 0, it->verts.size());
+void Font::renderTextCache(TextCache* cache)
+{
+	if(cache == NULL)
+	{
+		LOG(LogError) << "Attempted to draw NULL TextCache!";
+		return;
+	}
 
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+	for(auto it = cache->vertexLists.begin(); it != cache->vertexLists.end(); it++)
+	{
+		assert(*it->textureIdPtr != 0);
 
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		Renderer::drawTriangles(it->verts.data(), it->colors.data(), it->verts.size(), *it->textureIdPtr,
+			mDistanceField ? Renderer::TEXENV_DISTANCE_FIELD : Renderer::TEXENV_ALPHA);
 	}
 }
 
-Eigen::Vector2f Font::sizeText(std::string text, float lineSpacing)
+Eigen::Vector2f Font::sizeText(const std::string& text, float lineSpacing)
 {
 	float lineWidth = 0.0f;
 	float highestWidth = 0.0f;
@@ -604,29 +1315,36 @@ float Font::getLetterHeight()
 {
 	Glyph* glyph = getGlyph((UnicodeChar)'S');
 	assert(glyph);
-	return glyph->texSize.y() * glyph->texture->textureSize.y();
+	return glyph->texSize.y() * glyph->texture->textureSize.y() * mGlyphScale - mGlyphPadding * 2;
 }
 
 //the worst algorithm ever written
 //breaks up a normal string with newlines to make it fit xLen
-std::string Font::wrapText(std::string text, float xLen)
+std::string Font::wrapText(const std::string& text, float xLen)
 {
+	// descriptions are wrapped again every time their game is selected
+	const size_t hash = (size_t)hashValue(xLen, hashText(text));
+	const WrappedText* cached = mWrapCache.find(hash);
+	if(cached && cached->xLen == xLen && cached->text == text)
+		return cached->wrapped;
+
 	std::string out;
 
 	std::string line, word, temp;
+	size_t start = 0;
 	size_t space;
 
 	Eigen::Vector2f textSize;
 
-	while(text.length() > 0) //while there's text or we still have text to render
+	while(start < text.length()) //while there's text or we still have text to render
 	{
-		space = text.find_first_of(" \t\n");
+		space = text.find_first_of(" \t\n", start);
 		if (space == std::string::npos)
 		{
-			space = text.find_first_of("/\\");
+			space = text.find_first_of("/\\", start);
 			if (space == std::string::npos)
 			{
-				space = text.find_first_of(".");
+				space = text.find_first_of(".", start);
 				if (space == std::string::npos)
 				{
 					space = text.length() - 1;
@@ -634,8 +1352,8 @@ std::string Font::wrapText(std::string text, float xLen)
 			}
 		}
 
-		word = text.substr(0, space + 1);
-		text.erase(0, space + 1);
+		word = text.substr(start, space + 1 - start);
+		start = space + 1;
 
 		temp = line + word;
 
@@ -656,16 +1374,17 @@ std::string Font::wrapText(std::string text, float xLen)
 	// whatever's left should fit
 	out += line;
 
+	WrappedText wrapped = { text, xLen, out };
+	mWrapCache.insert(hash, std::move(wrapped));
 	return out;
 }
 
-Eigen::Vector2f Font::sizeWrappedText(std::string text, float xLen, float lineSpacing)
+Eigen::Vector2f Font::sizeWrappedText(const std::string& text, float xLen, float lineSpacing)
 {
-	text = wrapText(text, xLen);
-	return sizeText(text, lineSpacing);
+	return sizeText(wrapText(text, xLen), lineSpacing);
 }
 
-Eigen::Vector2f Font::getWrappedTextCursorOffset(std::string text, float xLen, size_t stop, float lineSpacing)
+Eigen::Vector2f Font::getWrappedTextCursorOffset(const std::string& text, float xLen, size_t stop, float lineSpacing)
 {
 	std::string wrappedText = wrapText(text, xLen);
 
@@ -737,6 +1456,55 @@ inline float font_round(float v)
 
 TextCache* Font::buildTextCache(const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
 {
+	unsigned long long hash = hashText(text);
+	hash = hashValue(offset.x(), hash);
+	hash = hashValue(offset.y(), hash);
+	hash = hashValue(xLen, hash);
+	hash = hashValue(alignment, hash);
+	hash = hashValue(lineSpacing, hash);
+
+	const TextLayout* layout = mLayoutCache.find((size_t)hash);
+	if(!layout || layout->text != text || layout->offset != offset || layout->xLen != xLen ||
+	   layout->alignment != alignment || layout->lineSpacing != lineSpacing)
+	{
+		TextLayout newLayout = { text, offset, xLen, alignment, lineSpacing };
+		const int maxGlyphHeight = mMaxGlyphHeight;
+		layoutText(newLayout);
+
+		// glyphs loaded for this text made the lines taller halfway through
+		if(mMaxGlyphHeight != maxGlyphHeight)
+			layoutText(newLayout);
+		layout = &mLayoutCache.insert((size_t)hash, std::move(newLayout));
+	}
+
+	sTextCachesBuilt++;
+	TextCache* cache = new TextCache();
+	cache->vertexLists.resize(layout->vertexLists.size());
+	cache->metrics = { layout->size };
+
+	for(unsigned int i = 0; i < layout->vertexLists.size(); i++)
+	{
+		TextCache::VertexList& vertList = cache->vertexLists.at(i);
+		const std::vector<Renderer::Vertex>& verts = layout->vertexLists.at(i).second;
+
+		vertList.textureIdPtr = &layout->vertexLists.at(i).first->textureId;
+		vertList.verts = verts;
+
+		vertList.colors.resize(4 * verts.size());
+		Renderer::buildGLColorArray(vertList.colors.data(), color, verts.size());
+	}
+
+	return cache;
+}
+
+void Font::layoutText(TextLayout& layout)
+{
+	const std::string& text = layout.text;
+	const Eigen::Vector2f& offset = layout.offset;
+	const float xLen = layout.xLen;
+	const Alignment alignment = layout.alignment;
+	const float lineSpacing = layout.lineSpacing;
+
 	float x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, 0, xLen, alignment) : 0);
 	
 	float yTop = getGlyph((UnicodeChar)'S')->bearing.y();
@@ -773,14 +1541,16 @@ TextCache* Font::buildTextCache(const std::string& text, Eigen::Vector2f offset,
 		verts.resize(oldVertSize + 6);
 		TextCache::Vertex* tri = verts.data() + oldVertSize;
 
-		const float glyphStartX = x + glyph->bearing.x();
-
+		// distance field glyphs are scaled and padded
 		const Eigen::Vector2i& textureSize = glyph->texture->textureSize;
+		const Eigen::Vector2f glyphSize(glyph->texSize.x() * textureSize.x() * mGlyphScale, glyph->texSize.y() * textureSize.y() * mGlyphScale);
+		const float glyphStartX = x + glyph->bearing.x() - mGlyphPadding;
+		const float glyphTopY = y - glyph->bearing.y() - mGlyphPadding;
 
 		// triangle 1
 		// round to fix some weird "cut off" text bugs
-		tri[0].pos << font_round(glyphStartX), font_round(y + (glyph->texSize.y() * textureSize.y() - glyph->bearing.y()));
-		tri[1].pos << font_round(glyphStartX + glyph->texSize.x() * textureSize.x()), font_round(y - glyph->bearing.y());
+		tri[0].pos << font_round(glyphStartX), font_round(glyphTopY + glyphSize.y());
+		tri[1].pos << font_round(glyphStartX + glyphSize.x()), font_round(glyphTopY);
 		tri[2].pos << tri[0].pos.x(), tri[1].pos.y();
 
 		//tri[0].tex << 0, 0;
@@ -804,27 +1574,8 @@ TextCache* Font::buildTextCache(const std::string& text, Eigen::Vector2f offset,
 		x += glyph->advance.x();
 	}
 
-	//TextCache::CacheMetrics metrics = { sizeText(text, lineSpacing) };
-
-	TextCache* cache = new TextCache();
-	cache->vertexLists.resize(vertMap.size());
-	cache->metrics = { sizeText(text, lineSpacing) };
-
-	unsigned int i = 0;
-	for(auto it = vertMap.begin(); it != vertMap.end(); it++)
-	{
-		TextCache::VertexList& vertList = cache->vertexLists.at(i);
-
-		vertList.textureIdPtr = &it->first->textureId;
-		vertList.verts = it->second;
-
-		vertList.colors.resize(4 * it->second.size());
-		Renderer::buildGLColorArray(vertList.colors.data(), color, it->second.size());
-	}
-
-	clearFaceCache();
-
-	return cache;
+	layout.vertexLists.assign(vertMap.begin(), vertMap.end());
+	layout.size = sizeText(text, lineSpacing);
 }
 
 TextCache* Font::buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color)
@@ -854,5 +1605,7 @@ std::shared_ptr<Font> Font::getFromTheme(const ThemeData::ThemeElement* elem, un
 	if(properties & FONT_PATH && elem->has("fontPath"))
 		path = elem->get<std::string>("fontPath");
 
-	return get(size, path);
+	font = get(size, path);
+	font->prewarm();
+	return font;
 }
@@ -1,13 +1,18 @@
 #pragma once
 
 #include <string>
+#include <list>
+#include <unordered_map>
+#include <chrono>
 #include "platform.h"
 #include GLHEADER
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_SIZES_H
 #include <Eigen/Dense>
 #include "resources/ResourceManager.h"
 #include "ThemeData.h"
+#include "Renderer.h"
 
 class TextCache;
 
@@ -38,14 +43,14 @@ public:
 
 	virtual ~Font();
 
-	Eigen::Vector2f sizeText(std::string text, float lineSpacing = 1.5f); // Returns the expected size of a string when rendered.  Extra spacing is applied to the Y axis.
+	Eigen::Vector2f sizeText(const std::string& text, float lineSpacing = 1.5f); // Returns the expected size of a string when rendered.  Extra spacing is applied to the Y axis.
 	TextCache* buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color);
 	TextCache* buildTextCache(const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment = ALIGN_LEFT, float lineSpacing = 1.5f);
 	void renderTextCache(TextCache* cache);
 	
-	std::string wrapText(std::string text, float xLen); // Inserts newlines into text to make it wrap properly.
-	Eigen::Vector2f sizeWrappedText(std::string text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
-	Eigen::Vector2f getWrappedTextCursorOffset(std::string text, float xLen, size_t cursor, float lineSpacing = 1.5f); // Returns the position of of the cursor after moving "cursor" characters.
+	std::string wrapText(const std::string& text, float xLen); // Inserts newlines into text to make it wrap properly.
+	Eigen::Vector2f sizeWrappedText(const std::string& text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
+	Eigen::Vector2f getWrappedTextCursorOffset(const std::string& text, float xLen, size_t cursor, float lineSpacing = 1.5f); // Returns the position of of the cursor after moving "cursor" characters.
 
 	float getHeight(float lineSpacing = 1.5f) const;
 	float getLetterHeight();
@@ -60,8 +65,22 @@ public:
 
 	static std::shared_ptr<Font> getFromTheme(const ThemeData::ThemeElement* elem, unsigned int properties, const std::shared_ptr<Font>& orig);
 
+	// Rasterizes ASCII and Latin-1 on a background thread, so the first screen using this font doesn't
+	// have to. Nothing is queued if the glyphs were already loaded from the disk cache.
+	void prewarm();
+	// Adds the glyphs rasterized in the background to their fonts, called once a frame
+	static void updatePrewarm();
+	static bool isPrewarming();
+	// Closes the font files no glyph was rasterized from for a while, called once a frame
+	static void releaseIdleFaces();
+	// Stops the pre-warm thread, waiting for the font it is on. Called on exit, nothing is
+	// pre-warmed afterwards.
+	static void stopPrewarm();
+
 	size_t getMemUsage() const; // returns an approximation of VRAM used by this font's texture (in bytes)
 	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by font textures (in bytes)
+	// Text caches built since startup. Each one allocates its vertex and color arrays.
+	static unsigned long long getTextCachesBuilt() { return sTextCachesBuilt; }
 
 	// utf8 stuff
 	static size_t getNextCursor(const std::string& str, size_t cursor);
@@ -71,6 +90,7 @@ public:
 
 private:
 	static FT_Library sLibrary;
+	static unsigned long long sTextCachesBuilt;
 	static std::map< std::pair<std::string, int>, std::weak_ptr<Font> > sFontMap;
 
 	Font(int size, const std::string& path);
@@ -83,33 +103,68 @@ private:
 		Eigen::Vector2i writePos;
 		int rowHeight;
 
+		bool linear; // filtered, for distance fields
+
+		// alpha of the rows used so far, so the page can be reuploaded and saved without FreeType
+		std::vector<unsigned char> pixels;
+
 		FontTexture();
 		~FontTexture();
 		bool findEmpty(const Eigen::Vector2i& size, Eigen::Vector2i& cursor_out);
 
+		// copies a glyph bitmap (pitch bytes per row) into pixels and the texture
+		void writeGlyph(const Eigen::Vector2i& cursor, const Eigen::Vector2i& size, const unsigned char* bitmap, int pitch);
+		void uploadPixels();
+
 		// you must call initTexture() after creating a FontTexture to get a textureId
 		void initTexture(); // initializes the OpenGL texture according to this FontTexture's settings, updating textureId
 		void deinitTexture(); // deinitializes the OpenGL texture if any exists, is automatically called in the destructor
 	};
 
+	// A font file opened by FreeType. Fallback fonts are several MB, so a file is loaded once and
+	// shared by every Font using it, each scaling it with its own FT_Size. sFaceMap keeps it open
+	// until no glyph was rasterized from it for a while (see releaseIdleFaces), then the fonts drop
+	// their sizes of it and the file is freed.
 	struct FontFace
 	{
 		const ResourceData data;
 		FT_Face face;
+		std::chrono::steady_clock::time_point lastUsed;
 
-		FontFace(ResourceData&& d, int size);
+		FontFace(ResourceData&& d);
 		virtual ~FontFace();
+
+		static std::shared_ptr<FontFace> get(const std::string& path);
+	};
+
+	// a shared face at the size of one Font
+	struct FaceSize
+	{
+		std::shared_ptr<FontFace> fontFace;
+		FT_Size size;
+
+		FaceSize(const std::shared_ptr<FontFace>& f, int pixelSize);
+		~FaceSize();
+		FT_Face activate(); // makes size the one glyphs are loaded at
 	};
 
+	static std::map< std::string, std::shared_ptr<FontFace> > sFaceMap;
+
 	void rebuildTextures();
 	void unloadTextures();
 
-	std::vector<FontTexture> mTextures;
+	// pointers so glyphs and TextCaches can keep pointing to a page when more are added
+	std::vector< std::unique_ptr<FontTexture> > mTextures;
 
-	void getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*& tex_out, Eigen::Vector2i& cursor_out);
+	static void getTextureForNewGlyph(std::vector< std::unique_ptr<FontTexture> >& textures, bool linear, const Eigen::Vector2i& glyphSize,
+		FontTexture*& tex_out, Eigen::Vector2i& cursor_out);
 
-	std::map< unsigned int, std::unique_ptr<FontFace> > mFaceCache;
+	typedef std::map< unsigned int, std::unique_ptr<FaceSize> > FaceCache;
+	FaceCache mFaceCache;
 	FT_Face getFaceForChar(UnicodeChar id);
+	static FT_Face getFaceForChar(FaceCache& faceCache, const std::string& path, int size, UnicodeChar id);
+	// drops the sizes of faces last used before idleSince
+	static void releaseIdleSizes(FaceCache& faceCache, const std::chrono::steady_clock::time_point& idleSince);
 	void clearFaceCache();
 
 	struct Glyph
@@ -123,9 +178,131 @@ private:
 		Eigen::Vector2f bearing;
 	};
 
+	// Distance field glyphs of one font file, rasterized once at a fixed size and shared by every size
+	// of it when the "DistanceFieldFonts" setting is on and the renderer can draw them. Glyph
+	// rectangles include the padding the distance spreads into.
+	class DistanceFieldAtlas : public IReloadable
+	{
+	public:
+		static const int SIZE = 48;
+		static const int PADDING = 6;
+
+		static std::shared_ptr<DistanceFieldAtlas> get(const std::string& path);
+
+		const Glyph* getGlyph(UnicodeChar id);
+		size_t getMemUsage() const;
+		void releaseIdleSizes(const std::chrono::steady_clock::time_point& idleSince);
+
+		void unload(std::shared_ptr<ResourceManager>& rm) override;
+		void reload(std::shared_ptr<ResourceManager>& rm) override;
+
+	private:
+		DistanceFieldAtlas(const std::string& path);
+
+		const std::string mPath;
+		FaceCache mFaceCache;
+		std::vector< std::unique_ptr<FontTexture> > mTextures;
+		std::map<UnicodeChar, Glyph> mGlyphMap;
+	};
+
+	static std::map< std::string, std::weak_ptr<DistanceFieldAtlas> > sDistanceFieldMap;
+
+	std::shared_ptr<DistanceFieldAtlas> mDistanceField;
+	float mGlyphScale; // from glyph texels to pixels at this size
+	float mGlyphPadding; // in pixels around each glyph's texture rectangle
+
 	std::map<UnicodeChar, Glyph> mGlyphMap;
+	Glyph* mGlyphLookup[256]; // mGlyphMap entries below 256, looked up for nearly every character drawn
 
 	Glyph* getGlyph(UnicodeChar id);
+	Glyph* addGlyph(UnicodeChar id, const Eigen::Vector2i& size, const unsigned char* bitmap, int pitch, const Eigen::Vector2f& advance, const Eigen::Vector2f& bearing);
+	Glyph& insertGlyph(UnicodeChar id, const Glyph& glyph, float height);
+
+	// Glyph atlas cache in ~/.emulationstation/cache/fonts, keyed by font file hash, size and glyph
+	// set. A font loaded from it doesn't rasterize anything it had before.
+	std::string getCachePath(const ResourceData& data) const;
+	bool loadCache();
+	void saveCache();
+
+	std::string mCachePath;
+	bool mCacheDirty; // glyphs were added since the cache was loaded or saved
+	bool mPrewarmQueued;
+	bool mPrewarmed; // ASCII and Latin-1 were rasterized in the background, saved with the cache
+
+	// The most recently used results, looked up by a hash of their key. Entries keep their key, so a
+	// hash collision is a miss.
+	template<typename T>
+	class RecentCache
+	{
+	public:
+		RecentCache(size_t capacity) : mCapacity(capacity) {}
+
+		T* find(size_t hash)
+		{
+			auto it = mLookup.find(hash);
+			if(it == mLookup.end())
+				return NULL;
+
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+			return &it->second->second;
+		}
+
+		T& insert(size_t hash, T&& value)
+		{
+			auto it = mLookup.find(hash);
+			if(it != mLookup.end())
+			{
+				mEntries.erase(it->second);
+			}else if(mEntries.size() >= mCapacity)
+			{
+				mLookup.erase(mEntries.back().first);
+				mEntries.pop_back();
+			}
+
+			mEntries.push_front(std::make_pair(hash, std::move(value)));
+			mLookup[hash] = mEntries.begin();
+			return mEntries.front().second;
+		}
+
+		void clear()
+		{
+			mEntries.clear();
+			mLookup.clear();
+		}
+
+	private:
+		typedef std::list< std::pair<size_t, T> > EntryList;
+
+		size_t mCapacity;
+		EntryList mEntries; // most recently used first
+		std::unordered_map<size_t, typename EntryList::iterator> mLookup;
+	};
+
+	// Laid out text, so strings shown again (list rows, a game's description) aren't decoded and
+	// measured again. Only the colors are built for each TextCache.
+	struct TextLayout
+	{
+		std::string text;
+		Eigen::Vector2f offset;
+		float xLen;
+		Alignment alignment;
+		float lineSpacing;
+
+		std::vector< std::pair< FontTexture*, std::vector<Renderer::Vertex> > > vertexLists;
+		Eigen::Vector2f size;
+	};
+
+	struct WrappedText
+	{
+		std::string text;
+		float xLen;
+		std::string wrapped;
+	};
+
+	RecentCache<TextLayout> mLayoutCache;
+	RecentCache<WrappedText> mWrapCache;
+
+	void layoutText(TextLayout& layout);
 
 	int mMaxGlyphHeight;
 	
@@ -144,11 +321,7 @@ private:
 class TextCache
 {
 protected:
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	};
+	typedef Renderer::Vertex Vertex;
 
 	struct VertexList
 	{
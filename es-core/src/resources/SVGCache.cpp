@@ -0,0 +1,232 @@
+#include "resources/SVGCache.h"
+#include "resources/ResourceManager.h"
+#include "Log.h"
+#include "platform.h"
+#include "nanosvg/nanosvg.h"
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+#define DPI 96
+
+namespace
+{
+	// Parsed documents kept in memory, a theme uses a few dozen
+	const size_t k_maxImages = 64;
+	// Rasterized bitmaps kept in memory, on top of the ones owned by live textures
+	const size_t k_maxBitmapBytes = 8 * 1024 * 1024;
+	// The disk cache is cut back to this at startup, oldest bitmaps first
+	const unsigned long long k_maxDiskBytes = 64 * 1024 * 1024;
+	const char k_diskMagic[4] = { 'E', 'S', 'V', 'G' };
+
+	std::time_t getModifiedTime(const std::string& path)
+	{
+		// embedded resources never change while we're running
+		if (path.empty() || path[0] == ':')
+			return 0;
+		boost::system::error_code ec;
+		std::time_t modified = fs::last_write_time(path, ec);
+		return ec ? 0 : modified;
+	}
+}
+
+SVGCache* SVGCache::sInstance = nullptr;
+std::mutex SVGCache::sInstanceMutex;
+
+SVGCache* SVGCache::getInstance()
+{
+	// the texture loader thread may be the first to ask
+	std::unique_lock<std::mutex> lock(sInstanceMutex);
+	if (sInstance == nullptr)
+		sInstance = new SVGCache();
+	return sInstance;
+}
+
+SVGCache::SVGCache() : mBitmapBytes(0), mDiskEnabled(true)
+{
+	mDiskFolder = getCacheFolder() + "svg/";
+	boost::system::error_code ec;
+	fs::create_directories(mDiskFolder, ec);
+	if (ec)
+	{
+		LOG(LogWarning) << "Could not create SVG cache folder " << mDiskFolder << ", disk cache disabled";
+		mDiskEnabled = false;
+		return;
+	}
+	trimCacheFolder(mDiskFolder, k_maxDiskBytes);
+}
+
+SVGCache::Image SVGCache::getImage(const std::string& path)
+{
+	const std::time_t modified = getModifiedTime(path);
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		auto it = mImages.find(path);
+		if (it != mImages.end() && it->second.modified == modified)
+		{
+			mImageLRU.splice(mImageLRU.begin(), mImageLRU, it->second.lruIt);
+			return it->second.image;
+		}
+	}
+
+	const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+	if (data.length == 0)
+		return Image();
+
+	// nsvgParse excepts a modifiable, null-terminated string
+	std::string copy((const char*)data.ptr.get(), data.length);
+	Image image;
+	image.contentHash = std::hash<std::string>()(copy);
+	image.svg = std::shared_ptr<NSVGimage>(nsvgParse(&copy[0], "px", DPI), nsvgDelete);
+	if (!image.svg)
+	{
+		LOG(LogError) << "Error parsing SVG image " << path;
+		return Image();
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	auto it = mImages.find(path);
+	if (it != mImages.end())
+	{
+		mImageLRU.splice(mImageLRU.begin(), mImageLRU, it->second.lruIt);
+	}
+	else
+	{
+		if (mImages.size() >= k_maxImages)
+		{
+			// textures still holding the oldest image keep it alive through their shared_ptr
+			mImages.erase(mImageLRU.back());
+			mImageLRU.pop_back();
+		}
+		mImageLRU.push_front(path);
+		it = mImages.insert(std::make_pair(path, ImageEntry())).first;
+		it->second.lruIt = mImageLRU.begin();
+	}
+	it->second.image = image;
+	it->second.modified = modified;
+	return image;
+}
+
+bool SVGCache::getBitmap(const std::string& path, const Image& image, size_t width, size_t height, std::vector<unsigned char>& dataRGBA)
+{
+	const BitmapKey key(path, image.contentHash, width, height);
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		auto it = mBitmaps.find(key);
+		if (it != mBitmaps.end())
+		{
+			dataRGBA = it->second.dataRGBA;
+			mBitmapLRU.splice(mBitmapLRU.begin(), mBitmapLRU, it->second.lruIt);
+			return true;
+		}
+	}
+
+	if (!mDiskEnabled || !readFromDisk(getDiskPath(path, image, width, height), width, height, dataRGBA))
+		return false;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	addToMemory(key, dataRGBA.data(), dataRGBA.size());
+	return true;
+}
+
+void SVGCache::putBitmap(const std::string& path, const Image& image, size_t width, size_t height, const unsigned char* dataRGBA)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		addToMemory(BitmapKey(path, image.contentHash, width, height), dataRGBA, width * height * 4);
+	}
+
+	if (mDiskEnabled)
+		writeToDisk(getDiskPath(path, image, width, height), width, height, dataRGBA);
+}
+
+void SVGCache::addToMemory(const BitmapKey& key, const unsigned char* dataRGBA, size_t size)
+{
+	// a single bitmap bigger than the whole budget is only worth keeping on disk
+	if (size > k_maxBitmapBytes)
+		return;
+
+	auto it = mBitmaps.find(key);
+	if (it != mBitmaps.end())
+	{
+		mBitmapBytes -= it->second.dataRGBA.size();
+		mBitmapLRU.erase(it->second.lruIt);
+		mBitmaps.erase(it);
+	}
+
+	while (!mBitmapLRU.empty() && mBitmapBytes + size > k_maxBitmapBytes)
+	{
+		auto oldest = mBitmaps.find(mBitmapLRU.back());
+		mBitmapBytes -= oldest->second.dataRGBA.size();
+		mBitmaps.erase(oldest);
+		mBitmapLRU.pop_back();
+	}
+
+	mBitmapLRU.push_front(key);
+	BitmapEntry& entry = mBitmaps[key];
+	entry.dataRGBA.assign(dataRGBA, dataRGBA + size);
+	entry.lruIt = mBitmapLRU.begin();
+	mBitmapBytes += size;
+}
+
+std::string SVGCache::getDiskPath(const std::string& path, const Image& image, size_t width, size_t height) const
+{
+	// the content hash is part of the name so an edited SVG never picks up an old bitmap
+	std::stringstream ss;
+	ss << mDiskFolder << std::hex << std::hash<std::string>()(path) << "_" << image.contentHash
+		<< std::dec << "_" << width << "x" << height << ".rgba";
+	return ss.str();
+}
+
+bool SVGCache::readFromDisk(const std::string& diskPath, size_t width, size_t height, std::vector<unsigned char>& dataRGBA) const
+{
+	std::ifstream stream(diskPath, std::ios::in | std::ios::binary);
+	if (!stream)
+		return false;
+
+	char magic[4];
+	unsigned int size[2];
+	stream.read(magic, sizeof(magic));
+	stream.read((char*)size, sizeof(size));
+	if (!stream || memcmp(magic, k_diskMagic, sizeof(magic)) != 0 || size[0] != width || size[1] != height)
+		return false;
+
+	dataRGBA.resize(width * height * 4);
+	stream.read((char*)dataRGBA.data(), dataRGBA.size());
+	if (stream.gcount() != (std::streamsize)dataRGBA.size())
+	{
+		dataRGBA.clear();
+		return false;
+	}
+	return true;
+}
+
+void SVGCache::writeToDisk(const std::string& diskPath, size_t width, size_t height, const unsigned char* dataRGBA) const
+{
+	// write to a temporary file first so a reader never sees half a bitmap
+	const std::string tempPath = diskPath + ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream)
+			return;
+
+		const unsigned int size[2] = { (unsigned int)width, (unsigned int)height };
+		stream.write(k_diskMagic, sizeof(k_diskMagic));
+		stream.write((const char*)size, sizeof(size));
+		stream.write((const char*)dataRGBA, width * height * 4);
+		if (!stream)
+		{
+			stream.close();
+			fs::remove(tempPath);
+			return;
+		}
+	}
+
+	boost::system::error_code ec;
+	fs::rename(tempPath, diskPath, ec);
+	if (ec)
+		fs::remove(tempPath, ec);
+}
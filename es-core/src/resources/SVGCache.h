@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <ctime>
+
+struct NSVGimage;
+
+// Caches parsed SVG documents per source path (the most recently used ones only) and the
+// bitmaps rasterized from them.
+// Bitmaps are keyed by (path, content hash, width, height) and kept in a small in-memory LRU as
+// well as in ~/.emulationstation/cache/svg so a restart or theme reload does not rasterize again.
+// All functions are thread safe; they are called from the texture loader thread.
+class SVGCache
+{
+public:
+	struct Image
+	{
+		std::shared_ptr<NSVGimage> svg;
+		size_t contentHash; // hash of the SVG source, so an edited file never picks up an old bitmap
+	};
+
+	static SVGCache* getInstance();
+
+	// Returns the parsed image for path, parsing it on first use or if the file changed.
+	// Returns an empty Image if the file could not be read or parsed.
+	Image getImage(const std::string& path);
+
+	// Looks up a bitmap in memory and then on disk. dataRGBA is width * height * 4 bytes, bottom-up.
+	bool getBitmap(const std::string& path, const Image& image, size_t width, size_t height, std::vector<unsigned char>& dataRGBA);
+	void putBitmap(const std::string& path, const Image& image, size_t width, size_t height, const unsigned char* dataRGBA);
+
+private:
+	SVGCache();
+
+	typedef std::tuple<std::string, size_t, size_t, size_t> BitmapKey; // path, content hash, width, height
+
+	struct ImageEntry
+	{
+		Image image;
+		std::time_t modified;
+		std::list<std::string>::iterator lruIt;
+	};
+
+	struct BitmapEntry
+	{
+		std::vector<unsigned char> dataRGBA;
+		std::list<BitmapKey>::iterator lruIt;
+	};
+
+	std::string getDiskPath(const std::string& path, const Image& image, size_t width, size_t height) const;
+	bool readFromDisk(const std::string& diskPath, size_t width, size_t height, std::vector<unsigned char>& dataRGBA) const;
+	void writeToDisk(const std::string& diskPath, size_t width, size_t height, const unsigned char* dataRGBA) const;
+	void addToMemory(const BitmapKey& key, const unsigned char* dataRGBA, size_t size);
+
+	static SVGCache* sInstance;
+	static std::mutex sInstanceMutex;
+
+	std::mutex								mMutex;
+	std::map<std::string, ImageEntry>		mImages;
+	std::list<std::string>					mImageLRU; // most recently used first
+	std::map<BitmapKey, BitmapEntry>		mBitmaps;
+	std::list<BitmapKey>					mBitmapLRU; // most recently used first
+	size_t									mBitmapBytes;
+	std::string								mDiskFolder;
+	bool									mDiskEnabled;
+};
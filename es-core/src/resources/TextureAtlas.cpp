@@ -0,0 +1,264 @@
+#include "resources/TextureAtlas.h"
+#include "Renderer.h"
+#include "Log.h"
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+	const int k_pageSize = 1024;
+	const size_t k_maxImageSize = 128;
+	// Each image gets a 1px border copied from its edges so linear filtering never samples a neighbour
+	const int k_padding = 1;
+	// Don't put an image on a shelf much taller than itself, start a new shelf instead
+	const float k_maxShelfWaste = 1.5f;
+}
+
+TextureAtlas* TextureAtlas::sInstance = nullptr;
+
+TextureAtlas* TextureAtlas::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new TextureAtlas();
+	return sInstance;
+}
+
+bool TextureAtlas::accepts(size_t width, size_t height)
+{
+	return (width > 0) && (height > 0) && (width <= k_maxImageSize) && (height <= k_maxImageSize);
+}
+
+bool TextureAtlas::add(const unsigned char* dataRGBA, size_t width, size_t height, Region& region)
+{
+	if (!accepts(width, height))
+		return false;
+
+	const Eigen::Vector2i paddedSize((int)width + k_padding * 2, (int)height + k_padding * 2);
+	Eigen::Vector2i pos;
+	int pageIndex = -1;
+	for (size_t i = 0; i < mPages.size(); i++)
+	{
+		if (mPages[i] && place(*mPages[i], paddedSize, pos))
+		{
+			pageIndex = (int)i;
+			break;
+		}
+	}
+
+	if (pageIndex < 0)
+	{
+		pageIndex = createPage();
+		if (pageIndex < 0 || !place(*mPages[pageIndex], paddedSize, pos))
+			return false;
+	}
+
+	// Build the padded image, extruding the edge pixels into the border
+	std::vector<unsigned char> padded(paddedSize.x() * paddedSize.y() * 4);
+	for (int y = 0; y < paddedSize.y(); y++)
+	{
+		const int srcY = std::min(std::max(y - k_padding, 0), (int)height - 1);
+		for (int x = 0; x < paddedSize.x(); x++)
+		{
+			const int srcX = std::min(std::max(x - k_padding, 0), (int)width - 1);
+			memcpy(&padded[(y * paddedSize.x() + x) * 4], &dataRGBA[(srcY * width + srcX) * 4], 4);
+		}
+	}
+
+	Page& page = *mPages[pageIndex];
+	Renderer::bindTexture(page.textureId);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x(), pos.y(), paddedSize.x(), paddedSize.y(), GL_RGBA, GL_UNSIGNED_BYTE, padded.data());
+	page.regionCount++;
+
+	region.page = pageIndex;
+	region.pos = pos + Eigen::Vector2i(k_padding, k_padding);
+	region.size << (int)width, (int)height;
+	return true;
+}
+
+void TextureAtlas::remove(Region& region)
+{
+	if (!region.valid())
+		return;
+
+	std::unique_lock<std::mutex> lock(mRemovedMutex);
+	mRemoved.push_back(region);
+	region = Region();
+}
+
+void TextureAtlas::applyRemovals()
+{
+	std::vector<Region> removed;
+	{
+		std::unique_lock<std::mutex> lock(mRemovedMutex);
+		removed.swap(mRemoved);
+	}
+
+	for (auto& region : removed)
+	{
+		std::unique_ptr<Page>& page = mPages[region.page];
+		if (page && --page->regionCount == 0)
+		{
+			Renderer::deleteTexture(page->textureId);
+			page.reset();
+		}
+		else if (page)
+		{
+			release(*page, region.pos - Eigen::Vector2i(k_padding, k_padding),
+				region.size + Eigen::Vector2i(k_padding * 2, k_padding * 2));
+		}
+	}
+}
+
+GLuint TextureAtlas::getTextureID(const Region& region) const
+{
+	return mPages[region.page]->textureId;
+}
+
+Eigen::Vector4f TextureAtlas::getTextureRect(const Region& region) const
+{
+	return Eigen::Vector4f(region.pos.x() / (float)k_pageSize, region.pos.y() / (float)k_pageSize,
+		region.size.x() / (float)k_pageSize, region.size.y() / (float)k_pageSize);
+}
+
+size_t TextureAtlas::getVRAMUsage() const
+{
+	return getPageCount() * k_pageSize * k_pageSize * 4;
+}
+
+size_t TextureAtlas::getPageCount() const
+{
+	size_t count = 0;
+	for (auto& page : mPages)
+	{
+		if (page)
+			count++;
+	}
+	return count;
+}
+
+bool TextureAtlas::place(Page& page, const Eigen::Vector2i& size, Eigen::Vector2i& pos_out)
+{
+	// Pick the shortest existing shelf that fits, in a hole or at its end. An empty shelf is
+	// free to take a shorter image, its height only matters to the shelves around it.
+	Shelf* best = nullptr;
+	std::vector<Span>::iterator bestHole;
+	for (auto& shelf : page.shelves)
+	{
+		const bool heightFits = shelf.height >= size.y() && (shelf.regionCount == 0 || shelf.height <= size.y() * k_maxShelfWaste);
+		if (!heightFits || (best != nullptr && shelf.height >= best->height))
+			continue;
+
+		auto hole = std::find_if(shelf.holes.begin(), shelf.holes.end(), [&size](const Span& span) { return span.width >= size.x(); });
+		if (hole != shelf.holes.end() || shelf.x + size.x() <= k_pageSize)
+		{
+			best = &shelf;
+			bestHole = hole;
+		}
+	}
+
+	if (best == nullptr)
+	{
+		if (page.usedHeight + size.y() > k_pageSize)
+			return false;
+
+		Shelf shelf = { page.usedHeight, size.y(), 0, 0, std::vector<Span>() };
+		page.shelves.push_back(shelf);
+		page.usedHeight += size.y();
+		best = &page.shelves.back();
+		bestHole = best->holes.end();
+	}
+
+	if (bestHole != best->holes.end())
+	{
+		pos_out << bestHole->x, best->y;
+		bestHole->x += size.x();
+		bestHole->width -= size.x();
+		if (bestHole->width == 0)
+			best->holes.erase(bestHole);
+	}
+	else
+	{
+		pos_out << best->x, best->y;
+		best->x += size.x();
+	}
+	best->regionCount++;
+	return true;
+}
+
+void TextureAtlas::release(Page& page, const Eigen::Vector2i& pos, const Eigen::Vector2i& size)
+{
+	auto shelf = std::find_if(page.shelves.begin(), page.shelves.end(), [&pos](const Shelf& s) { return s.y == pos.y(); });
+	if (shelf == page.shelves.end())
+		return;
+
+	if (--shelf->regionCount == 0)
+	{
+		shelf->x = 0;
+		shelf->holes.clear();
+
+		// empty shelves at the bottom of the page give their rows back
+		while (!page.shelves.empty() && page.shelves.back().regionCount == 0)
+		{
+			page.usedHeight -= page.shelves.back().height;
+			page.shelves.pop_back();
+		}
+		return;
+	}
+
+	// Add the hole, merged with the ones next to it. A hole reaching the end of the shelf
+	// just moves the end back.
+	Span span = { pos.x(), size.x() };
+	auto next = std::find_if(shelf->holes.begin(), shelf->holes.end(), [&span](const Span& h) { return h.x > span.x; });
+	if (next != shelf->holes.end() && span.x + span.width == next->x)
+	{
+		span.width += next->width;
+		next = shelf->holes.erase(next);
+	}
+	if (next != shelf->holes.begin() && std::prev(next)->x + std::prev(next)->width == span.x)
+	{
+		span.x = std::prev(next)->x;
+		span.width += std::prev(next)->width;
+		next = shelf->holes.erase(std::prev(next));
+	}
+
+	if (span.x + span.width == shelf->x)
+		shelf->x = span.x;
+	else
+		shelf->holes.insert(next, span);
+}
+
+int TextureAtlas::createPage()
+{
+	std::unique_ptr<Page> page(new Page());
+	page->usedHeight = 0;
+	page->regionCount = 0;
+
+	glGetError();
+	glGenTextures(1, &page->textureId);
+	Renderer::bindTexture(page->textureId);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, k_pageSize, k_pageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	if (glGetError() != GL_NO_ERROR)
+	{
+		LOG(LogError) << "Could not create texture atlas page";
+		Renderer::deleteTexture(page->textureId);
+		return -1;
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// reuse a slot freed by a deleted page
+	for (size_t i = 0; i < mPages.size(); i++)
+	{
+		if (!mPages[i])
+		{
+			mPages[i] = std::move(page);
+			return (int)i;
+		}
+	}
+	mPages.push_back(std::move(page));
+	return (int)mPages.size() - 1;
+}
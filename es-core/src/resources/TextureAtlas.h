@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <Eigen/Dense>
+#include "platform.h"
+#include GLHEADER
+
+// Packs small images (help prompt icons, arrows, switches, menu icons...) into shared
+// texture pages so drawing a menu doesn't rebind a texture for every icon.
+// Images are placed on shelves: rows of a fixed height filled left to right. The space of a
+// removed image is reused by the next one that fits in it, an empty shelf takes images of
+// any height again and a page is deleted once the last image on it is removed. Only used
+// from the render thread, except for remove().
+class TextureAtlas
+{
+public:
+	struct Region
+	{
+		Region() : page(-1) {}
+		bool valid() const { return page >= 0; }
+
+		int page;
+		Eigen::Vector2i pos;
+		Eigen::Vector2i size;
+	};
+
+	static TextureAtlas* getInstance();
+
+	// True if an image of this size is small enough to be worth packing
+	static bool accepts(size_t width, size_t height);
+
+	// Uploads the image into a page. Returns false if it could not be placed.
+	bool add(const unsigned char* dataRGBA, size_t width, size_t height, Region& region);
+	// Resets region and queues its space to be freed by applyRemovals(). Can be called from any
+	// thread, a texture may be deleted by the loader thread.
+	void remove(Region& region);
+	// Frees the space of the removed regions. Called once the queued draws that may still sample
+	// them have been flushed.
+	void applyRemovals();
+
+	GLuint getTextureID(const Region& region) const;
+	// The region in normalized page coordinates: x, y, width, height
+	Eigen::Vector4f getTextureRect(const Region& region) const;
+
+	size_t getVRAMUsage() const;
+	size_t getPageCount() const;
+
+private:
+	TextureAtlas() {}
+
+	struct Span
+	{
+		int x;
+		int width;
+	};
+
+	struct Shelf
+	{
+		int y;
+		int height;
+		int x; // first free column
+		int regionCount;
+		std::vector<Span> holes; // left by removed images, sorted by x, all before x
+	};
+
+	struct Page
+	{
+		GLuint textureId;
+		std::vector<Shelf> shelves;
+		int usedHeight;
+		int regionCount;
+	};
+
+	bool place(Page& page, const Eigen::Vector2i& size, Eigen::Vector2i& pos_out);
+	void release(Page& page, const Eigen::Vector2i& pos, const Eigen::Vector2i& size);
+	int createPage();
+
+	static TextureAtlas* sInstance;
+
+	std::vector< std::unique_ptr<Page> > mPages; // deleted pages leave a null slot so page indices stay valid
+	std::mutex mRemovedMutex;
+	std::vector<Region> mRemoved;
+};
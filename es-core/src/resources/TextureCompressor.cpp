@@ -0,0 +1,754 @@
+#include "resources/TextureCompressor.h"
+#include "resources/ResourceManager.h"
+#include "resources/TextureAtlas.h"
+#include "Renderer.h"
+#include "Settings.h"
+#include "ImageIO.h"
+#include "Log.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <climits>
+#include <cmath>
+#include <string.h>
+#include <boost/filesystem.hpp>
+
+#ifdef USE_OPENGL_DESKTOP
+	#include <SDL.h>
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_ETC1_RGB8_OES
+	#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+	#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+	#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	const char k_diskMagic[4] = { 'E', 'T', 'E', 'X' };
+	// The disk cache is cut back to this at startup, oldest textures first
+	const unsigned long long k_maxDiskBytes = 256 * 1024 * 1024;
+	// images remembered as not compressible, the list starts over when it is full
+	const size_t k_maxSkipped = 4096;
+
+#ifdef USE_OPENGL_DESKTOP
+	// Newer than OpenGL 1.1, so Windows only has it through the extension mechanism
+	PFNGLCOMPRESSEDTEXIMAGE2DPROC compressedTexImage2D = nullptr;
+#else
+	decltype(&glCompressedTexImage2D) compressedTexImage2D = &glCompressedTexImage2D;
+#endif
+
+	typedef unsigned char Block[16][4]; // 4x4 RGBA pixels, row by row
+
+	inline int clamp255(int value)
+	{
+		return std::min(std::max(value, 0), 255);
+	}
+
+	inline int square(int value)
+	{
+		return value * value;
+	}
+
+	size_t getBlockSize(GLenum glFormat)
+	{
+		return (glFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT || glFormat == GL_COMPRESSED_RGBA8_ETC2_EAC) ? 16 : 8;
+	}
+
+	// Copies a 4x4 block out of the image, repeating the edge pixels where the block overhangs it
+	void getBlock(const unsigned char* dataRGBA, size_t width, size_t height, size_t blockX, size_t blockY, Block& block)
+	{
+		for (size_t y = 0; y < 4; y++)
+		{
+			const size_t srcY = std::min(blockY * 4 + y, height - 1);
+			for (size_t x = 0; x < 4; x++)
+			{
+				const size_t srcX = std::min(blockX * 4 + x, width - 1);
+				memcpy(block[y * 4 + x], &dataRGBA[(srcY * width + srcX) * 4], 4);
+			}
+		}
+	}
+
+	bool hasAlpha(const unsigned char* dataRGBA, size_t width, size_t height)
+	{
+		for (size_t i = 0; i < width * height; i++)
+		{
+			if (dataRGBA[i * 4 + 3] != 255)
+				return true;
+		}
+		return false;
+	}
+
+	unsigned short toRGB565(const float color[3])
+	{
+		const int r = std::min(std::max((int)std::round(color[0] * 31 / 255), 0), 31);
+		const int g = std::min(std::max((int)std::round(color[1] * 63 / 255), 0), 63);
+		const int b = std::min(std::max((int)std::round(color[2] * 31 / 255), 0), 31);
+		return (unsigned short)((r << 11) | (g << 5) | b);
+	}
+
+	void fromRGB565(unsigned short color, int out[3])
+	{
+		const int r = (color >> 11) & 31;
+		const int g = (color >> 5) & 63;
+		const int b = color & 31;
+		out[0] = (r << 3) | (r >> 2);
+		out[1] = (g << 2) | (g >> 4);
+		out[2] = (b << 3) | (b >> 2);
+	}
+
+	// DXT1 colour block: the endpoints are the extremes of the colours along their principal axis
+	void encodeDXTColor(const Block& block, unsigned char* out)
+	{
+		float mean[3] = { 0, 0, 0 };
+		for (int i = 0; i < 16; i++)
+			for (int c = 0; c < 3; c++)
+				mean[c] += block[i][c] / 16.0f;
+
+		float cov[3][3] = { { 0 } };
+		for (int i = 0; i < 16; i++)
+		{
+			const float d[3] = { block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2] };
+			for (int a = 0; a < 3; a++)
+				for (int b = 0; b < 3; b++)
+					cov[a][b] += d[a] * d[b];
+		}
+
+		// a few rounds of power iteration are plenty for 16 pixels
+		float axis[3] = { 1, 1, 1 };
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[3];
+			for (int a = 0; a < 3; a++)
+				next[a] = cov[a][0] * axis[0] + cov[a][1] * axis[1] + cov[a][2] * axis[2];
+			const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+			if (length < 1e-6f)
+				break;
+			for (int a = 0; a < 3; a++)
+				axis[a] = next[a] / length;
+		}
+
+		float minT = 0, maxT = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			const float t = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		float end0[3], end1[3];
+		for (int c = 0; c < 3; c++)
+		{
+			end0[c] = mean[c] + axis[c] * maxT;
+			end1[c] = mean[c] + axis[c] * minT;
+		}
+
+		unsigned short color0 = toRGB565(end0);
+		unsigned short color1 = toRGB565(end1);
+		// color0 > color1 selects the 4 colour mode
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		unsigned int indices = 0;
+		if (color0 != color1)
+		{
+			int palette[4][3];
+			fromRGB565(color0, palette[0]);
+			fromRGB565(color1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0;
+				int bestError = INT_MAX;
+				for (int p = 0; p < 4; p++)
+				{
+					const int error = square(block[i][0] - palette[p][0]) + square(block[i][1] - palette[p][1]) + square(block[i][2] - palette[p][2]);
+					if (error < bestError)
+					{
+						bestError = error;
+						best = p;
+					}
+				}
+				indices |= (unsigned int)best << (i * 2);
+			}
+		}
+
+		out[0] = color0 & 0xFF;
+		out[1] = color0 >> 8;
+		out[2] = color1 & 0xFF;
+		out[3] = color1 >> 8;
+		for (int i = 0; i < 4; i++)
+			out[4 + i] = (indices >> (i * 8)) & 0xFF;
+	}
+
+	// DXT5 alpha block, using the 8 value mode between the block's min and max alpha
+	void encodeDXTAlpha(const Block& block, unsigned char* out)
+	{
+		int minAlpha = 255, maxAlpha = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minAlpha = std::min(minAlpha, (int)block[i][3]);
+			maxAlpha = std::max(maxAlpha, (int)block[i][3]);
+		}
+
+		unsigned long long indices = 0;
+		if (maxAlpha != minAlpha)
+		{
+			int palette[8] = { maxAlpha, minAlpha };
+			for (int i = 1; i < 7; i++)
+				palette[i + 1] = ((7 - i) * maxAlpha + i * minAlpha) / 7;
+
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0;
+				for (int p = 1; p < 8; p++)
+				{
+					if (abs(block[i][3] - palette[p]) < abs(block[i][3] - palette[best]))
+						best = p;
+				}
+				indices |= (unsigned long long)best << (i * 3);
+			}
+		}
+
+		out[0] = (unsigned char)maxAlpha;
+		out[1] = (unsigned char)minAlpha;
+		for (int i = 0; i < 6; i++)
+			out[2 + i] = (indices >> (i * 8)) & 0xFF;
+	}
+
+	const int k_etcModifiers[8][2] = { { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 } };
+
+	// Picks the modifier table (and each pixel's modifier) that best fits 8 pixels around base. Returns the error.
+	int fitETCSubblock(const Block& block, const int pixels[8], const int base[3], int& table, int codes[8])
+	{
+		int bestError = INT_MAX;
+		for (int t = 0; t < 8; t++)
+		{
+			int error = 0;
+			int tableCodes[8];
+			for (int p = 0; p < 8; p++)
+			{
+				const unsigned char* pixel = block[pixels[p]];
+				int bestPixelError = INT_MAX;
+				for (int code = 0; code < 4; code++)
+				{
+					// 0: +small, 1: +large, 2: -small, 3: -large
+					const int modifier = (code & 2) ? -k_etcModifiers[t][code & 1] : k_etcModifiers[t][code & 1];
+					const int pixelError = square(clamp255(base[0] + modifier) - pixel[0]) +
+						square(clamp255(base[1] + modifier) - pixel[1]) + square(clamp255(base[2] + modifier) - pixel[2]);
+					if (pixelError < bestPixelError)
+					{
+						bestPixelError = pixelError;
+						tableCodes[p] = code;
+					}
+				}
+				error += bestPixelError;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				table = t;
+				memcpy(codes, tableCodes, sizeof(tableCodes));
+			}
+		}
+		return bestError;
+	}
+
+	// ETC1 block, trying both subblock orientations and both base colour modes. Only ETC1 features
+	// are used, so the result is also a valid ETC2 RGB8 block.
+	void encodeETC1(const Block& block, unsigned char* out)
+	{
+		unsigned long long bestBits = 0;
+		int bestError = INT_MAX;
+
+		for (int flip = 0; flip < 2; flip++)
+		{
+			// flip 0: two 2x4 halves side by side, flip 1: two 4x2 halves on top of each other
+			int pixels[2][8];
+			int counts[2] = { 0, 0 };
+			for (int i = 0; i < 16; i++)
+			{
+				const int subblock = flip ? (i / 4 >= 2) : (i % 4 >= 2);
+				pixels[subblock][counts[subblock]++] = i;
+			}
+
+			float average[2][3] = { { 0 } };
+			for (int s = 0; s < 2; s++)
+				for (int p = 0; p < 8; p++)
+					for (int c = 0; c < 3; c++)
+						average[s][c] += block[pixels[s][p]][c] / 8.0f;
+
+			for (int differential = 1; differential >= 0; differential--)
+			{
+				int quantized[2][3], base[2][3];
+				bool representable = true;
+				for (int s = 0; s < 2; s++)
+				{
+					for (int c = 0; c < 3; c++)
+					{
+						if (differential)
+						{
+							quantized[s][c] = std::min(std::max((int)std::round(average[s][c] * 31 / 255), 0), 31);
+							base[s][c] = (quantized[s][c] << 3) | (quantized[s][c] >> 2);
+						}
+						else
+						{
+							quantized[s][c] = std::min(std::max((int)std::round(average[s][c] * 15 / 255), 0), 15);
+							base[s][c] = (quantized[s][c] << 4) | quantized[s][c];
+						}
+					}
+				}
+				if (differential)
+				{
+					for (int c = 0; c < 3; c++)
+					{
+						const int delta = quantized[1][c] - quantized[0][c];
+						if (delta < -4 || delta > 3)
+							representable = false;
+					}
+				}
+				if (!representable)
+					continue;
+
+				int tables[2];
+				int codes[2][8];
+				const int error = fitETCSubblock(block, pixels[0], base[0], tables[0], codes[0]) +
+					fitETCSubblock(block, pixels[1], base[1], tables[1], codes[1]);
+				if (error >= bestError)
+					continue;
+
+				unsigned long long bits = 0;
+				for (int c = 0; c < 3; c++)
+				{
+					if (differential)
+					{
+						const int delta = (quantized[1][c] - quantized[0][c]) & 7;
+						bits |= (unsigned long long)quantized[0][c] << (59 - c * 8);
+						bits |= (unsigned long long)delta << (56 - c * 8);
+					}
+					else
+					{
+						bits |= (unsigned long long)quantized[0][c] << (60 - c * 8);
+						bits |= (unsigned long long)quantized[1][c] << (56 - c * 8);
+					}
+				}
+				bits |= (unsigned long long)tables[0] << 37;
+				bits |= (unsigned long long)tables[1] << 34;
+				bits |= (unsigned long long)differential << 33;
+				bits |= (unsigned long long)flip << 32;
+
+				// pixel indices are stored column by column, most significant bits in the upper half
+				for (int s = 0; s < 2; s++)
+				{
+					for (int p = 0; p < 8; p++)
+					{
+						const int x = pixels[s][p] % 4;
+						const int y = pixels[s][p] / 4;
+						const int bit = x * 4 + y;
+						bits |= (unsigned long long)(codes[s][p] >> 1) << (16 + bit);
+						bits |= (unsigned long long)(codes[s][p] & 1) << bit;
+					}
+				}
+
+				bestError = error;
+				bestBits = bits;
+			}
+		}
+
+		for (int i = 0; i < 8; i++)
+			out[i] = (bestBits >> (56 - i * 8)) & 0xFF;
+	}
+
+	const int k_eacModifiers[16][8] = {
+		{ -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+		{ -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+		{ -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+		{ -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 }
+	};
+
+	// EAC alpha block for ETC2 RGBA8: for each table, stretch it over the block's alpha range
+	void encodeEACAlpha(const Block& block, unsigned char* out)
+	{
+		int minAlpha = 255, maxAlpha = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minAlpha = std::min(minAlpha, (int)block[i][3]);
+			maxAlpha = std::max(maxAlpha, (int)block[i][3]);
+		}
+
+		unsigned long long bestBits = 0;
+		int bestError = INT_MAX;
+		for (int t = 0; t < 16; t++)
+		{
+			const int tableMin = *std::min_element(k_eacModifiers[t], k_eacModifiers[t] + 8);
+			const int tableMax = *std::max_element(k_eacModifiers[t], k_eacModifiers[t] + 8);
+			const int multiplier = std::min(std::max((int)std::round((maxAlpha - minAlpha) / (float)(tableMax - tableMin)), 1), 15);
+			const int base = clamp255((int)std::round((maxAlpha + minAlpha) / 2.0f - multiplier * (tableMax + tableMin) / 2.0f));
+
+			int error = 0;
+			unsigned long long bits = ((unsigned long long)base << 56) | ((unsigned long long)multiplier << 52) | ((unsigned long long)t << 48);
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0;
+				int bestPixelError = INT_MAX;
+				for (int m = 0; m < 8; m++)
+				{
+					const int pixelError = abs(clamp255(base + k_eacModifiers[t][m] * multiplier) - block[i][3]);
+					if (pixelError < bestPixelError)
+					{
+						bestPixelError = pixelError;
+						best = m;
+					}
+				}
+				error += bestPixelError * bestPixelError;
+				const int pixel = (i % 4) * 4 + (i / 4); // column by column, first pixel in the top bits
+				bits |= (unsigned long long)best << (45 - pixel * 3);
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				bestBits = bits;
+			}
+		}
+
+		for (int i = 0; i < 8; i++)
+			out[i] = (bestBits >> (56 - i * 8)) & 0xFF;
+	}
+
+	std::time_t getModifiedTime(const std::string& path)
+	{
+		boost::system::error_code ec;
+		std::time_t modified = fs::last_write_time(path, ec);
+		return ec ? 0 : modified;
+	}
+}
+
+TextureCompressor* TextureCompressor::sInstance = nullptr;
+
+TextureCompressor* TextureCompressor::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new TextureCompressor();
+	return sInstance;
+}
+
+TextureCompressor::TextureCompressor() : mFormat(FORMAT_NONE), mSettingEnabled(false), mDiskEnabled(true), mThread(nullptr), mExit(false)
+{
+	mDiskFolder = getCacheFolder() + "textures/";
+	boost::system::error_code ec;
+	fs::create_directories(mDiskFolder, ec);
+	if (ec)
+	{
+		LOG(LogWarning) << "Could not create texture cache folder " << mDiskFolder << ", texture compression disabled";
+		mDiskEnabled = false;
+		return;
+	}
+	trimCacheFolder(mDiskFolder, k_maxDiskBytes);
+}
+
+void TextureCompressor::init()
+{
+	Format format = FORMAT_NONE;
+
+#ifdef USE_OPENGL_DESKTOP
+	compressedTexImage2D = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)SDL_GL_GetProcAddress("glCompressedTexImage2D");
+#endif
+
+	if (compressedTexImage2D != nullptr)
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+		std::vector<GLint> formats(std::max(count, 0));
+		if (count > 0)
+			glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+		auto supported = [&formats] (GLenum glFormat) { return std::find(formats.begin(), formats.end(), (GLint)glFormat) != formats.end(); };
+
+		// Desktop drivers often list ETC2 only to decompress it on upload, so DXT goes first
+		if (supported(GL_COMPRESSED_RGB_S3TC_DXT1_EXT) && supported(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT))
+			format = FORMAT_DXT;
+		else if (supported(GL_COMPRESSED_RGB8_ETC2) && supported(GL_COMPRESSED_RGBA8_ETC2_EAC))
+			format = FORMAT_ETC2;
+		else if (supported(GL_ETC1_RGB8_OES))
+			format = FORMAT_ETC1;
+	}
+
+	mFormat = format;
+	mSettingEnabled = Settings::getInstance()->getBool("CompressTextures");
+	LOG(LogInfo) << "Texture compression: " << getFormatName(format);
+}
+
+void TextureCompressor::deinit()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mExit = true;
+		mQueue.clear();
+	}
+	mEvent.notify_one();
+
+	if (mThread != nullptr)
+	{
+		mThread->join();
+		delete mThread;
+		mThread = nullptr;
+	}
+}
+
+const char* TextureCompressor::getFormatName(Format format)
+{
+	switch (format)
+	{
+		case FORMAT_DXT:	return "DXT1/DXT5";
+		case FORMAT_ETC2:	return "ETC2/EAC";
+		case FORMAT_ETC1:	return "ETC1";
+		default:			return "none";
+	}
+}
+
+bool TextureCompressor::enabled() const
+{
+	return (mFormat != FORMAT_NONE) && mDiskEnabled && mSettingEnabled;
+}
+
+bool TextureCompressor::compress(Format format, const unsigned char* dataRGBA, size_t width, size_t height, Image& image)
+{
+	if (format == FORMAT_NONE || width == 0 || height == 0)
+		return false;
+
+	// ETC1 has no alpha. Keeping it in a second texture would need multitexturing everywhere
+	// images are drawn, so those images are left uncompressed instead.
+	const bool alpha = hasAlpha(dataRGBA, width, height);
+	if (alpha && format == FORMAT_ETC1)
+		return false;
+
+	switch (format)
+	{
+		case FORMAT_DXT:	image.glFormat = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+		case FORMAT_ETC2:	image.glFormat = alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2; break;
+		default:			image.glFormat = GL_ETC1_RGB8_OES; break;
+	}
+
+	const size_t blockSize = getBlockSize(image.glFormat);
+	const size_t blocksX = (width + 3) / 4;
+	const size_t blocksY = (height + 3) / 4;
+	image.width = image.sourceWidth = width;
+	image.height = image.sourceHeight = height;
+	image.blocks.resize(blocksX * blocksY * blockSize);
+
+	// Rows are compressed in memory order, so the blocks are bottom-up like the pixels were
+	Block block;
+	for (size_t y = 0; y < blocksY; y++)
+	{
+		for (size_t x = 0; x < blocksX; x++)
+		{
+			getBlock(dataRGBA, width, height, x, y, block);
+			unsigned char* out = &image.blocks[(y * blocksX + x) * blockSize];
+			if (format == FORMAT_DXT)
+			{
+				if (alpha)
+				{
+					encodeDXTAlpha(block, out);
+					out += 8;
+				}
+				encodeDXTColor(block, out);
+			}
+			else
+			{
+				if (alpha)
+				{
+					encodeEACAlpha(block, out);
+					out += 8;
+				}
+				encodeETC1(block, out);
+			}
+		}
+	}
+	return true;
+}
+
+bool TextureCompressor::getCached(const std::string& path, Image& image)
+{
+	if (!enabled())
+		return false;
+	return readFromDisk(getDiskPath(path, mFormat), image);
+}
+
+void TextureCompressor::compressLater(const std::string& path)
+{
+	if (!enabled())
+		return;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mExit || mSkipped.count(path) || std::any_of(mQueue.begin(), mQueue.end(), [&path](const Job& job) { return job.path == path; }))
+		return;
+
+	Job job;
+	job.path = path;
+	job.format = mFormat;
+	mQueue.push_back(job);
+	if (mThread == nullptr)
+		mThread = new std::thread(&TextureCompressor::threadProc, this);
+	mEvent.notify_one();
+}
+
+bool TextureCompressor::compressNow(const std::string& path, size_t& savedBytes)
+{
+	if (!enabled())
+		return false;
+	return compressToDisk(path, mFormat, savedBytes);
+}
+
+bool TextureCompressor::compressToDisk(const std::string& path, Format format, size_t& savedBytes)
+{
+	const std::string diskPath = getDiskPath(path, format);
+	Image image;
+	if (!readFromDisk(diskPath, image))
+	{
+		const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+		if (data.length == 0)
+			return false;
+
+		// decode exactly like TextureData does, so the cached blocks can stand in for its pixels
+		size_t width, height, sourceWidth, sourceHeight;
+		std::vector<unsigned char> dataRGBA = ImageIO::loadFromMemoryRGBA32(data.ptr.get(), data.length, width, height,
+			Renderer::getScreenWidth(), Renderer::getScreenHeight(), &sourceWidth, &sourceHeight);
+
+		// images small enough for the atlas aren't worth it
+		if (dataRGBA.empty() || TextureAtlas::accepts(width, height) || !compress(format, dataRGBA.data(), width, height, image))
+			return false;
+
+		image.sourceWidth = sourceWidth;
+		image.sourceHeight = sourceHeight;
+		writeToDisk(diskPath, image);
+	}
+
+	savedBytes = image.width * image.height * 4 - image.blocks.size();
+	return true;
+}
+
+bool TextureCompressor::upload(const Image& image)
+{
+	glGetError();
+	compressedTexImage2D(GL_TEXTURE_2D, 0, image.glFormat, (GLsizei)image.width, (GLsizei)image.height, 0,
+		(GLsizei)image.blocks.size(), image.blocks.data());
+	if (glGetError() != GL_NO_ERROR)
+	{
+		LOG(LogError) << "Compressed texture upload failed, disabling texture compression";
+		mFormat = FORMAT_NONE;
+		return false;
+	}
+	return true;
+}
+
+std::string TextureCompressor::getDiskPath(const std::string& path, Format format) const
+{
+	// The decoded size depends on the screen size, and the blocks on the format
+	std::stringstream ss;
+	ss << mDiskFolder << std::hex << std::hash<std::string>()(path) << std::dec << "_" << getModifiedTime(path) << "_"
+		<< Renderer::getScreenWidth() << "x" << Renderer::getScreenHeight() << "_" << (int)format << ".tex";
+	return ss.str();
+}
+
+bool TextureCompressor::readFromDisk(const std::string& diskPath, Image& image) const
+{
+	std::ifstream stream(diskPath, std::ios::in | std::ios::binary);
+	if (!stream)
+		return false;
+
+	char magic[4];
+	unsigned int header[5];
+	stream.read(magic, sizeof(magic));
+	stream.read((char*)header, sizeof(header));
+	if (!stream || memcmp(magic, k_diskMagic, sizeof(magic)) != 0 || header[1] == 0 || header[2] == 0)
+		return false;
+
+	image.glFormat = header[0];
+	image.width = header[1];
+	image.height = header[2];
+	image.sourceWidth = header[3];
+	image.sourceHeight = header[4];
+	image.blocks.resize(((image.width + 3) / 4) * ((image.height + 3) / 4) * getBlockSize(image.glFormat));
+	stream.read((char*)image.blocks.data(), image.blocks.size());
+	if (stream.gcount() != (std::streamsize)image.blocks.size())
+	{
+		image = Image();
+		return false;
+	}
+	return true;
+}
+
+void TextureCompressor::writeToDisk(const std::string& diskPath, const Image& image) const
+{
+	// write to a temporary file first so a reader never sees half an image
+	const std::string tempPath = diskPath + ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream)
+			return;
+
+		const unsigned int header[5] = { (unsigned int)image.glFormat, (unsigned int)image.width, (unsigned int)image.height,
+			(unsigned int)image.sourceWidth, (unsigned int)image.sourceHeight };
+		stream.write(k_diskMagic, sizeof(k_diskMagic));
+		stream.write((const char*)header, sizeof(header));
+		stream.write((const char*)image.blocks.data(), image.blocks.size());
+		if (!stream)
+		{
+			stream.close();
+			fs::remove(tempPath);
+			return;
+		}
+	}
+
+	boost::system::error_code ec;
+	fs::rename(tempPath, diskPath, ec);
+	if (ec)
+		fs::remove(tempPath, ec);
+}
+
+void TextureCompressor::threadProc()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEvent.wait(lock, [this] { return mExit || !mQueue.empty(); });
+			if (mExit)
+				return;
+			job = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		// already done by an earlier request
+		if (fs::exists(getDiskPath(job.path, job.format)))
+			continue;
+
+		size_t savedBytes;
+		if (!compressToDisk(job.path, job.format, savedBytes))
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			if (mSkipped.size() >= k_maxSkipped)
+				mSkipped.clear();
+			mSkipped.insert(job.path);
+		}
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "platform.h"
+#include GLHEADER
+
+// Stores large file textures (scraped boxart, screenshots...) as GPU compressed blocks, which
+// take 1/8 (opaque) or 1/4 (alpha) of the VRAM of plain RGBA.
+// The format is picked from what the GL driver supports. Transcoding is slow compared to
+// decoding, so it never happens while a texture is being loaded: images are queued for a
+// background thread (or compressed offline with --compress-media) and the blocks are written
+// to ~/.emulationstation/cache/textures. The next load of that image uses the blocks directly.
+class TextureCompressor
+{
+public:
+	enum Format
+	{
+		FORMAT_NONE,
+		FORMAT_DXT,		// DXT1, DXT5 with alpha (EXT_texture_compression_s3tc)
+		FORMAT_ETC2,	// ETC2 RGB8, ETC2 RGBA8 with EAC alpha
+		FORMAT_ETC1		// ETC1, images with alpha stay uncompressed
+	};
+
+	struct Image
+	{
+		Image() : glFormat(0), width(0), height(0), sourceWidth(0), sourceHeight(0) {}
+
+		GLenum glFormat;
+		size_t width;
+		size_t height;
+		size_t sourceWidth; // size of the image in the file, before any scaled decode
+		size_t sourceHeight;
+		std::vector<unsigned char> blocks;
+	};
+
+	static TextureCompressor* getInstance();
+
+	// Picks the best format the GL context supports and reads the settings. Must be called on
+	// the render thread once the context exists.
+	void init();
+	// Stops the background thread, waiting for the image it is compressing. Called on exit.
+	void deinit();
+
+	Format getFormat() const { return mFormat; }
+	static const char* getFormatName(Format format);
+
+	// True if textures should be looked up in and queued for the compressed cache
+	bool enabled() const;
+
+	// Encodes a bottom-up RGBA image. Returns false if the format can't store it.
+	static bool compress(Format format, const unsigned char* dataRGBA, size_t width, size_t height, Image& image);
+
+	// Looks up the blocks for a (canonical) image path, as decoded for the current screen size
+	bool getCached(const std::string& path, Image& image);
+	// Queues an image to be compressed into the cache by the background thread
+	void compressLater(const std::string& path);
+	// Compresses an image into the cache right away. Returns false if it was not compressed,
+	// otherwise savedBytes is the VRAM it will save once loaded.
+	bool compressNow(const std::string& path, size_t& savedBytes);
+
+	// Uploads the blocks to the bound texture. If the driver refuses them compression is
+	// turned off, so the texture can be reloaded uncompressed.
+	bool upload(const Image& image);
+
+private:
+	// An image queued for the background thread, with what it needs to know of the settings
+	struct Job
+	{
+		std::string	path;
+		Format		format;
+	};
+
+	TextureCompressor();
+
+	bool compressToDisk(const std::string& path, Format format, size_t& savedBytes);
+	std::string getDiskPath(const std::string& path, Format format) const;
+	bool readFromDisk(const std::string& diskPath, Image& image) const;
+	void writeToDisk(const std::string& diskPath, const Image& image) const;
+	void threadProc();
+
+	static TextureCompressor* sInstance;
+
+	std::atomic<Format>		mFormat; // read by the loader threads
+	std::atomic<bool>		mSettingEnabled; // CompressTextures, read once by init()
+	std::string				mDiskFolder;
+	bool					mDiskEnabled;
+
+	std::thread*			mThread;
+	std::mutex				mMutex;
+	std::condition_variable	mEvent;
+	bool					mExit;
+	std::list<Job>			mQueue;
+	std::set<std::string>	mSkipped; // images that can't be compressed, so they aren't queued every load
+};
@@ -2,16 +2,20 @@
 #include "resources/ResourceManager.h"
 #include "Log.h"
 #include "ImageIO.h"
+#include "Renderer.h"
 #include "string.h"
 #include "Util.h"
+#include "resources/SVGCache.h"
+#include "resources/TextureAtlas.h"
+#include "Settings.h"
+#include "FrameScheduler.h"
 #include "nanosvg/nanosvg.h"
 #include "nanosvg/nanosvgrast.h"
 #include <vector>
 
-#define DPI 96
-
 TextureData::TextureData(bool tile) : mTile(tile), mTextureID(0), mDataRGBA(nullptr), mScalable(false),
-									  mWidth(0), mHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f)
+									  mWidth(0), mHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f),
+									  mMaxWidth(0), mMaxHeight(0), mLoadFailed(false)
 {
 }
 
@@ -25,33 +29,28 @@ void TextureData::initFromPath(const std::string& path)
 {
 	// Just set the path. It will be loaded later
 	mPath = path;
+	mScalable = (mPath.size() > 4) && (mPath.substr(mPath.size() - 4, std::string::npos) == ".svg");
 	// Only textures with paths are reloadable
 	mReloadable = true;
 }
 
-bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length)
+bool TextureData::loadSize()
 {
-	// If already initialised then don't read again
-	{
-		std::unique_lock<std::mutex> lock(mMutex);
-		if (mDataRGBA)
-			return true;
-	}
-
-	// nsvgParse excepts a modifiable, null-terminated string
-	char* copy = (char*)malloc(length + 1);
-	assert(copy != NULL);
-	memcpy(copy, fileData, length);
-	copy[length] = '\0';
+	// Only scalable textures can tell their size without being fully loaded
+	if (!mScalable)
+		return load();
 
-	NSVGimage* svgImage = nsvgParse(copy, "px", DPI);
-	free(copy);
-	if (!svgImage)
-	{
-		LOG(LogError) << "Error parsing SVG image.";
+	SVGCache::Image image = SVGCache::getInstance()->getImage(mPath);
+	if (!image.svg)
 		return false;
-	}
 
+	std::unique_lock<std::mutex> lock(mMutex);
+	updateSVGSize(image.svg.get());
+	return true;
+}
+
+void TextureData::updateSVGSize(const NSVGimage* svgImage)
+{
 	// We want to rasterise this texture at a specific resolution. If the source size
 	// variables are set then use them otherwise set them from the parsed file
 	if ((mSourceWidth == 0.0f) && (mSourceHeight == 0.0f))
@@ -72,17 +71,52 @@ bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length
 		// auto scale height to keep aspect
 		mHeight = (size_t)round(((float)mWidth / svgImage->width) * svgImage->height);
 	}
+}
+
+bool TextureData::initSVG()
+{
+	// If already initialised then don't read again
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mDataRGBA)
+			return true;
+	}
+
+	SVGCache* cache = SVGCache::getInstance();
+	SVGCache::Image image = cache->getImage(mPath);
+	if (!image.svg)
+		return false;
 
-	unsigned char* dataRGBA = new unsigned char[mWidth * mHeight * 4];
+	size_t width, height;
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		updateSVGSize(image.svg.get());
+		width = mWidth;
+		height = mHeight;
+	}
+	if ((width == 0) || (height == 0))
+		return false;
+
+	std::vector<unsigned char> dataRGBA;
+	if (!cache->getBitmap(mPath, image, width, height, dataRGBA))
+	{
+		dataRGBA.resize(width * height * 4);
 
-	NSVGrasterizer* rast = nsvgCreateRasterizer();
-	nsvgRasterize(rast, svgImage, 0, 0, mHeight / svgImage->height, dataRGBA, mWidth, mHeight, mWidth * 4);
-	nsvgDeleteRasterizer(rast);
+		NSVGrasterizer* rast = nsvgCreateRasterizer();
+		nsvgRasterize(rast, image.svg.get(), 0, 0, height / image.svg->height, dataRGBA.data(), width, height, width * 4);
+		nsvgDeleteRasterizer(rast);
 
-	ImageIO::flipPixelsVert(dataRGBA, mWidth, mHeight);
+		ImageIO::flipPixelsVert(dataRGBA.data(), width, height);
+		cache->putBitmap(mPath, image, width, height, dataRGBA.data());
+	}
 
 	std::unique_lock<std::mutex> lock(mMutex);
-	mDataRGBA = dataRGBA;
+	// The texture may have been resized while we were rasterizing, in which case this bitmap is
+	// stale and the next load() will produce the right one
+	if (mDataRGBA || (width != mWidth) || (height != mHeight))
+		return true;
+	mDataRGBA = new unsigned char[width * height * 4];
+	memcpy(mDataRGBA, dataRGBA.data(), width * height * 4);
 
 	return true;
 }
@@ -98,15 +132,25 @@ bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t leng
 			return true;
 	}
 
-	std::vector<unsigned char> imageRGBA = ImageIO::loadFromMemoryRGBA32((const unsigned char*)(fileData), length, width, height);
+	// Nothing is ever drawn bigger than the screen, so let the decoder skip detail we would throw away.
+	// Tiled textures are repeated at their pixel size and have to be decoded in full.
+	const size_t maxWidth = mTile ? 0 : (mMaxWidth ? mMaxWidth : Renderer::getScreenWidth());
+	const size_t maxHeight = mTile ? 0 : (mMaxHeight ? mMaxHeight : Renderer::getScreenHeight());
+	size_t sourceWidth, sourceHeight;
+	std::vector<unsigned char> imageRGBA = ImageIO::loadFromMemoryRGBA32((const unsigned char*)(fileData), length, width, height,
+		maxWidth, maxHeight, &sourceWidth, &sourceHeight);
 	if (imageRGBA.size() == 0)
 	{
 		LOG(LogError) << "Could not initialize texture from memory, invalid data!  (file path: " << mPath << ", data ptr: " << (size_t)fileData << ", reported size: " << length << ")";
 		return false;
 	}
 
-	mSourceWidth = width;
-	mSourceHeight = height;
+	// Small textures (thumbnails) shrink PNGs too, there can be hundreds of them
+	if (mMaxWidth && !mTile)
+		ImageIO::shrinkRGBA32(imageRGBA, width, height, mMaxWidth, mMaxHeight);
+
+	mSourceWidth = sourceWidth;
+	mSourceHeight = sourceHeight;
 	mScalable = false;
 
 	return initFromRGBA(imageRGBA.data(), width, height);
@@ -134,52 +178,132 @@ bool TextureData::load()
 	// Need to load. See if there is a file
 	if (!mPath.empty())
 	{
-		std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
-		const ResourceData& data = rm->getFileData(mPath);
-		// is it an SVG?
-		if (mPath.substr(mPath.size() - 4, std::string::npos) == ".svg")
+		if (mScalable)
+		{
+			// SVGs go through the cache, which only reads the file if it has to
+			retval = initSVG();
+		}
+		else if (compressible() && loadCompressed())
 		{
-			mScalable = true;
-			retval = initSVGFromMemory((const unsigned char*)data.ptr.get(), data.length);
+			retval = true;
 		}
 		else
+		{
+			std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
+			const ResourceData& data = rm->getFileData(mPath);
+			if (data.length == 0)
+			{
+				LOG(LogWarning) << "Image file " << mPath << " is missing or empty";
+				mLoadFailed = true;
+				return false;
+			}
 			retval = initImageFromMemory((const unsigned char*)data.ptr.get(), data.length);
+			mLoadFailed = !retval;
+
+			// Compress it in the background so the next load can skip decoding and use less VRAM
+			if (retval && compressible() && !TextureAtlas::accepts(mWidth, mHeight))
+				TextureCompressor::getInstance()->compressLater(mPath);
+		}
 	}
 	return retval;
 }
 
+bool TextureData::compressible()
+{
+	// Only images from real files, embedded resources are small UI images. The compressed cache
+	// holds screen sized images, textures decoded smaller don't use it.
+	return !mTile && !mPath.empty() && (mPath[0] != ':') && (mMaxWidth == 0) && TextureCompressor::getInstance()->enabled();
+}
+
+bool TextureData::loadCompressed()
+{
+	// If already initialised then don't read again
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mDataRGBA || !mCompressed.blocks.empty())
+			return true;
+	}
+
+	TextureCompressor::Image image;
+	if (!TextureCompressor::getInstance()->getCached(mPath, image))
+		return false;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mDataRGBA || !mCompressed.blocks.empty())
+		return true;
+	mWidth = image.width;
+	mHeight = image.height;
+	mSourceWidth = image.sourceWidth;
+	mSourceHeight = image.sourceHeight;
+	mCompressed = std::move(image);
+	return true;
+}
+
 bool TextureData::isLoaded()
 {
 	std::unique_lock<std::mutex> lock(mMutex);
-	if (mDataRGBA || (mTextureID != 0))
+	if (mDataRGBA || !mCompressed.blocks.empty() || (mTextureID != 0) || mAtlasRegion.valid())
 		return true;
 	return false;
 }
 
-bool TextureData::uploadAndBind()
+bool TextureData::upload(GLuint& textureId, bool deferrable)
 {
 	// See if it's already been uploaded
 	std::unique_lock<std::mutex> lock(mMutex);
 	if (mTextureID != 0)
 	{
-		glBindTexture(GL_TEXTURE_2D, mTextureID);
+		textureId = mTextureID;
+	}
+	else if (mAtlasRegion.valid())
+	{
+		textureId = TextureAtlas::getInstance()->getTextureID(mAtlasRegion);
 	}
 	else
 	{
 		// Load it if necessary
-		if (!mDataRGBA)
+		if (!mDataRGBA && mCompressed.blocks.empty())
 		{
 			return false;
 		}
 		// Make sure we're ready to upload
-		if ((mWidth == 0) || (mHeight == 0) || (mDataRGBA == nullptr))
+		if ((mWidth == 0) || (mHeight == 0))
 			return false;
+		if (deferrable && !FrameScheduler::getInstance()->runDeferred())
+			return false;
+
+		// Small images from files are packed into a shared page. Tiled ones need their own
+		// texture to repeat, and textures without a path are usually updated every frame.
+		if (mDataRGBA && !mTile && !mPath.empty() && TextureAtlas::accepts(mWidth, mHeight) && Settings::getInstance()->getBool("TextureAtlas"))
+		{
+			TextureAtlas* atlas = TextureAtlas::getInstance();
+			if (atlas->add(mDataRGBA, mWidth, mHeight, mAtlasRegion))
+			{
+				textureId = atlas->getTextureID(mAtlasRegion);
+				return true;
+			}
+		}
+
 		glGetError();
 		//now for the openGL texture stuff
 		glGenTextures(1, &mTextureID);
-		glBindTexture(GL_TEXTURE_2D, mTextureID);
+		Renderer::bindTexture(mTextureID);
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, mWidth, mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, mDataRGBA);
+		if (!mCompressed.blocks.empty())
+		{
+			if (!TextureCompressor::getInstance()->upload(mCompressed))
+			{
+				// Compression is off now, so dropping the blocks makes the next load() decode the file
+				Renderer::deleteTexture(mTextureID);
+				mTextureID = 0;
+				mCompressed = TextureCompressor::Image();
+				return false;
+			}
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, mWidth, mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, mDataRGBA);
+		}
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -187,6 +311,7 @@ bool TextureData::uploadAndBind()
 		const GLint wrapMode = mTile ? GL_REPEAT : GL_CLAMP_TO_EDGE;
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+		textureId = mTextureID;
 	}
 	return true;
 }
@@ -196,9 +321,19 @@ void TextureData::releaseVRAM()
 	std::unique_lock<std::mutex> lock(mMutex);
 	if (mTextureID != 0)
 	{
-		glDeleteTextures(1, &mTextureID);
+		Renderer::deleteTexture(mTextureID);
 		mTextureID = 0;
 	}
+	if (mAtlasRegion.valid())
+		TextureAtlas::getInstance()->remove(mAtlasRegion);
+}
+
+Eigen::Vector4f TextureData::getTextureRect()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mAtlasRegion.valid())
+		return TextureAtlas::getInstance()->getTextureRect(mAtlasRegion);
+	return Eigen::Vector4f(0, 0, 1, 1);
 }
 
 void TextureData::releaseRAM()
@@ -206,6 +341,19 @@ void TextureData::releaseRAM()
 	std::unique_lock<std::mutex> lock(mMutex);
 	delete[] mDataRGBA;
 	mDataRGBA = 0;
+	mCompressed = TextureCompressor::Image();
+}
+
+void TextureData::setMaxSize(size_t width, size_t height)
+{
+	mMaxWidth = width;
+	mMaxHeight = height;
+}
+
+size_t TextureData::getLoadSize()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mWidth * mHeight * 4;
 }
 
 size_t TextureData::width()
@@ -240,20 +388,34 @@ void TextureData::setSourceSize(float width, float height)
 {
 	if (mScalable)
 	{
-		if ((mSourceWidth != width) || (mSourceHeight != height))
 		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			if ((mSourceWidth == width) && (mSourceHeight == height))
+				return;
 			mSourceWidth = width;
 			mSourceHeight = height;
-			releaseVRAM();
-			releaseRAM();
 		}
+		releaseVRAM();
+		releaseRAM();
+		// Keep width()/height() in step with the new size without rasterizing here
+		loadSize();
 	}
 }
 
 size_t TextureData::getVRAMUsage()
 {
-	if ((mTextureID != 0) || (mDataRGBA != nullptr))
+	if (!mCompressed.blocks.empty())
+		return mCompressed.blocks.size();
+	else if ((mTextureID != 0) || mAtlasRegion.valid() || (mDataRGBA != nullptr))
 		return mWidth * mHeight * 4;
 	else
 		return 0;
 }
+
+size_t TextureData::getVRAMSaved()
+{
+	if (!mCompressed.blocks.empty())
+		return mWidth * mHeight * 4 - mCompressed.blocks.size();
+	else
+		return 0;
+}
@@ -3,10 +3,15 @@
 #include <string>
 #include <memory>
 #include "platform.h"
+#include "resources/TextureAtlas.h"
+#include "resources/TextureCompressor.h"
 #include <mutex>
+#include <atomic>
+#include <Eigen/Dense>
 #include GLHEADER
 
 class TextureResource;
+struct NSVGimage;
 
 class TextureData
 {
@@ -18,18 +23,25 @@ public:
 
 	//!!!! Needs to be canonical path. Caller should check for duplicates before calling this
 	void initFromPath(const std::string& path);
-	bool initSVGFromMemory(const unsigned char* fileData, size_t length);
 	bool initImageFromMemory(const unsigned char* fileData, size_t length);
 	bool initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
 
 	// Read the data into memory if necessary
 	bool load();
 
+	// Work out width/height without loading the pixels if possible. SVGs are only parsed here
+	// and are rasterized by load() at whatever size they end up being displayed at.
+	bool loadSize();
+
 	bool isLoaded();
+	// True once an image file couldn't be read or decoded, e.g. because it is missing. It isn't
+	// loaded again, so nothing keeps queueing it.
+	bool loadFailed() const { return mLoadFailed; }
 
-	// Upload the texture to VRAM if necessary and bind. Returns true if bound ok or
-	// false if either not loaded
-	bool uploadAndBind();
+	// Upload the texture to VRAM if necessary. Returns true and the texture to draw with (which
+	// may be a shared atlas page) if uploaded ok, or false if not loaded. A deferrable texture also
+	// waits for a frame with time left (see FrameScheduler).
+	bool upload(GLuint& textureId, bool deferrable = false);
 
 	// Release the texture from VRAM
 	void releaseVRAM();
@@ -39,6 +51,12 @@ public:
 
 	// Get the amount of VRAM currenty used by this texture
 	size_t getVRAMUsage();
+	// Get the amount of VRAM saved by storing this texture compressed
+	size_t getVRAMSaved();
+
+	// The part of the bound texture holding this image (x, y, width, height in texture
+	// coordinates). This is only a sub-rectangle if the image was packed into the atlas.
+	Eigen::Vector4f getTextureRect();
 
 	size_t width();
 	size_t height();
@@ -46,18 +64,36 @@ public:
 	float sourceHeight();
 	void setSourceSize(float width, float height);
 
+	// Decode no bigger than about width x height instead of the screen size. Set before loading.
+	void setMaxSize(size_t width, size_t height);
+	// The RAM/VRAM the pixels take once loaded, without loading them. 0 while the size isn't known.
+	size_t getLoadSize();
+
 	bool tiled() { return mTile; }
+	bool scalable() { return mScalable; }
 
 private:
+	// Rasterizes mPath at the current source size, reusing cached bitmaps where possible
+	bool initSVG();
+	void updateSVGSize(const NSVGimage* svgImage);
+	// Picks up the compressed blocks for mPath if the compressor already made them
+	bool loadCompressed();
+	bool compressible();
+
 	std::mutex		mMutex;
 	bool			mTile;
 	std::string		mPath;
 	GLuint 			mTextureID;
+	TextureAtlas::Region mAtlasRegion;
 	unsigned char*	mDataRGBA;
+	TextureCompressor::Image mCompressed; // used instead of mDataRGBA when not empty
 	size_t			mWidth;
 	size_t			mHeight;
 	float			mSourceWidth;
 	float			mSourceHeight;
+	size_t			mMaxWidth;	// decode limit, 0 for the screen size
+	size_t			mMaxHeight;
 	bool			mScalable;
 	bool			mReloadable;
+	std::atomic<bool> mLoadFailed; // set by the loader thread
 };
@@ -37,6 +37,8 @@ void TextureDataManager::remove(const TextureResource* key)
 	auto it = mTextureLookup.find(key);
 	if (it != mTextureLookup.end())
 	{
+		// Nothing shows it anymore, so don't let it hold up the loader either
+		mLoader->remove(*(*it).second);
 		// Remove the list entry
 		mTextures.erase((*it).second);
 		// And the lookup
@@ -66,22 +68,30 @@ std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key)
 	return tex;
 }
 
-bool TextureDataManager::bind(const TextureResource* key)
+bool TextureDataManager::upload(const TextureResource* key, GLuint& textureId)
 {
 	std::shared_ptr<TextureData> tex = get(key);
-	bool bound = false;
+	bool uploaded = false;
 	if (tex != nullptr)
-		bound = tex->uploadAndBind();
-	if (!bound)
-		mBlank->uploadAndBind();
-	return bound;
+		uploaded = tex->upload(textureId);
+	if (!uploaded)
+		textureId = getBlankTextureID();
+	return uploaded;
+}
+
+GLuint TextureDataManager::getBlankTextureID()
+{
+	GLuint textureId = 0;
+	mBlank->upload(textureId);
+	return textureId;
 }
 
 size_t TextureDataManager::getTotalSize()
 {
 	size_t total = 0;
+	// Textures loaded in the background may not know their size yet, asking would load them here
 	for (auto tex : mTextures)
-		total += tex->width() * tex->height() * 4;
+		total += tex->getLoadSize();
 	return total;
 }
 
@@ -93,15 +103,94 @@ size_t TextureDataManager::getCommittedSize()
 	return total;
 }
 
+bool TextureDataManager::prefetch(const std::string& path)
+{
+	if (mPrefetched.find(path) != mPrefetched.end())
+		return true;
+
+	const size_t budget = (size_t)Settings::getInstance()->getInt("PrefetchMemory") * 1024 * 1024;
+	if (getPrefetchSize() >= budget)
+		return false;
+
+	std::shared_ptr<TextureData> data(new TextureData(false));
+	data->initFromPath(path);
+	mPrefetched[path] = data;
+	mLoader->prefetch(data);
+	return true;
+}
+
+void TextureDataManager::cancelPrefetch(const std::string& path)
+{
+	auto it = mPrefetched.find(path);
+	if (it != mPrefetched.end())
+	{
+		// If the loader is working on it right now it holds its own reference until it's done
+		mLoader->remove(it->second);
+		mPrefetched.erase(it);
+	}
+}
+
+bool TextureDataManager::isPrefetched(const std::string& path)
+{
+	auto it = mPrefetched.find(path);
+	return (it != mPrefetched.end()) && it->second->isLoaded();
+}
+
+std::shared_ptr<TextureData> TextureDataManager::takePrefetched(const TextureResource* key, const std::string& path)
+{
+	auto it = mPrefetched.find(path);
+	if (it == mPrefetched.end())
+		return nullptr;
+
+	std::shared_ptr<TextureData> data = it->second;
+	mPrefetched.erase(it);
+
+	remove(key);
+	mTextures.push_front(data);
+	mTextureLookup[key] = mTextures.begin();
+	return data;
+}
+
+size_t TextureDataManager::getPrefetchSize()
+{
+	size_t loadedSize = 0;
+	size_t loadedCount = 0;
+	for (auto& prefetched : mPrefetched)
+	{
+		if (prefetched.second->isLoaded())
+		{
+			loadedSize += prefetched.second->getVRAMUsage();
+			loadedCount++;
+		}
+	}
+
+	if (loadedCount == 0)
+		return 0;
+	return loadedSize + (mPrefetched.size() - loadedCount) * (loadedSize / loadedCount);
+}
+
+size_t TextureDataManager::getSavedSize()
+{
+	size_t total = 0;
+	for (auto tex : mTextures)
+		total += tex->getVRAMSaved();
+	return total;
+}
+
 size_t TextureDataManager::getQueueSize()
 {
 	return mLoader->getQueueSize();
 }
 
+bool TextureDataManager::isLoaderIdle()
+{
+	return mLoader->isIdle();
+}
+
 void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 {
-	// See if it's already loaded
-	if (tex->isLoaded())
+	// See if it's already loaded, or can't be
+	if (tex->isLoaded() || tex->loadFailed())
 		return;
 	// Not loaded. Make sure there is room
 	size_t size = TextureResource::getTotalMemUsage();
@@ -127,7 +216,7 @@ void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 		tex->load();
 }
 
-TextureLoader::TextureLoader() : mExit(false)
+TextureLoader::TextureLoader() : mExit(false), mBusy(false)
 {
 	mThread = new std::thread(&TextureLoader::threadProc, this);
 }
@@ -137,6 +226,8 @@ TextureLoader::~TextureLoader()
 	// Just abort any waiting texture
 	mTextureDataQ.clear();
 	mTextureDataLookup.clear();
+	mPrefetchQ.clear();
+	mPrefetchLookup.clear();
 
 	// Exit the thread
 	mExit = true;
@@ -154,12 +245,8 @@ void TextureLoader::threadProc()
 			// Wait for an event to say there is something in the queue
 			std::unique_lock<std::mutex> lock(mMutex);
 			mEvent.wait(lock);
-			if (!mTextureDataQ.empty())
-			{
-				textureData = mTextureDataQ.front();
-				mTextureDataQ.pop_front();
-				mTextureDataLookup.erase(mTextureDataLookup.find(textureData.get()));
-			}
+			textureData = popNext();
+			mBusy = (textureData != nullptr);
 		}
 		// Queue has been released here but we might have a texture to process
 		while (textureData)
@@ -167,22 +254,36 @@ void TextureLoader::threadProc()
 			textureData->load();
 
 			// See if there is another item in the queue
-			textureData = nullptr;
 			std::unique_lock<std::mutex> lock(mMutex);
-			if (!mTextureDataQ.empty())
-			{
-				textureData = mTextureDataQ.front();
-				mTextureDataQ.pop_front();
-				mTextureDataLookup.erase(mTextureDataLookup.find(textureData.get()));
-			}
+			textureData = popNext();
+			mBusy = (textureData != nullptr);
 		}
 	}
 }
 
+std::shared_ptr<TextureData> TextureLoader::popNext()
+{
+	std::shared_ptr<TextureData> textureData;
+	if (!mTextureDataQ.empty())
+	{
+		textureData = mTextureDataQ.front();
+		mTextureDataQ.pop_front();
+		mTextureDataLookup.erase(mTextureDataLookup.find(textureData.get()));
+	}
+	else if (!mPrefetchQ.empty())
+	{
+		// Prefetches only run when nothing on screen is waiting
+		textureData = mPrefetchQ.front();
+		mPrefetchQ.pop_front();
+		mPrefetchLookup.erase(mPrefetchLookup.find(textureData.get()));
+	}
+	return textureData;
+}
+
 void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 {
 	// Make sure it's not already loaded
-	if (!textureData->isLoaded())
+	if (!textureData->isLoaded() && !textureData->loadFailed())
 	{
 		std::unique_lock<std::mutex> lock(mMutex);
 		// Remove it from the queue if it is already there
@@ -192,6 +293,13 @@ void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 			mTextureDataQ.erase((*td).second);
 			mTextureDataLookup.erase(td);
 		}
+		// A prefetch that is needed now moves to the normal queue
+		auto pd = mPrefetchLookup.find(textureData.get());
+		if (pd != mPrefetchLookup.end())
+		{
+			mPrefetchQ.erase((*pd).second);
+			mPrefetchLookup.erase(pd);
+		}
 
 		// Put it on the start of the queue as we want the newly requested textures to load first
 		mTextureDataQ.push_front(textureData);
@@ -200,6 +308,22 @@ void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 	}
 }
 
+void TextureLoader::prefetch(std::shared_ptr<TextureData> textureData)
+{
+	if (!textureData->isLoaded() && !textureData->loadFailed())
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mTextureDataLookup.find(textureData.get()) != mTextureDataLookup.end() ||
+			mPrefetchLookup.find(textureData.get()) != mPrefetchLookup.end())
+			return;
+
+		// Prefetches are requested nearest first, so they go on the end
+		mPrefetchQ.push_back(textureData);
+		mPrefetchLookup[textureData.get()] = std::prev(mPrefetchQ.end());
+		mEvent.notify_one();
+	}
+}
+
 void TextureLoader::remove(std::shared_ptr<TextureData> textureData)
 {
 	// Just remove it from the queue so we don't attempt to load it
@@ -210,6 +334,12 @@ void TextureLoader::remove(std::shared_ptr<TextureData> textureData)
 		mTextureDataQ.erase((*td).second);
 		mTextureDataLookup.erase(td);
 	}
+	auto pd = mPrefetchLookup.find(textureData.get());
+	if (pd != mPrefetchLookup.end())
+	{
+		mPrefetchQ.erase((*pd).second);
+		mPrefetchLookup.erase(pd);
+	}
 }
 
 size_t TextureLoader::getQueueSize()
@@ -220,7 +350,13 @@ size_t TextureLoader::getQueueSize()
 	std::unique_lock<std::mutex> lock(mMutex);
 	for (auto tex : mTextureDataQ)
 	{
-		mem += tex->width() * tex->height() * 4;
+		mem += tex->getLoadSize();
 	}
 	return mem;
 }
+
+bool TextureLoader::isIdle()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return !mBusy && mTextureDataQ.empty() && mPrefetchQ.empty();
+}
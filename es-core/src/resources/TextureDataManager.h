@@ -19,21 +19,30 @@ public:
 	~TextureLoader();
 
 	void load(std::shared_ptr<TextureData> textureData);
+	// Queue a load that only runs when there is nothing else to load
+	void prefetch(std::shared_ptr<TextureData> textureData);
 	void remove(std::shared_ptr<TextureData> textureData);
 
 	size_t getQueueSize();
+	// True if nothing is queued or being loaded
+	bool isIdle();
 
 private:
 	void processQueue();
 	void threadProc();
+	// Takes the next texture to load off the queues, or returns nullptr. mMutex must be held.
+	std::shared_ptr<TextureData> popNext();
 
 	std::list<std::shared_ptr<TextureData> > 										mTextureDataQ;
 	std::map<TextureData*, std::list<std::shared_ptr<TextureData> >::iterator > 	mTextureDataLookup;
+	std::list<std::shared_ptr<TextureData> > 										mPrefetchQ;
+	std::map<TextureData*, std::list<std::shared_ptr<TextureData> >::iterator > 	mPrefetchLookup;
 
 	std::thread*				mThread;
 	std::mutex					mMutex;
 	std::condition_variable		mEvent;
 	bool 						mExit;
+	bool						mBusy; // a texture taken off the queues is being loaded
 };
 
 //
@@ -64,23 +73,43 @@ public:
 	void remove(const TextureResource* key);
 
 	std::shared_ptr<TextureData> get(const TextureResource* key);
-	bool bind(const TextureResource* key);
+	// Upload the texture if necessary; textureId is the blank texture if it isn't loaded yet
+	bool upload(const TextureResource* key, GLuint& textureId);
+	// Upload the placeholder used while a texture is still loading
+	GLuint getBlankTextureID();
 
 	// Get the total size of all textures managed by this object, loaded and unloaded in bytes
 	size_t	getTotalSize();
 	// Get the total size of all committed textures (in VRAM) in bytes
 	size_t	getCommittedSize();
+	// Get the VRAM saved by committed textures that are stored compressed, in bytes
+	size_t	getSavedSize();
 	// Get the total size of all load-pending textures in the queue - these will
 	// be committed to VRAM as the queue is processed
 	size_t  getQueueSize();
+	// True if the background loader has nothing left to do
+	bool	isLoaderIdle();
 	// Load a texture, freeing resources as necessary to make space
 	void load(std::shared_ptr<TextureData> tex, bool block = false);
 
+	// Prefetched textures are loaded at low priority and kept out of the managed list (and the
+	// MaxVRAM accounting) until a TextureResource is created for their path. They have their own
+	// memory budget. prefetch() returns false if the budget is used up.
+	bool prefetch(const std::string& path);
+	void cancelPrefetch(const std::string& path);
+	// True if path was prefetched and has finished loading
+	bool isPrefetched(const std::string& path);
+	// Hands a prefetched texture over to key, or returns nullptr if path wasn't prefetched
+	std::shared_ptr<TextureData> takePrefetched(const TextureResource* key, const std::string& path);
+
 private:
+	// Memory used by prefetched textures, counting the queued ones at the average loaded size
+	size_t getPrefetchSize();
 
 	std::list<std::shared_ptr<TextureData> >												mTextures;
 	std::map<const TextureResource*, std::list<std::shared_ptr<TextureData> >::iterator > 	mTextureLookup;
 	std::shared_ptr<TextureData>															mBlank;
+	std::map<std::string, std::shared_ptr<TextureData> >									mPrefetched;
 	TextureLoader*																			mLoader;
 };
 
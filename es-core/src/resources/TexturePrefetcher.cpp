@@ -0,0 +1,58 @@
+#include "resources/TexturePrefetcher.h"
+#include "resources/TextureResource.h"
+#include "Util.h"
+#include <algorithm>
+
+TexturePrefetcher::Stats TexturePrefetcher::sStats = { 0, 0 };
+
+TexturePrefetcher::~TexturePrefetcher()
+{
+	clear();
+}
+
+void TexturePrefetcher::prefetch(const std::vector<std::string>& paths)
+{
+	std::vector<std::string> wanted;
+	for (auto& path : paths)
+	{
+		const std::string canonicalPath = getCanonicalPath(path);
+		if (!canonicalPath.empty() && std::find(wanted.begin(), wanted.end(), canonicalPath) == wanted.end())
+			wanted.push_back(canonicalPath);
+	}
+
+	// Cancel first so the budget they used is free for the new ones
+	for (auto& path : mPaths)
+	{
+		if (std::find(wanted.begin(), wanted.end(), path) == wanted.end())
+			TextureResource::cancelPrefetch(path);
+	}
+
+	mPaths.clear();
+	bool withinBudget = true;
+	for (auto& path : wanted)
+	{
+		withinBudget = withinBudget && TextureResource::prefetch(path);
+		if (withinBudget)
+			mPaths.push_back(path);
+		else
+			TextureResource::cancelPrefetch(path); // everything further away than what didn't fit goes too
+	}
+}
+
+void TexturePrefetcher::clear()
+{
+	for (auto& path : mPaths)
+		TextureResource::cancelPrefetch(path);
+	mPaths.clear();
+}
+
+void TexturePrefetcher::onShown(const std::string& path)
+{
+	const std::string canonicalPath = getCanonicalPath(path);
+	if (canonicalPath.empty())
+		return;
+
+	sStats.shown++;
+	if (TextureResource::isPrefetched(canonicalPath))
+		sStats.hits++;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Keeps the textures for the entries a list is likely to move to next loading in the background,
+// so they're ready by the time the cursor lands. Each call to prefetch() replaces the wanted set;
+// anything no longer wanted is cancelled. Hit statistics are shared by all prefetchers.
+class TexturePrefetcher
+{
+public:
+	struct Stats
+	{
+		unsigned int shown; // images shown by a prefetching list
+		unsigned int hits; // ... that were already loaded when they were shown
+	};
+
+	~TexturePrefetcher();
+
+	// Paths most likely to be needed first. Paths past the prefetch memory budget are dropped.
+	void prefetch(const std::vector<std::string>& paths);
+	void clear();
+
+	// Call just before path is shown, to keep the hit rate
+	void onShown(const std::string& path);
+
+	static const Stats& getStats() { return sStats; }
+
+private:
+	std::vector<std::string> mPaths; // canonical paths currently prefetched
+
+	static Stats sStats;
+};
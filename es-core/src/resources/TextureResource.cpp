@@ -11,7 +11,8 @@ TextureDataManager		TextureResource::sTextureDataManager;
 std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
 std::set<TextureResource*> 	TextureResource::sAllTextures;
 
-TextureResource::TextureResource(const std::string& path, bool tile, bool dynamic) : mTextureData(nullptr), mForceLoad(false)
+TextureResource::TextureResource(const std::string& path, bool tile, bool dynamic, size_t maxWidth, size_t maxHeight) :
+	mTextureData(nullptr), mSize(0, 0), mSourceSize(0, 0), mTextureRect(0, 0, 1, 1), mForceLoad(false)
 {
 	// Create a texture data object for this texture
 	if (!path.empty())
@@ -21,22 +22,42 @@ TextureResource::TextureResource(const std::string& path, bool tile, bool dynami
 		std::shared_ptr<TextureData> data;
 		if (dynamic)
 		{
-			data = sTextureDataManager.add(this, tile);
-			data->initFromPath(path);
-			// Force the texture manager to load it using a blocking load
-			sTextureDataManager.load(data, true);
+			// A prefetched texture has usually finished loading already. Prefetches are screen sized.
+			data = (tile || maxWidth) ? nullptr : sTextureDataManager.takePrefetched(this, path);
+			if (data == nullptr)
+			{
+				data = sTextureDataManager.add(this, tile);
+				data->initFromPath(path);
+				if (maxWidth)
+					data->setMaxSize(maxWidth, maxHeight);
+			}
+			// Force the texture manager to load it using a blocking load. SVGs only need to be
+			// parsed, they get rasterized once we know the size they're displayed at.
+			// Thumbnails are queued instead, their size is picked up by upload().
+			if (data->scalable())
+				data->loadSize();
+			else if (maxWidth)
+				sTextureDataManager.load(data);
+			else
+				sTextureDataManager.load(data, true);
 		}
 		else
 		{
 			mTextureData = std::shared_ptr<TextureData>(new TextureData(tile));
 			data = mTextureData;
 			data->initFromPath(path);
-			// Load it so we can read the width/height
-			data->load();
+			// Load it so we can read the width/height. Components that know the size an SVG is
+			// shown at call rasterizeAt(), until then it is rasterized at its own size.
+			data->loadSize();
+			if (data->scalable())
+				sTextureDataManager.load(data);
 		}
 
-		mSize << data->width(), data->height();
-		mSourceSize << data->sourceWidth(), data->sourceHeight();
+		if (data->scalable() || !maxWidth)
+		{
+			mSize << data->width(), data->height();
+			mSourceSize << data->sourceWidth(), data->sourceHeight();
+		}
 	}
 	else
 	{
@@ -91,17 +112,29 @@ bool TextureResource::isTiled() const
 	return data->tiled();
 }
 
-bool TextureResource::bind()
+bool TextureResource::upload(GLuint& textureId)
 {
-	if (mTextureData != nullptr)
+	std::shared_ptr<TextureData> data = mTextureData;
+	if (data == nullptr)
+		data = sTextureDataManager.get(this);
+
+	// Scalable textures are rasterized by the loader thread and may not be ready yet. Managed
+	// textures fade in when they're ready, so their upload can wait for a frame with time left.
+	if (data != nullptr && data->upload(textureId, data != mTextureData))
 	{
-		mTextureData->uploadAndBind();
+		mTextureRect = data->getTextureRect();
+		// Thumbnails only know their size once the loader is done with them
+		if (mSize.isZero())
+		{
+			mSize << data->width(), data->height();
+			mSourceSize << data->sourceWidth(), data->sourceHeight();
+		}
 		return true;
 	}
-	else
-	{
-		return sTextureDataManager.bind(this);
-	}
+
+	mTextureRect << 0, 0, 1, 1;
+	textureId = sTextureDataManager.getBlankTextureID();
+	return false;
 }
 
 std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile, bool forceLoad, bool dynamic)
@@ -116,7 +149,7 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 		return tex;
 	}
 
-	TextureKeyType key(canonicalPath, tile);
+	TextureKeyType key(canonicalPath, tile, 0, 0);
 	auto foundTexture = sTextureMap.find(key);
 	if(foundTexture != sTextureMap.end())
 	{
@@ -126,11 +159,11 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 
 	// need to create it
 	std::shared_ptr<TextureResource> tex;
-	tex = std::shared_ptr<TextureResource>(new TextureResource(key.first, tile, dynamic));
+	tex = std::shared_ptr<TextureResource>(new TextureResource(canonicalPath, tile, dynamic));
 	std::shared_ptr<TextureData> data = sTextureDataManager.get(tex.get());
 
 	// is it an SVG?
-	if(key.first.substr(key.first.size() - 4, std::string::npos) != ".svg")
+	if(canonicalPath.substr(canonicalPath.size() - 4, std::string::npos) != ".svg")
 	{
 		// Probably not. Add it to our map. We don't add SVGs because 2 svgs might be rasterized at different sizes
 		sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
@@ -149,6 +182,55 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	return tex;
 }
 
+std::shared_ptr<TextureResource> TextureResource::getThumbnail(const std::string& path, size_t maxWidth, size_t maxHeight)
+{
+	const std::string canonicalPath = getCanonicalPath(path);
+	if(canonicalPath.empty() || maxWidth == 0 || maxHeight == 0)
+		return get(path);
+
+	// SVGs are rasterized at the size they're shown at anyway
+	if(canonicalPath.size() > 4 && canonicalPath.substr(canonicalPath.size() - 4, std::string::npos) == ".svg")
+		return get(path);
+
+	TextureKeyType key(canonicalPath, false, maxWidth, maxHeight);
+	auto foundTexture = sTextureMap.find(key);
+	if(foundTexture != sTextureMap.end() && !foundTexture->second.expired())
+		return foundTexture->second.lock();
+
+	std::shared_ptr<TextureResource> tex(new TextureResource(canonicalPath, false, true, maxWidth, maxHeight));
+	sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
+	ResourceManager::getInstance()->addReloadable(tex);
+	return tex;
+}
+
+bool TextureResource::prefetch(const std::string& path)
+{
+	// SVGs are rasterized at the size they're shown at, which isn't known yet
+	if (path.empty() || (path.size() > 4 && path.substr(path.size() - 4, std::string::npos) == ".svg"))
+		return true;
+
+	// Already loaded for something on screen
+	auto foundTexture = sTextureMap.find(TextureKeyType(path, false, 0, 0));
+	if (foundTexture != sTextureMap.end() && !foundTexture->second.expired())
+		return true;
+
+	return sTextureDataManager.prefetch(path);
+}
+
+void TextureResource::cancelPrefetch(const std::string& path)
+{
+	sTextureDataManager.cancelPrefetch(path);
+}
+
+bool TextureResource::isPrefetched(const std::string& path)
+{
+	auto foundTexture = sTextureMap.find(TextureKeyType(path, false, 0, 0));
+	if (foundTexture != sTextureMap.end() && !foundTexture->second.expired())
+		return true;
+
+	return sTextureDataManager.isPrefetched(path);
+}
+
 // For scalable source images in textures we want to set the resolution to rasterize at
 void TextureResource::rasterizeAt(size_t width, size_t height)
 {
@@ -159,8 +241,10 @@ void TextureResource::rasterizeAt(size_t width, size_t height)
 		data = sTextureDataManager.get(this);
 	mSourceSize << (float)width, (float)height;
 	data->setSourceSize((float)width, (float)height);
-	if (mForceLoad || (mTextureData != nullptr))
+	if (mForceLoad)
 		data->load();
+	else if (mTextureData != nullptr)
+		sTextureDataManager.load(mTextureData);
 }
 
 Eigen::Vector2f TextureResource::getSourceImageSize() const
@@ -203,6 +287,17 @@ size_t TextureResource::getTotalTextureSize()
 	return total;
 }
 
+size_t TextureResource::getTotalMemSaved()
+{
+	// Only file textures are ever compressed, and those are all in the manager
+	return sTextureDataManager.getSavedSize();
+}
+
+bool TextureResource::isLoading()
+{
+	return !sTextureDataManager.isLoaderIdle();
+}
+
 void TextureResource::unload(std::shared_ptr<ResourceManager>& rm)
 {
 	// Release the texture's resources
@@ -221,5 +316,10 @@ void TextureResource::reload(std::shared_ptr<ResourceManager>& rm)
 	// For dynamically loaded textures the texture manager will load them on demand.
 	// For manually loaded textures we have to reload them here
 	if (mTextureData)
-		mTextureData->load();
+	{
+		if (mTextureData->scalable() && !mForceLoad)
+			sTextureDataManager.load(mTextureData);
+		else
+			mTextureData->load();
+	}
 }
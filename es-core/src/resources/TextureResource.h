@@ -5,6 +5,7 @@
 #include <string>
 #include <set>
 #include <list>
+#include <tuple>
 #include <Eigen/Dense>
 #include "platform.h"
 #include "resources/TextureData.h"
@@ -17,6 +18,16 @@ class TextureResource : public IReloadable
 {
 public:
 	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false, bool forceLoad = false, bool dynamic = true);
+	// A texture decoded to about maxWidth x maxHeight for small images like grid tiles. It loads in the
+	// background: getSize() is zero and upload() draws the blank texture until it is ready.
+	static std::shared_ptr<TextureResource> getThumbnail(const std::string& path, size_t maxWidth, size_t maxHeight);
+
+	// Start loading a (canonical) path at low priority so a later get() doesn't have to wait
+	// for it. Returns false if the prefetch memory budget is used up.
+	static bool prefetch(const std::string& path);
+	static void cancelPrefetch(const std::string& path);
+	// True if a get() for path would not have to load anything
+	static bool isPrefetched(const std::string& path);
 	void initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height);
 	virtual void initFromMemory(const char* file, size_t length);
 
@@ -30,13 +41,20 @@ public:
 	bool isTiled() const;
 
 	const Eigen::Vector2i getSize() const;
-	bool bind();
+	// Uploads the texture if necessary. textureId is the texture to draw with, which is a blank
+	// one (and false is returned) while the image is still loading.
+	bool upload(GLuint& textureId);
+	// Where the image lives in the texture returned by the last upload() (x, y, width, height).
+	// Small images share an atlas page, so this is not always the whole texture.
+	const Eigen::Vector4f& getTextureRect() const { return mTextureRect; }
 
 	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by textures (in bytes)
 	static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
+	static size_t getTotalMemSaved(); // returns the VRAM saved by texture compression (in bytes)
+	static bool isLoading(); // true while the background loader still has textures to load
 
 protected:
-	TextureResource(const std::string& path, bool tile, bool dynamic);
+	TextureResource(const std::string& path, bool tile, bool dynamic, size_t maxWidth = 0, size_t maxHeight = 0);
 	virtual void unload(std::shared_ptr<ResourceManager>& rm);
 	virtual void reload(std::shared_ptr<ResourceManager>& rm);
 
@@ -50,9 +68,10 @@ private:
 
 	Eigen::Vector2i					mSize;
 	Eigen::Vector2f					mSourceSize;
+	Eigen::Vector4f					mTextureRect;
 	bool							mForceLoad;
 
-	typedef std::pair<std::string, bool> TextureKeyType;
+	typedef std::tuple<std::string, bool, size_t, size_t> TextureKeyType; // path, tile, thumbnail size (0 for none)
 	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures
 	static std::set<TextureResource*> 	sAllTextures;	// Set of all textures, used for memory management
 };
@@ -0,0 +1,271 @@
+#include "resources/VideoPosterCache.h"
+#include "ImageIO.h"
+#include "Log.h"
+#include "platform.h"
+#include "Settings.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	// where the poster is taken, the first frames of a snap are often black or a logo
+	const char* k_startOption = ":start-time=3";
+	// posters are only needed for what is near the cursor
+	const size_t k_maxQueued = 16;
+	const int k_frameTimeoutMs = 3000;
+	// frames decoded before one is kept, so the decoder settles after the seek
+	const int k_skipFrames = 2;
+	// the poster folder is cut back to this when the first poster is requested, oldest first
+	const unsigned long long k_maxDiskBytes = 64 * 1024 * 1024;
+
+	std::time_t getModifiedTime(const std::string& path)
+	{
+		boost::system::error_code ec;
+		std::time_t modified = fs::last_write_time(path, ec);
+		return ec ? 0 : modified;
+	}
+
+	// FNV-1a, unlike std::hash the same in every build so posters survive an update
+	unsigned long long hashPath(const std::string& path)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < path.length(); i++)
+		{
+			hash ^= (unsigned char)path[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	// receives the decoded frames of an extraction
+	struct FrameGrab
+	{
+		std::mutex					mutex;
+		std::condition_variable		event;
+		std::vector<unsigned char>	pixels;
+		int							frames;
+	};
+
+	void* grabLock(void* data, void** pixels)
+	{
+		FrameGrab* grab = (FrameGrab*)data;
+		grab->mutex.lock();
+		*pixels = grab->pixels.data();
+		return nullptr;
+	}
+
+	void grabUnlock(void* data, void* id, void* const* pixels)
+	{
+		FrameGrab* grab = (FrameGrab*)data;
+		grab->frames++;
+		grab->mutex.unlock();
+		grab->event.notify_one();
+	}
+
+	void grabDisplay(void* data, void* id)
+	{
+	}
+}
+
+VideoPosterCache* VideoPosterCache::sInstance = nullptr;
+
+VideoPosterCache* VideoPosterCache::getInstance()
+{
+	if (sInstance == nullptr)
+		sInstance = new VideoPosterCache();
+	return sInstance;
+}
+
+VideoPosterCache::VideoPosterCache() : mDiskEnabled(true), mThread(nullptr), mExit(false)
+{
+	mDiskFolder = getCacheFolder() + "posters/";
+	boost::system::error_code ec;
+	fs::create_directories(mDiskFolder, ec);
+	if (ec)
+	{
+		LOG(LogWarning) << "Could not create poster cache folder " << mDiskFolder << ", video posters disabled";
+		mDiskEnabled = false;
+	}
+}
+
+std::string VideoPosterCache::getDiskPath(const std::string& videoPath) const
+{
+	std::stringstream ss;
+	ss << mDiskFolder << std::hex << hashPath(videoPath) << std::dec << "_" << getModifiedTime(videoPath) << ".png";
+	return ss.str();
+}
+
+bool VideoPosterCache::getPoster(libvlc_instance_t* instance, const std::string& videoPath, std::string& posterPath, bool prefetch)
+{
+	posterPath.clear();
+	if (!instance || videoPath.empty() || !mDiskEnabled || !Settings::getInstance()->getBool("VideoPosters"))
+		return false;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mExit)
+		return false;
+
+	auto it = mPosters.find(videoPath);
+	if (it != mPosters.end())
+	{
+		// queued ahead of the cursor and selected now: extract it next
+		if (it->second.path.empty() && !it->second.failed && !prefetch)
+		{
+			auto queued = std::find_if(mQueue.begin(), mQueue.end(), [&videoPath](const Request& request) { return request.videoPath == videoPath; });
+			if (queued != mQueue.begin() && queued != mQueue.end())
+			{
+				Request request = *queued;
+				mQueue.erase(queued);
+				mQueue.push_front(request);
+			}
+		}
+		posterPath = it->second.path;
+		return !it->second.failed;
+	}
+
+	Request request;
+	request.instance = instance;
+	request.videoPath = videoPath;
+
+	mPosters[videoPath] = Poster();
+	if (prefetch)
+		mQueue.push_back(request);
+	else
+		mQueue.push_front(request);
+
+	// drop the videos the cursor moved away from, they're queued again when they come back
+	while (mQueue.size() > k_maxQueued)
+	{
+		mPosters.erase(mQueue.back().videoPath);
+		mQueue.pop_back();
+	}
+
+	if (mThread == nullptr)
+		mThread = new std::thread(&VideoPosterCache::threadProc, this);
+	mEvent.notify_one();
+	return true;
+}
+
+void VideoPosterCache::deinit()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mExit = true;
+		mQueue.clear();
+	}
+	mEvent.notify_one();
+
+	if (mThread != nullptr)
+	{
+		mThread->join();
+		delete mThread;
+		mThread = nullptr;
+	}
+}
+
+bool VideoPosterCache::extract(libvlc_instance_t* instance, const std::string& videoPath, const std::string& posterPath)
+{
+	libvlc_media_t* media = libvlc_media_new_path(instance, videoPath.c_str());
+	if (!media)
+		return false;
+
+	unsigned int width = 0;
+	unsigned int height = 0;
+	libvlc_media_parse(media);
+	libvlc_media_track_t** tracks;
+	const unsigned int trackCount = libvlc_media_tracks_get(media, &tracks);
+	for (unsigned int track = 0; track < trackCount; ++track)
+	{
+		if (tracks[track]->i_type == libvlc_track_video)
+		{
+			width = tracks[track]->video->i_width;
+			height = tracks[track]->video->i_height;
+			break;
+		}
+	}
+	libvlc_media_tracks_release(tracks, trackCount);
+
+	if (width == 0 || height == 0)
+	{
+		libvlc_media_release(media);
+		return false;
+	}
+
+	libvlc_media_add_option(media, k_startOption);
+	libvlc_media_add_option(media, ":no-audio");
+
+	FrameGrab grab;
+	grab.pixels.resize(width * height * 4);
+	grab.frames = 0;
+
+	libvlc_media_player_t* player = libvlc_media_player_new_from_media(media);
+	libvlc_video_set_callbacks(player, grabLock, grabUnlock, grabDisplay, &grab);
+	libvlc_video_set_format(player, "RGBA", width, height, width * 4);
+	libvlc_media_player_play(player);
+
+	bool grabbed;
+	{
+		// short snaps may end before the start time, any frame will do then
+		std::unique_lock<std::mutex> lock(grab.mutex);
+		grabbed = grab.event.wait_for(lock, std::chrono::milliseconds(k_frameTimeoutMs), [&grab, player]
+			{ return grab.frames > k_skipFrames || (grab.frames > 0 && libvlc_media_player_get_state(player) == libvlc_Ended); });
+	}
+
+	libvlc_media_player_stop(player);
+	libvlc_media_player_release(player);
+	libvlc_media_release(media);
+
+	if (!grabbed)
+		return false;
+
+	// the frame is top-down, VLC may leave alpha empty
+	for (size_t i = 3; i < grab.pixels.size(); i += 4)
+		grab.pixels[i] = 255;
+	ImageIO::flipPixelsVert(grab.pixels.data(), width, height);
+
+	// written under another name first, so a poster is never read half written
+	const std::string tempPath = posterPath + ".tmp";
+	if (!ImageIO::saveRGBA32PNG(tempPath, grab.pixels.data(), width, height))
+		return false;
+	boost::system::error_code ec;
+	fs::rename(tempPath, posterPath, ec);
+	return !ec;
+}
+
+void VideoPosterCache::threadProc()
+{
+	trimCacheFolder(mDiskFolder, k_maxDiskBytes);
+
+	while (true)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEvent.wait(lock, [this] { return mExit || !mQueue.empty(); });
+			if (mExit)
+				return;
+			request = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		const std::string posterPath = getDiskPath(request.videoPath);
+		boost::system::error_code ec;
+		const bool extracted = fs::exists(posterPath, ec) || extract(request.instance, request.videoPath, posterPath);
+		if (!extracted)
+			LOG(LogWarning) << "Could not extract a poster frame from " << request.videoPath;
+
+		// a failed video is remembered, so it isn't queued again this run
+		std::unique_lock<std::mutex> lock(mMutex);
+		auto it = mPosters.find(request.videoPath);
+		if (it != mPosters.end())
+		{
+			it->second.path = extracted ? posterPath : "";
+			it->second.failed = !extracted;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vlc/vlc.h>
+
+// Keeps one still frame (a poster) of each video snap as a PNG in ~/.emulationstation/cache/posters,
+// keyed by the video path and its modification time. Gamelists show it as the video's static image,
+// so a game always has a picture at once, even without a thumbnail and before VLC decoded anything.
+// Posters are looked up on disk and extracted by a background thread that decodes a single frame a
+// few seconds in, the caller never touches the filesystem.
+class VideoPosterCache
+{
+public:
+	static VideoPosterCache* getInstance();
+
+	// Sets posterPath to the poster image of a video, or to an empty string if it isn't ready yet.
+	// Missing posters are queued, a selected video (prefetch false) ahead of its neighbours. Returns
+	// false if the video won't get a poster, e.g. because extracting it failed.
+	bool getPoster(libvlc_instance_t* instance, const std::string& videoPath, std::string& posterPath, bool prefetch = false);
+
+	// Stops the background thread, waiting for an extraction in progress. Must be called before
+	// the libvlc instance is released. No posters are extracted afterwards.
+	void deinit();
+
+private:
+	struct Request
+	{
+		libvlc_instance_t*	instance;
+		std::string			videoPath;
+	};
+
+	struct Poster
+	{
+		Poster() : failed(false) {}
+
+		std::string	path; // empty while queued
+		bool		failed;
+	};
+
+	VideoPosterCache();
+
+	std::string getDiskPath(const std::string& videoPath) const;
+	static bool extract(libvlc_instance_t* instance, const std::string& videoPath, const std::string& posterPath);
+	void threadProc();
+
+	static VideoPosterCache* sInstance;
+
+	std::string							mDiskFolder;
+	bool								mDiskEnabled;
+
+	std::thread*						mThread;
+	std::mutex							mMutex;
+	std::condition_variable				mEvent;
+	bool								mExit;
+	std::deque<Request>					mQueue;
+	std::map<std::string, Poster>		mPosters; // by video path
+};
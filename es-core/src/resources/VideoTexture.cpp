@@ -0,0 +1,95 @@
+#include "resources/VideoTexture.h"
+#include "Renderer.h"
+
+std::atomic<unsigned int> VideoTexture::sDecoded(0);
+unsigned int VideoTexture::sUploaded = 0;
+
+std::shared_ptr<VideoTexture> VideoTexture::create(size_t width, size_t height)
+{
+	std::shared_ptr<VideoTexture> texture(new VideoTexture(width, height));
+	ResourceManager::getInstance()->addReloadable(texture);
+	return texture;
+}
+
+VideoTexture::VideoTexture(size_t width, size_t height) : mWidth(width), mHeight(height), mTextureId(0), mHasFrame(false), mSequence(0)
+{
+	createTexture();
+}
+
+VideoTexture::~VideoTexture()
+{
+	if(mTextureId)
+		Renderer::deleteTexture(mTextureId);
+}
+
+void VideoTexture::resize(size_t width, size_t height)
+{
+	mHasFrame = false;
+	if(mTextureId == 0 || (width == mWidth && height == mHeight))
+	{
+		mWidth = width;
+		mHeight = height;
+		return;
+	}
+
+	mWidth = width;
+	mHeight = height;
+	Renderer::bindTexture(mTextureId);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)mWidth, (GLsizei)mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+}
+
+void VideoTexture::createTexture()
+{
+	glGenTextures(1, &mTextureId);
+	Renderer::bindTexture(mTextureId);
+
+	// storage only, frames are copied into it
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)mWidth, (GLsizei)mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// whatever was in the texture is gone
+	mHasFrame = false;
+}
+
+GLuint VideoTexture::update(const unsigned char* frameRGBA, unsigned int sequence)
+{
+	if(mTextureId == 0 || (mHasFrame && sequence == mSequence))
+		return mTextureId;
+
+	Renderer::bindTexture(mTextureId);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)mWidth, (GLsizei)mHeight, GL_RGBA, GL_UNSIGNED_BYTE, frameRGBA);
+
+	mHasFrame = true;
+	mSequence = sequence;
+	sUploaded++;
+	return mTextureId;
+}
+
+VideoTexture::Stats VideoTexture::takeStats()
+{
+	Stats stats = { sDecoded.exchange(0), sUploaded };
+	sUploaded = 0;
+	return stats;
+}
+
+void VideoTexture::unload(std::shared_ptr<ResourceManager>& rm)
+{
+	if(mTextureId)
+	{
+		Renderer::deleteTexture(mTextureId);
+		mTextureId = 0;
+	}
+	mHasFrame = false;
+}
+
+void VideoTexture::reload(std::shared_ptr<ResourceManager>& rm)
+{
+	if(mTextureId == 0)
+		createTexture();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "platform.h"
+#include GLHEADER
+#include "resources/ResourceManager.h"
+
+// A texture for video frames. It is allocated once at the video's size and updated in place with
+// glTexSubImage2D, and only when the decoder produced a frame since the last upload. The decoder
+// numbers its frames; the caller holds whatever lock guards the frame while calling update().
+class VideoTexture : public IReloadable
+{
+public:
+	struct Stats
+	{
+		unsigned int decoded;	// frames the decoders produced
+		unsigned int uploaded;	// frames that reached a texture
+	};
+
+	static std::shared_ptr<VideoTexture> create(size_t width, size_t height);
+	virtual ~VideoTexture();
+
+	// Readies the texture for another video. The storage is only reallocated if the size changed,
+	// the frame of the last video is dropped either way.
+	void resize(size_t width, size_t height);
+
+	// Uploads frame (RGBA, width * height) unless the frame with this sequence number is already in
+	// the texture. Returns the texture to draw with.
+	GLuint update(const unsigned char* frameRGBA, unsigned int sequence);
+
+	// Called by decoders for every frame they produce, from any thread
+	static void countDecodedFrame() { sDecoded++; }
+	// Counts since the last call, for the framerate overlay
+	static Stats takeStats();
+
+	void unload(std::shared_ptr<ResourceManager>& rm) override;
+	void reload(std::shared_ptr<ResourceManager>& rm) override;
+
+private:
+	VideoTexture(size_t width, size_t height);
+
+	void createTexture();
+
+	static std::atomic<unsigned int> sDecoded;
+	static unsigned int sUploaded;
+
+	size_t mWidth;
+	size_t mHeight;
+	GLuint mTextureId;
+	bool mHasFrame;
+	unsigned int mSequence; // of the frame in the texture
+};